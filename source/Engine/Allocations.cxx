@@ -0,0 +1,416 @@
+/*
+ * Source/Engine/Allocations.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/Allocations.hxx"
+
+#include "Engine/Engine.hxx"
+#include "Engine/Telemetry.hxx"
+
+#include <cstring>
+#include <new>
+
+#ifdef LinuxOS
+    #include <execinfo.h>
+#endif
+
+namespace Biq {
+
+// String Table
+
+namespace Txt {
+static const charconst TrackingAllocations   = "Tracking allocations";
+static const charconst CheckingSteadyState   = "Checking for allocations in steady state steps after %d warm-up frames";
+static const charconst SteadyStateAllocation = "Allocation in a steady state step at %s (%llu bytes, %llu so far)";
+static const charconst ZoneReport            = "%-8s %10llu allocations %12llu bytes, at most %llu in a frame";
+static const charconst FrameReport           = "%llu frames, %.1f allocations per frame, %llu frees";
+static const charconst CallSiteReport        = "%10llu allocations at %s";
+static const charconst ViolationsReport      = "%llu allocations in steady state steps";
+static const charconst OtherZoneName         = "Other";
+}    // namespace Txt
+
+// Static Members
+
+std::atomic<bool>         Allocations::isEnabled(false);
+std::atomic<bool>         Allocations::isSteadyState(false);
+uint                      Allocations::warmupFrames       = 0;
+uint                      Allocations::steadyFrames       = 0;
+Allocations::ZoneCounters Allocations::zones[Allocations::MaxZones];
+std::atomic<uint>         Allocations::numberOfZones(1);
+Allocations::CallSite     Allocations::callSites[Allocations::MaxCallSites];
+std::atomic<u64>          Allocations::frees(0);
+std::atomic<u64>          Allocations::violations(0);
+u64                       Allocations::reportedViolations = 0;
+u64                       Allocations::frames             = 0;
+Allocations::Counters     Allocations::lastFrame          = { 0, 0 };
+uint                      Allocations::frameCountMetric   = Telemetry::InvalidMetric;
+uint                      Allocations::frameBytesMetric   = Telemetry::InvalidMetric;
+uint                      Allocations::violationsMetric   = Telemetry::InvalidMetric;
+
+thread_local uint Allocations::currentZone = Allocations::OtherZone;
+
+// SDL Memory Functions
+
+static SDL_malloc_func  sdlMalloc  = NULL;
+static SDL_calloc_func  sdlCalloc  = NULL;
+static SDL_realloc_func sdlRealloc = NULL;
+static SDL_free_func    sdlFree    = NULL;
+
+static void* TrackedMalloc(size_t size) {
+    Allocations::OnAllocate(size, __builtin_return_address(0));
+    return sdlMalloc(size);
+}
+
+static void* TrackedCalloc(size_t count, size_t size) {
+    Allocations::OnAllocate(count * size, __builtin_return_address(0));
+    return sdlCalloc(count, size);
+}
+
+static void* TrackedRealloc(void* memory, size_t size) {
+    // Reallocations may move the block, they are counted as new allocations.
+    Allocations::OnAllocate(size, __builtin_return_address(0));
+    return sdlRealloc(memory, size);
+}
+
+static void TrackedFree(void* memory) {
+    if (memory != NULL) {
+        Allocations::OnFree();
+    }
+
+    sdlFree(memory);
+}
+
+// General
+
+void Allocations::Enable() {
+    if (isEnabled) {
+        return;
+    }
+
+    SDL_GetMemoryFunctions(&sdlMalloc, &sdlCalloc, &sdlRealloc, &sdlFree);
+    SDL_SetMemoryFunctions(TrackedMalloc, TrackedCalloc, TrackedRealloc, TrackedFree);
+
+    zones[Allocations::OtherZone].name = Txt::OtherZoneName;
+
+    frameCountMetric = Telemetry::RegisterGauge("Allocations.FrameCount");
+    frameBytesMetric = Telemetry::RegisterGauge("Allocations.FrameBytes");
+    violationsMetric = Telemetry::RegisterCounter("Allocations.Violations");
+
+    isEnabled = true;
+    INFO(Txt::TrackingAllocations);
+}
+
+bool Allocations::IsEnabled() {
+    return isEnabled;
+}
+
+void Allocations::Report() {
+    if (!isEnabled) {
+        return;
+    }
+
+    for (uint zoneIndex = 0; zoneIndex < numberOfZones; zoneIndex++) {
+        auto& zone = zones[zoneIndex];
+        INFO(Txt::ZoneReport, zone.name, zone.totalCount, zone.totalBytes, zone.maxFrameCount);
+    }
+
+    auto totalCounters = GetTotalCounters();
+    INFO(Txt::FrameReport, U64(frames), frames > 0 ? F64(totalCounters.count) / frames : 0.0, U64(frees));
+
+#ifdef BIQ_DEBUG
+    CallSite* sortedSites[Allocations::MaxCallSites];
+    uint      numberOfSites = 0;
+
+    for (auto& site : callSites) {
+        if (site.address != 0) {
+            sortedSites[numberOfSites++] = &site;
+        }
+    }
+
+    std::sort(sortedSites, sortedSites + numberOfSites, [](const CallSite* first, const CallSite* second) { return first->count > second->count; });
+
+    for (uint siteIndex = 0; siteIndex < std::min(numberOfSites, UINT(Allocations::ReportedSites)); siteIndex++) {
+        char description[256];
+
+        DescribeCallSite(sortedSites[siteIndex]->address, description, sizeof(description));
+        INFO(Txt::CallSiteReport, U64(sortedSites[siteIndex]->count), description);
+    }
+#endif
+
+    if (warmupFrames > 0) {
+        INFO(Txt::ViolationsReport, U64(violations));
+    }
+}
+
+// Steady State
+
+void Allocations::SetSteadyStateCheck(const uint numberOfFrames) {
+    warmupFrames = numberOfFrames;
+    RestartWarmup();
+
+    if (warmupFrames > 0) {
+        INFO(Txt::CheckingSteadyState, warmupFrames);
+    }
+}
+
+void Allocations::RestartWarmup() {
+    steadyFrames  = 0;
+    isSteadyState = false;
+}
+
+u64 Allocations::GetViolations() {
+    return violations;
+}
+
+// Zones
+
+uint Allocations::RegisterZone(const charconst zoneName, const bool isStrict) {
+    for (uint zoneIndex = 1; zoneIndex < numberOfZones; zoneIndex++) {
+        if (strcmp(zones[zoneIndex].name, zoneName) == 0) {
+            return zoneIndex;
+        }
+    }
+
+    if (numberOfZones >= Allocations::MaxZones) {
+        return Allocations::InvalidZone;
+    }
+
+    auto& zone = zones[numberOfZones];
+
+    zone.name     = zoneName;
+    zone.isStrict = isStrict;
+
+    return numberOfZones++;
+}
+
+uint Allocations::EnterZone(const uint zoneId) {
+    auto previousZone = currentZone;
+
+    if (zoneId < numberOfZones) {
+        currentZone = zoneId;
+    }
+
+    return previousZone;
+}
+
+void Allocations::LeaveZone(const uint previousZone) {
+    currentZone = previousZone;
+}
+
+// Frames
+
+void Allocations::EndFrame() {
+    if (!isEnabled) {
+        return;
+    }
+
+    lastFrame = { 0, 0 };
+
+    for (uint zoneIndex = 0; zoneIndex < numberOfZones; zoneIndex++) {
+        auto& zone  = zones[zoneIndex];
+        auto  count = zone.frameCount.exchange(0, std::memory_order_relaxed);
+        auto  bytes = zone.frameBytes.exchange(0, std::memory_order_relaxed);
+
+        zone.totalCount += count;
+        zone.totalBytes += bytes;
+        zone.maxFrameCount = std::max(zone.maxFrameCount, count);
+
+        lastFrame.count += count;
+        lastFrame.bytes += bytes;
+    }
+
+    frames++;
+
+    Telemetry::Set(frameCountMetric, lastFrame.count);
+    Telemetry::Set(frameBytesMetric, lastFrame.bytes);
+
+    if ((warmupFrames > 0) && !isSteadyState && (++steadyFrames >= warmupFrames)) {
+        isSteadyState = true;
+    }
+
+    if (violations != reportedViolations) {
+        ReportViolations();
+    }
+}
+
+Allocations::Counters Allocations::GetFrameCounters() {
+    return lastFrame;
+}
+
+Allocations::Counters Allocations::GetTotalCounters() {
+    Counters totalCounters = { 0, 0 };
+
+    for (uint zoneIndex = 0; zoneIndex < numberOfZones; zoneIndex++) {
+        totalCounters.count += zones[zoneIndex].totalCount;
+        totalCounters.bytes += zones[zoneIndex].totalBytes;
+    }
+
+    return totalCounters;
+}
+
+// Hooks
+
+// These run inside every allocation: no locks, no logging and nothing that allocates.
+
+void Allocations::OnAllocate(const size_t size, const void* callSite) {
+    if (!isEnabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    auto& zone = zones[currentZone];
+
+    zone.frameCount.fetch_add(1, std::memory_order_relaxed);
+    zone.frameBytes.fetch_add(size, std::memory_order_relaxed);
+
+    auto isViolation = zone.isStrict && isSteadyState.load(std::memory_order_relaxed);
+
+#ifdef BIQ_DEBUG
+    auto isTracked = true;
+#else
+    auto isTracked = isViolation;
+#endif
+
+    if (isTracked) {
+        auto site = FindCallSite(callSite);
+
+        if (site != NULL) {
+            site->count.fetch_add(1, std::memory_order_relaxed);
+            site->lastSize.store(size, std::memory_order_relaxed);
+
+            if (isViolation) {
+                site->violations.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    if (isViolation) {
+        violations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Allocations::OnFree() {
+    if (isEnabled.load(std::memory_order_relaxed)) {
+        frees.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Call Sites
+
+Allocations::CallSite* Allocations::FindCallSite(const void* callSite) {
+    auto address   = reinterpret_cast<uintptr_t>(callSite);
+    auto siteIndex = UINT((address >> 2) * 0x9e3779b1u) % Allocations::MaxCallSites;
+
+    // Open addressing: a site is claimed with a compare and swap on its address and never released.
+    for (uint probe = 0; probe < Allocations::MaxCallSites; probe++) {
+        auto&     site     = callSites[(siteIndex + probe) % Allocations::MaxCallSites];
+        uintptr_t expected = 0;
+
+        if ((site.address.load(std::memory_order_relaxed) == address) || site.address.compare_exchange_strong(expected, address) || (expected == address)) {
+            return &site;
+        }
+    }
+
+    return NULL;
+}
+
+void Allocations::ReportViolations() {
+    for (auto& site : callSites) {
+        if (site.isReported || (site.violations == 0)) {
+            continue;
+        }
+
+        char description[256];
+
+        DescribeCallSite(site.address, description, sizeof(description));
+        WARNING(Txt::SteadyStateAllocation, description, U64(site.lastSize), U64(site.violations));
+
+        site.isReported = true;
+    }
+
+    Telemetry::Add(violationsMetric, violations - reportedViolations);
+    reportedViolations = violations;
+}
+
+void Allocations::DescribeCallSite(const uintptr_t address, char* description, const uint size) {
+#ifdef LinuxOS
+    void* addresses[1] = { reinterpret_cast<void*>(address) };
+    auto  symbols      = backtrace_symbols(addresses, 1);
+
+    if (symbols != NULL) {
+        snprintf(description, size, "%s", symbols[0]);
+        free(symbols);
+        return;
+    }
+#endif
+
+    snprintf(description, size, "%p", reinterpret_cast<void*>(address));
+}
+
+}    // namespace Biq
+
+// Global Allocation Functions
+
+static void* Allocate(size_t size) {
+    void* memory;
+
+    if (size == 0) {
+        size = 1;
+    }
+
+    while ((memory = malloc(size)) == NULL) {
+        auto newHandler = std::get_new_handler();
+
+        if (newHandler == NULL) {
+            abort();
+        }
+
+        newHandler();
+    }
+
+    return memory;
+}
+
+void* operator new(size_t size) {
+    Biq::Allocations::OnAllocate(size, __builtin_return_address(0));
+    return Allocate(size);
+}
+
+void* operator new[](size_t size) {
+    Biq::Allocations::OnAllocate(size, __builtin_return_address(0));
+    return Allocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    Biq::Allocations::OnAllocate(size, __builtin_return_address(0));
+    return malloc(size != 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    Biq::Allocations::OnAllocate(size, __builtin_return_address(0));
+    return malloc(size != 0 ? size : 1);
+}
+
+void operator delete(void* memory) noexcept {
+    if (memory != NULL) {
+        Biq::Allocations::OnFree();
+        free(memory);
+    }
+}
+
+void operator delete[](void* memory) noexcept {
+    if (memory != NULL) {
+        Biq::Allocations::OnFree();
+        free(memory);
+    }
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    operator delete(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    operator delete[](memory);
+}
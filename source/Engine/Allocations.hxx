@@ -0,0 +1,129 @@
+/*
+ * Source/Engine/Allocations.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_ALLOCATIONS_HXX
+#define BIQ_ALLOCATIONS_HXX
+
+#include "Engine/Types.hxx"
+
+namespace Biq {
+
+// Allocation tracking: the global operator new and delete (and SDL's malloc family) are hooked to count allocations
+// and bytes per frame and per zone. A zone is a scope on one thread (the engine uses Step, Input and Render), every
+// allocation goes to the innermost zone of its thread, or to Other.
+//
+// Allocations in strict zones are not expected once the game reached a steady state: with steady state checks on,
+// any of them after the warm-up frames (counted again after every state switch) is a violation. Violations are logged
+// once per call site at the end of the frame, debug builds also keep the call sites of every allocation.
+
+class Allocations {
+    public:
+        ~Allocations() = default;
+
+        // Constants
+
+        static constexpr charconst Tag           = "Allocations";
+        static constexpr uint      MaxZones      = 16;
+        static constexpr uint      MaxCallSites  = 256;
+        static constexpr uint      ReportedSites = 16;
+        static constexpr uint      OtherZone     = 0;
+        static constexpr uint      InvalidZone   = UINT(-1);
+
+        struct Counters {
+            u64 count;
+            u64 bytes;
+        };
+
+        // Zones
+
+        class Zone {
+            public:
+                explicit Zone(const uint zoneId) :
+                    previousZone(Allocations::EnterZone(zoneId)) {
+                }
+
+                ~Zone() {
+                    Allocations::LeaveZone(previousZone);
+                }
+
+            private:
+                uint previousZone;
+        };
+
+        // General
+
+        // Must be called before the engine is initialized, SDL only takes new memory functions before allocating.
+        static void Enable();
+        static bool IsEnabled();
+        static void Report();
+
+        // Steady state checks start after the given number of frames, 0 turns them off.
+        static void SetSteadyStateCheck(const uint numberOfFrames);
+        static void RestartWarmup();
+        static u64  GetViolations();
+
+        static uint RegisterZone(const charconst zoneName, const bool isStrict);
+        static uint EnterZone(const uint zoneId);
+        static void LeaveZone(const uint previousZone);
+
+        static void     EndFrame();
+        static Counters GetFrameCounters();
+        static Counters GetTotalCounters();
+
+        // Hooks
+
+        static void OnAllocate(const size_t size, const void* callSite);
+        static void OnFree();
+
+    protected:
+        Allocations() = delete;
+
+    private:
+        struct ZoneCounters {
+            charconst        name;
+            bool             isStrict;
+            std::atomic<u64> frameCount;
+            std::atomic<u64> frameBytes;
+            u64              totalCount;
+            u64              totalBytes;
+            u64              maxFrameCount;
+        };
+
+        struct CallSite {
+            std::atomic<uintptr_t> address;
+            std::atomic<u64>       count;
+            std::atomic<u64>       violations;
+            std::atomic<u64>       lastSize;
+            bool                   isReported;
+        };
+
+        static std::atomic<bool> isEnabled;
+        static std::atomic<bool> isSteadyState;
+        static uint              warmupFrames;
+        static uint              steadyFrames;
+        static ZoneCounters      zones[MaxZones];
+        static std::atomic<uint> numberOfZones;
+        static CallSite          callSites[MaxCallSites];
+        static std::atomic<u64>  frees;
+        static std::atomic<u64>  violations;
+        static u64               reportedViolations;
+        static u64               frames;
+        static Counters          lastFrame;
+        static uint              frameCountMetric;
+        static uint              frameBytesMetric;
+        static uint              violationsMetric;
+
+        static thread_local uint currentZone;
+
+        static CallSite* FindCallSite(const void* callSite);
+        static void      ReportViolations();
+        static void      DescribeCallSite(const uintptr_t address, char* description, const uint size);
+};
+
+}    // namespace Biq
+
+#endif    // BIQ_ALLOCATIONS_HXX
@@ -0,0 +1,371 @@
+/*
+ * Source/Engine/Capture.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/Capture.hxx"
+
+#include "Engine/Engine.hxx"
+#include "Engine/Telemetry.hxx"
+
+#include "SDL2/SDL.h"
+#include "SDL2/SDL_image.h"
+
+#include <cerrno>
+
+#ifdef LinuxOS
+    #include <sys/stat.h>
+#else
+    #include <direct.h>
+#endif
+
+namespace Biq {
+
+// String Table
+
+namespace Txt {
+static const charconst CouldNotCreateDirectory = "Could not create the capture directory \"%s\"";
+static const charconst CouldNotWriteFrame      = "Could not write the frame \"%s\"";
+static const charconst CapturingFrames         = "Capturing every %d frames to \"%s\" (%s)";
+static const charconst ComparingFrames         = "Comparing frames with the goldens in \"%s\" (tolerance %d, up to %.2f%% of the pixels)";
+static const charconst MissingGolden           = "There is no golden for \"%s\"";
+static const charconst GoldenSizeMismatch      = "\"%s\" is %dx%d, its golden is %dx%d";
+static const charconst GoldenMismatch          = "\"%s\" differs from its golden in %d pixels (%.3f%%)";
+static const charconst CaptureReport           = "Captured %d frames (%d dropped, the pool was full)";
+static const charconst ComparisonReport        = "Compared %d frames with their goldens: %d mismatched, %d without a golden";
+}    // namespace Txt
+
+// Static Members
+
+std::atomic<bool>            Capture::isCapturing(false);
+string                       Capture::captureDirectory;
+string                       Capture::goldenDirectory;
+uint                         Capture::captureInterval   = 1;
+Capture::Format              Capture::captureFormat     = Capture::PNG;
+uint                         Capture::goldenTolerance   = Capture::DefaultTolerance;
+f32                          Capture::goldenMaxMismatch = Capture::DefaultMaxMismatch;
+u32                          Capture::frameCounter      = 0;
+Capture::Frame               Capture::framePool[Capture::PoolSize];
+std::vector<Capture::Frame*> Capture::freeFrames;
+std::vector<Capture::Frame*> Capture::queuedFrames;
+std::mutex                   Capture::mutex;
+std::condition_variable      Capture::frameQueued;
+std::thread                  Capture::worker;
+Capture::Report              Capture::report;
+uint                         Capture::droppedFramesMetric = Telemetry::InvalidMetric;
+uint                         Capture::queuedFramesMetric  = Telemetry::InvalidMetric;
+
+// Raw frames are a small header followed by the RGBA pixels.
+
+struct RawHeader {
+    u32 magic;
+    u32 width;
+    u32 height;
+};
+
+static bool MakeDirectory(const string& path) {
+#ifdef LinuxOS
+    return (mkdir(path.c_str(), 0755) == 0) || (errno == EEXIST);
+#else
+    return (_mkdir(path.c_str()) == 0) || (errno == EEXIST);
+#endif
+}
+
+// General
+
+bool Capture::Start(const string& directory, const uint interval, const Format format) {
+    if (isCapturing) {
+        return true;
+    }
+
+    if (!MakeDirectory(directory)) {
+        ERROR(Txt::CouldNotCreateDirectory, directory.c_str());
+        return false;
+    }
+
+    captureDirectory = directory;
+    captureInterval  = std::max(interval, 1u);
+    captureFormat    = format;
+    frameCounter     = 0;
+    report           = { 0, 0, 0, 0, 0 };
+
+    freeFrames.clear();
+    queuedFrames.clear();
+
+    for (auto& frame : framePool) {
+        freeFrames.push_back(&frame);
+    }
+
+    droppedFramesMetric = Telemetry::RegisterCounter("Capture.DroppedFrames");
+    queuedFramesMetric  = Telemetry::RegisterGauge("Capture.QueuedFrames");
+
+    isCapturing = true;
+    worker      = std::thread(Capture::Work);
+
+    INFO(Txt::CapturingFrames, captureInterval, directory.c_str(), format == Capture::PNG ? "PNG" : "raw");
+    return true;
+}
+
+bool Capture::SetGoldens(const string& directory, const uint tolerance, const f32 maxMismatch) {
+    goldenDirectory   = directory;
+    goldenTolerance   = tolerance;
+    goldenMaxMismatch = maxMismatch;
+
+    INFO(Txt::ComparingFrames, directory.c_str(), tolerance, maxMismatch * 100.0f);
+    return true;
+}
+
+void Capture::Stop() {
+    if (!isCapturing) {
+        return;
+    }
+
+    // The worker drains the queue before leaving, so every submitted frame is written (and compared).
+    mutex.lock();
+    isCapturing = false;
+    mutex.unlock();
+
+    frameQueued.notify_one();
+    worker.join();
+
+    INFO(Txt::CaptureReport, report.captured, report.dropped);
+
+    if (!goldenDirectory.empty()) {
+        INFO(Txt::ComparisonReport, report.compared, report.mismatched, report.missingGoldens);
+    }
+}
+
+bool Capture::IsCapturing() {
+    return isCapturing;
+}
+
+const Capture::Report& Capture::GetReport() {
+    return report;
+}
+
+// Frames
+
+bool Capture::IsFrameDue() {
+    return isCapturing && ((frameCounter++ % captureInterval) == 0);
+}
+
+Capture::Frame* Capture::AcquireFrame() {
+    Frame* frame = NULL;
+
+    mutex.lock();
+
+    if (!freeFrames.empty()) {
+        frame = freeFrames.back();
+        freeFrames.pop_back();
+    }
+
+    mutex.unlock();
+
+    if (frame == NULL) {
+        report.dropped++;
+        Telemetry::Add(droppedFramesMetric, 1);
+        return NULL;
+    }
+
+    frame->number = frameCounter - 1;
+    return frame;
+}
+
+void Capture::SubmitFrame(Frame* frame) {
+    mutex.lock();
+    queuedFrames.push_back(frame);
+    Telemetry::Set(queuedFramesMetric, queuedFrames.size());
+    mutex.unlock();
+
+    frameQueued.notify_one();
+}
+
+void Capture::ReleaseFrame(Frame* frame) {
+    mutex.lock();
+    freeFrames.push_back(frame);
+    mutex.unlock();
+}
+
+// Worker
+
+void Capture::Work() {
+    while (true) {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        frameQueued.wait(lock, [] { return !queuedFrames.empty() || !isCapturing; });
+
+        if (queuedFrames.empty()) {
+            break;
+        }
+
+        auto frame = queuedFrames.front();
+        queuedFrames.erase(queuedFrames.begin());
+        lock.unlock();
+
+        auto path = FramePath(captureDirectory, frame->number, captureFormat == Capture::PNG ? ".png" : ".raw");
+
+        if (WriteFrame(frame, path)) {
+            report.captured++;
+        } else {
+            WARNING(Txt::CouldNotWriteFrame, path.c_str());
+        }
+
+        if (!goldenDirectory.empty()) {
+            CompareFrame(frame, path);
+        }
+
+        ReleaseFrame(frame);
+    }
+}
+
+bool Capture::WriteFrame(const Frame* frame, const string& path) {
+    if (captureFormat == Capture::Raw) {
+        auto frameFile = fopen(path.c_str(), "wb");
+
+        if (frameFile == NULL) {
+            return false;
+        }
+
+        RawHeader header = { Capture::RawMagic, U32(frame->width), U32(frame->height) };
+
+        auto isWritten = (fwrite(&header, sizeof(header), 1, frameFile) == 1) && (fwrite(frame->pixels.data(), frame->pixels.size(), 1, frameFile) == 1);
+
+        fclose(frameFile);
+        return isWritten;
+    }
+
+    auto frameSurface = SDL_CreateRGBSurfaceWithFormatFrom(const_cast<u8*>(frame->pixels.data()), frame->width, frame->height, 32, frame->width * 4, SDL_PIXELFORMAT_RGBA32);
+
+    if (frameSurface == NULL) {
+        return false;
+    }
+
+    auto isWritten = IMG_SavePNG(frameSurface, path.c_str()) == 0;
+
+    SDL_FreeSurface(frameSurface);
+    return isWritten;
+}
+
+// Golden Comparison
+
+static bool LoadGolden(const string& path, const bool isRaw, int& width, int& height, std::vector<u8>& pixels) {
+    if (isRaw) {
+        auto goldenFile = fopen(path.c_str(), "rb");
+
+        if (goldenFile == NULL) {
+            return false;
+        }
+
+        RawHeader header;
+        auto      isRead = (fread(&header, sizeof(header), 1, goldenFile) == 1) && (header.magic == Capture::RawMagic);
+
+        if (isRead) {
+            width  = header.width;
+            height = header.height;
+            pixels.resize(width * height * 4);
+            isRead = fread(pixels.data(), pixels.size(), 1, goldenFile) == 1;
+        }
+
+        fclose(goldenFile);
+        return isRead;
+    }
+
+    auto goldenSurface = IMG_Load(path.c_str());
+
+    if (goldenSurface == NULL) {
+        return false;
+    }
+
+    auto rgbaSurface = SDL_ConvertSurfaceFormat(goldenSurface, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(goldenSurface);
+
+    if (rgbaSurface == NULL) {
+        return false;
+    }
+
+    width  = rgbaSurface->w;
+    height = rgbaSurface->h;
+    pixels.resize(width * height * 4);
+
+    for (int row = 0; row < height; row++) {
+        memcpy(pixels.data() + row * width * 4, DATA(rgbaSurface->pixels) + row * rgbaSurface->pitch, width * 4);
+    }
+
+    SDL_FreeSurface(rgbaSurface);
+    return true;
+}
+
+void Capture::CompareFrame(const Frame* frame, const string& capturePath) {
+    static std::vector<u8> goldenPixels;
+    static std::vector<u8> diffPixels;
+
+    auto goldenPath = FramePath(goldenDirectory, frame->number, captureFormat == Capture::PNG ? ".png" : ".raw");
+    int  goldenWidth, goldenHeight;
+
+    if (!LoadGolden(goldenPath, captureFormat == Capture::Raw, goldenWidth, goldenHeight, goldenPixels)) {
+        WARNING(Txt::MissingGolden, capturePath.c_str());
+        report.missingGoldens++;
+        return;
+    }
+
+    report.compared++;
+
+    if ((goldenWidth != frame->width) || (goldenHeight != frame->height)) {
+        ERROR(Txt::GoldenSizeMismatch, capturePath.c_str(), frame->width, frame->height, goldenWidth, goldenHeight);
+        report.mismatched++;
+        return;
+    }
+
+    auto numberOfPixels = UINT(frame->width * frame->height);
+    uint mismatches     = 0;
+
+    diffPixels.resize(frame->pixels.size());
+
+    // Alpha is left out, the backbuffer alpha is not part of what is shown.
+    for (uint pixelIndex = 0; pixelIndex < numberOfPixels; pixelIndex++) {
+        auto capturePixel = frame->pixels.data() + pixelIndex * 4;
+        auto goldenPixel  = goldenPixels.data() + pixelIndex * 4;
+        auto diffPixel    = diffPixels.data() + pixelIndex * 4;
+        auto isMismatch   = false;
+
+        for (uint channel = 0; channel < 3; channel++) {
+            isMismatch = isMismatch || (UINT(std::abs(capturePixel[channel] - goldenPixel[channel])) > goldenTolerance);
+        }
+
+        if (isMismatch) {
+            mismatches++;
+            diffPixel[0] = 255;
+            diffPixel[1] = 0;
+            diffPixel[2] = 0;
+        } else {
+            // Matching pixels are dimmed so the mismatches stand out.
+            diffPixel[0] = diffPixel[1] = diffPixel[2] = U8((capturePixel[0] + capturePixel[1] + capturePixel[2]) / 12);
+        }
+
+        diffPixel[3] = 255;
+    }
+
+    if (mismatches <= goldenMaxMismatch * numberOfPixels) {
+        return;
+    }
+
+    ERROR(Txt::GoldenMismatch, capturePath.c_str(), mismatches, (mismatches * 100.0) / numberOfPixels);
+    report.mismatched++;
+
+    auto diffSurface = SDL_CreateRGBSurfaceWithFormatFrom(diffPixels.data(), frame->width, frame->height, 32, frame->width * 4, SDL_PIXELFORMAT_RGBA32);
+
+    if (diffSurface != NULL) {
+        IMG_SavePNG(diffSurface, FramePath(captureDirectory, frame->number, ".diff.png").c_str());
+        SDL_FreeSurface(diffSurface);
+    }
+}
+
+string Capture::FramePath(const string& directory, const u32 frameNumber, const charconst suffix) {
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "/frame_%06u%s", frameNumber, suffix);
+    return directory + fileName;
+}
+
+}    // namespace Biq
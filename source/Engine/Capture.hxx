@@ -0,0 +1,103 @@
+/*
+ * Source/Engine/Capture.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_CAPTURE_HXX
+#define BIQ_CAPTURE_HXX
+
+#include "Engine/Types.hxx"
+
+#include <condition_variable>
+
+namespace Biq {
+
+// Frame capture: the renderer reads captured frames back into a pool of reusable buffers and a worker thread encodes
+// them (PNG or raw RGBA) and writes them to disk. When the pool is exhausted the frame is dropped instead of waiting,
+// so the game loop never blocks on encoding or disk.
+//
+// With golden images set, every captured frame is also compared to the golden with the same name: a pixel mismatches
+// when any channel differs by more than the tolerance, and the frame fails when more than maxMismatch (a fraction of
+// its pixels) do. Failing frames get a "<frame>.diff.png" next to the capture with the mismatching pixels in red.
+
+class Capture {
+    public:
+        ~Capture() = default;
+
+        // Constants
+
+        static constexpr charconst Tag                = "Capture";
+        static constexpr uint      PoolSize           = 8;
+        static constexpr uint      DefaultTolerance   = 8;
+        static constexpr f32       DefaultMaxMismatch = 0.001f;
+        static constexpr u32       RawMagic           = 0x52514942;
+
+        enum Format {
+            PNG = 0,
+            Raw
+        };
+
+        struct Frame {
+            u32             number;
+            int             width;
+            int             height;
+            std::vector<u8> pixels;
+        };
+
+        struct Report {
+            uint captured;
+            uint dropped;
+            uint compared;
+            uint mismatched;
+            uint missingGoldens;
+        };
+
+        // General
+
+        static bool Start(const string& directory, const uint interval, const Format format);
+        static bool SetGoldens(const string& directory, const uint tolerance, const f32 maxMismatch);
+        static void Stop();
+        static bool IsCapturing();
+
+        static const Report& GetReport();
+
+        // Frames (used by the renderer)
+
+        static bool   IsFrameDue();
+        static Frame* AcquireFrame();
+        static void   SubmitFrame(Frame* frame);
+        static void   ReleaseFrame(Frame* frame);
+
+    protected:
+        Capture() = delete;
+
+    private:
+        static std::atomic<bool>       isCapturing;
+        static string                  captureDirectory;
+        static string                  goldenDirectory;
+        static uint                    captureInterval;
+        static Format                  captureFormat;
+        static uint                    goldenTolerance;
+        static f32                     goldenMaxMismatch;
+        static u32                     frameCounter;
+        static Frame                   framePool[PoolSize];
+        static std::vector<Frame*>     freeFrames;
+        static std::vector<Frame*>     queuedFrames;
+        static std::mutex              mutex;
+        static std::condition_variable frameQueued;
+        static std::thread             worker;
+        static Report                  report;
+        static uint                    droppedFramesMetric;
+        static uint                    queuedFramesMetric;
+
+        static void   Work();
+        static bool   WriteFrame(const Frame* frame, const string& path);
+        static void   CompareFrame(const Frame* frame, const string& name);
+        static string FramePath(const string& directory, const u32 frameNumber, const charconst suffix);
+};
+
+}    // namespace Biq
+
+#endif    // BIQ_CAPTURE_HXX
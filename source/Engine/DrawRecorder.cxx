@@ -0,0 +1,189 @@
+/*
+ * Source/Engine/DrawRecorder.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/DrawRecorder.hxx"
+
+#include "Engine/Engine.hxx"
+
+namespace Biq {
+
+// String Table
+
+namespace Txt {
+static const charconst CouldNotOpenRecording  = "Could not open the draw recording \"%s\"";
+static const charconst CouldNotWriteRecording = "Could not write to the draw recording, recording stopped";
+static const charconst RecordingDraws         = "Recording draws to \"%s\"";
+static const charconst RecordingFinished      = "Recorded %d frames and %d images to \"%s\" (%d draws of images without a path left out)";
+}    // namespace Txt
+
+// Static Members
+
+FILE*                        DrawRecorder::recordingFile = NULL;
+string                       DrawRecorder::recordingPath;
+std::vector<u8>              DrawRecorder::frameBuffer;
+std::map<const Image*, uint> DrawRecorder::imageIndexes;
+std::vector<string>          DrawRecorder::imagePaths;
+uint                         DrawRecorder::currentLayer   = 0;
+u32                          DrawRecorder::recordedFrames = 0;
+u32                          DrawRecorder::skippedDraws   = 0;
+
+// General
+
+bool DrawRecorder::Start(const string& filePath, const GameInformation& gameInformation) {
+    Stop();
+
+    recordingFile = fopen(filePath.c_str(), "wb");
+
+    if (recordingFile == NULL) {
+        ERROR(Txt::CouldNotOpenRecording, filePath.c_str());
+        return false;
+    }
+
+    FileHeader header = { DrawRecorder::Magic, DrawRecorder::Version, gameInformation.targetWidth, gameInformation.targetHeight };
+
+    if (fwrite(&header, sizeof(header), 1, recordingFile) != 1) {
+        ERROR(Txt::CouldNotOpenRecording, filePath.c_str());
+        fclose(recordingFile);
+        recordingFile = NULL;
+        return false;
+    }
+
+    recordingPath  = filePath;
+    currentLayer   = 0;
+    recordedFrames = 0;
+    skippedDraws   = 0;
+
+    imageIndexes.clear();
+    imagePaths.clear();
+    frameBuffer.clear();
+
+    INFO(Txt::RecordingDraws, filePath.c_str());
+    return true;
+}
+
+void DrawRecorder::Stop() {
+    if (recordingFile == NULL) {
+        return;
+    }
+
+    // A partial frame would replay as a frame of its own.
+    frameBuffer.clear();
+    fclose(recordingFile);
+    recordingFile = NULL;
+
+    INFO(Txt::RecordingFinished, recordedFrames, imagePaths.size(), recordingPath.c_str(), skippedDraws);
+}
+
+bool DrawRecorder::IsRecording() {
+    return recordingFile != NULL;
+}
+
+// Drawing
+
+void DrawRecorder::SetLayer(const uint layerIndex) {
+    currentLayer = layerIndex;
+}
+
+void DrawRecorder::RecordSplash(const Image* image) {
+    auto imageIndex = ImageIndex(image);
+
+    if (imageIndex < 0) {
+        return;
+    }
+
+    Record record = { DrawRecorder::SplashCommand, U8(currentLayer), U16(imageIndex), 0, 0, 0, 0 };
+    Append(&record, sizeof(record));
+}
+
+void DrawRecorder::RecordDraw(const Image* image, const SDL_Rect& destinationRect, const u32 tint) {
+    auto imageIndex = ImageIndex(image);
+
+    if (imageIndex < 0) {
+        return;
+    }
+
+    // Anything outside of the i16 range is far off screen anyway.
+    Record record = {
+        DrawRecorder::DrawCommand,
+        U8(currentLayer),
+        U16(imageIndex),
+        I16(std::min(std::max(destinationRect.x, -32768), 32767)),
+        I16(std::min(std::max(destinationRect.y, -32768), 32767)),
+        I16(std::min(std::max(destinationRect.w, -32768), 32767)),
+        I16(std::min(std::max(destinationRect.h, -32768), 32767)),
+        tint,
+    };
+
+    Append(&record, sizeof(record));
+}
+
+void DrawRecorder::RecordGeometry(const SDL_Vertex* vertices, const uint numberOfVertices, const int* indices, const uint numberOfIndices) {
+    GeometryRecord record = { DrawRecorder::GeometryCommand, U8(currentLayer), 0, numberOfVertices, numberOfIndices };
+
+    Append(&record, sizeof(record));
+    Append(vertices, numberOfVertices * sizeof(SDL_Vertex));
+    Append(indices, numberOfIndices * sizeof(int));
+}
+
+// The frame is written at once, the buffer keeps its capacity so recording does not allocate every frame.
+void DrawRecorder::EndFrame() {
+    if (recordingFile == NULL) {
+        return;
+    }
+
+    Record record = { DrawRecorder::FrameCommand, 0, 0, 0, 0, 0, 0 };
+    Append(&record, sizeof(record));
+
+    if (fwrite(frameBuffer.data(), frameBuffer.size(), 1, recordingFile) != 1) {
+        ERROR(Txt::CouldNotWriteRecording);
+        Stop();
+        return;
+    }
+
+    frameBuffer.clear();
+    recordedFrames++;
+}
+
+// Images
+
+int DrawRecorder::ImageIndex(const Image* image) {
+    if (image->path.empty()) {
+        skippedDraws++;
+        return -1;
+    }
+
+    // Images are matched by address, checking the path catches an address reused by another image.
+    auto imageIndex = imageIndexes.find(image);
+
+    if ((imageIndex != imageIndexes.end()) && (imagePaths[imageIndex->second] == image->path)) {
+        return imageIndex->second;
+    }
+
+    auto pathIndex = std::find(imagePaths.begin(), imagePaths.end(), image->path);
+
+    // New paths are defined right before the first command that uses them.
+    if (pathIndex == imagePaths.end()) {
+        Record record = { DrawRecorder::ImageCommand, 0, U16(imagePaths.size()), 0, 0, I16(image->path.size()), 0 };
+
+        Append(&record, sizeof(record));
+        Append(image->path.data(), image->path.size());
+
+        // Paths are padded to keep the vertices that may follow aligned.
+        frameBuffer.resize((frameBuffer.size() + 3) & ~3u, 0);
+
+        pathIndex = imagePaths.insert(imagePaths.end(), image->path);
+    }
+
+    return imageIndexes[image] = pathIndex - imagePaths.begin();
+}
+
+void DrawRecorder::Append(const void* data, const uint size) {
+    auto bytes = reinterpret_cast<const u8*>(data);
+    frameBuffer.insert(frameBuffer.end(), bytes, bytes + size);
+}
+
+}    // namespace Biq
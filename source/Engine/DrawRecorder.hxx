@@ -0,0 +1,104 @@
+/*
+ * Source/Engine/DrawRecorder.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_DRAWRECORDER_HXX
+#define BIQ_DRAWRECORDER_HXX
+
+#include "Engine/Types.hxx"
+#include "SDL2/SDL.h"
+
+namespace Biq {
+
+// Draw recorder: writes every image the renderer draws (splashes, sprites and geometry) to a binary file, frame by
+// frame, so the same draw workload can be pushed through the renderer again without the game (biq-draw-replay).
+//
+// The file starts with a FileHeader and is a sequence of commands. Images are recorded by path, an Image command
+// defines an index the first time a path is drawn. Sprites are stored with the destination rect the renderer used,
+// their tint and the world layer they were drawn on, geometry is followed by its vertices and indices. A Frame command
+// ends every frame. Images that were not loaded from a file (text) are left out. Everything is 4 byte aligned (paths
+// are padded).
+
+class DrawRecorder {
+    public:
+        ~DrawRecorder() = default;
+
+        // Constants
+
+        static constexpr charconst Tag     = "DrawRecorder";
+        static constexpr u32       Magic   = 0x44514942;    // "BIQD"
+        static constexpr u32       Version = 2;
+
+        enum Command {
+            FrameCommand = 0,
+            ImageCommand,
+            SplashCommand,
+            DrawCommand,
+            GeometryCommand
+        };
+
+        struct FileHeader {
+            u32 magic;
+            u32 version;
+            u32 width;
+            u32 height;
+        };
+
+        // Frame and Splash only use the command and the layer, Image puts the path length in width. Only Draw uses the
+        // tint.
+        struct Record {
+            u8  command;
+            u8  layer;
+            u16 image;
+            i16 x;
+            i16 y;
+            i16 width;
+            i16 height;
+            u32 tint;
+        };
+
+        struct GeometryRecord {
+            u8  command;
+            u8  layer;
+            u16 reserved;
+            u32 numberOfVertices;
+            u32 numberOfIndices;
+        };
+
+        // General
+
+        static bool Start(const string& filePath, const GameInformation& gameInformation);
+        static void Stop();
+        static bool IsRecording();
+
+        // Drawing (called by the world and the renderer)
+
+        static void SetLayer(const uint layerIndex);
+        static void RecordSplash(const Image* image);
+        static void RecordDraw(const Image* image, const SDL_Rect& destinationRect, const u32 tint);
+        static void RecordGeometry(const SDL_Vertex* vertices, const uint numberOfVertices, const int* indices, const uint numberOfIndices);
+        static void EndFrame();
+
+    protected:
+        DrawRecorder() = delete;
+
+    private:
+        static FILE*                        recordingFile;
+        static string                       recordingPath;
+        static std::vector<u8>              frameBuffer;
+        static std::map<const Image*, uint> imageIndexes;
+        static std::vector<string>          imagePaths;
+        static uint                         currentLayer;
+        static u32                          recordedFrames;
+        static u32                          skippedDraws;
+
+        static int  ImageIndex(const Image* image);
+        static void Append(const void* data, const uint size);
+};
+
+}    // namespace Biq
+
+#endif    // BIQ_DRAWRECORDER_HXX
@@ -6,9 +6,23 @@
  */
 
 #include "Engine/Engine.hxx"
+#include "Engine/Allocations.hxx"
+#include "Engine/Capture.hxx"
+#include "Engine/DrawRecorder.hxx"
+#include "Engine/FrameArena.hxx"
+#include "Engine/Overdraw.hxx"
+#include "Engine/Overlap.hxx"
+#include "Engine/Particles.hxx"
+#include "Engine/PerfCounters.hxx"
 #include "Engine/Renderer.hxx"
 #include "Engine/World.hxx"
 #include "Engine/Sound.hxx"
+#include "Engine/Spectator.hxx"
+#include "Engine/Startup.hxx"
+#include "Engine/Telemetry.hxx"
+#include "Engine/Timers.hxx"
+
+#include <cstring>
 
 namespace Biq {
 
@@ -24,27 +38,70 @@ namespace Txt {
 	static const charconst ProgramHeader		= "%s - Version %s (%s %s)";
     static const charconst DevelopmentVersion   = "--- DEVELOPMENT VERSION ---";
 
+	static const charconst UsingDummyDrivers	= "Running headless, using the dummy video and audio drivers";
+	static const charconst CouldNotInitializeSDL	= "Could not initialize SDL: %s";
+
+	static const charconst FixedSimulationRate	= "Simulating at %d steps per second (%d ms per step)";
+
+	static const charconst CouldNotOpenInputFile	= "Could not open the input file \"%s\"";
+	static const charconst RecordingInput	= "Recording the input to \"%s\"";
+	static const charconst ReplayingInput	= "Replaying %s (%d events)";
+	static const charconst ReplayWithoutLockstep	= "Replaying without lockstep, the game may play out differently";
+	static const charconst ReplayFinished	= "Replay finished at step %d";
+	static const charconst InputFileHeader	= "# Biq input recording: <step> press|release <key>, <step> end\n";
+
 	static const charconst Running	= "Running";
 	static const charconst Stopping	= "Stopping";
 	static const charconst Stopped	= "Stopped";
 
-    static const charconst StateAlreadyRegistered   = "There is already a state named \"%s\" registered";
-    static const charconst StateNotFound            = "State \"%s\" not found";
-    static const charconst StateRegistered          = "State \"%s\" registered";
+    static const charconst StateAlreadyRegistered   = "There is already a state registered with the id %d";
+    static const charconst StateNotFound            = "State %d not found";
+    static const charconst StateRegistered          = "State \"%s\" registered with the id %d";
     static const charconst StateChanged             = "Current state changed to \"%s\"";
+    static const charconst PreparingState           = "Preparing state \"%s\"";
+    static const charconst StatePrepared            = "State \"%s\" prepared in %.2f ms";
+    static const charconst StateTransition          = "Transition to \"%s\" took %.2f ms (%.2f ms swapping)";
 }
 
 // Static Members
 
 GameInformation Engine::game;
-std::map<string, State*> Engine::gameStates;
+Engine::StateSlot Engine::gameStates[Engine::MaxStates];
 
 std::atomic<bool> Engine::isRunning(false);
+uint Engine::currentStateId = Engine::NoState;
 State* Engine::currentState = NULL;
 
+uint Engine::nextStateId = Engine::NoState;
+f64 Engine::transitionRequestTime = 0.0;
+Engine::TransitionStatistics Engine::transitionStatistics = {};
+
+u64  Engine::randomState       = 0x853c49e6748fea9bull;
+uint Engine::simulationRate    = 0;
+uint Engine::simulationTicks   = 0;
+uint Engine::simulationBacklog = 0;
+u32  Engine::simulationSteps   = 0;
+bool Engine::isLockstep        = false;
+
+FILE*                           Engine::inputRecording  = NULL;
+std::vector<Engine::InputEvent> Engine::inputReplay;
+uint                            Engine::nextReplayEvent = 0;
+
+uint Engine::frameTimeMetric         = Telemetry::InvalidMetric;
+uint Engine::transitionLatencyMetric = Telemetry::InvalidMetric;
+
+uint Engine::stepZone   = Allocations::InvalidZone;
+uint Engine::inputZone  = Allocations::InvalidZone;
+uint Engine::renderZone = Allocations::InvalidZone;
+
+uint Engine::stepPhase    = PerfCounters::InvalidPhase;
+uint Engine::inputPhase   = PerfCounters::InvalidPhase;
+uint Engine::renderPhase  = PerfCounters::InvalidPhase;
+uint Engine::presentPhase = PerfCounters::InvalidPhase;
+
 // General
 
-bool Engine::Initialize(const GameInformation& gameInformation) {
+bool Engine::Initialize(const GameInformation& gameInformation, const uint initialStateId) {
 	INFO(Txt::Empty);
 	INFO(Txt::ProgramHeader, Engine::Name, Engine::VersionString, OSName, ArchName);
 	INFO(Engine::CopyrightInfo);
@@ -53,22 +110,84 @@ bool Engine::Initialize(const GameInformation& gameInformation) {
 
     DEBUG(Txt::Initializing);
 
+    Startup::Begin();
+
+    game = gameInformation;
+
+    // Headless runs (CI, benchmarks, scenarios) still go through the whole pipeline, using SDL's dummy drivers.
+    if (gameInformation.isHeadless) {
+        DEBUG(Txt::UsingDummyDrivers);
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+        SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    }
+
+    // SDL's own setup (timers, events, system services) and its subsystem counts are not thread safe: the events, audio
+    // and video subsystems are all initialized on this thread, workers only open the audio device and load libraries.
+    {
+        Startup::Phase startupPhase("SDL");
+
+        if (SDL_Init(SDL_INIT_EVENTS) != 0) {
+            ERROR(Txt::CouldNotInitializeSDL, SDL_GetError());
+            return false;
+        }
+    }
+
+    Overlap::Initialize();
+    Sound::Initialize();
+    Renderer::InitializeLibraries();
+
+    if (initialStateId != NoState) {
+        PrepareState(initialStateId);
+    }
+
+    // Some systems only let the main thread create windows, this thread does that while the workers load.
     if (!Renderer::Initialize(gameInformation)) {
         Finalize();
         return false;
     }
 
-    if (!Sound::Initialize()) {
+    {
+        Startup::Phase startupPhase("Waiting for the audio");
+
+        if (!Sound::WaitUntilReady()) {
+            Finalize();
+            return false;
+        }
+    }
+
+    if (!World::Initialize(gameInformation.maxWorldLayers)) {
         Finalize();
         return false;
     }
 
-    if (!World::Initialize(gameInformation.maxWorldLayers)) {
+    if (!FrameArena::Initialize(FrameArena::DefaultCapacity)) {
         Finalize();
         return false;
     }
 
-    game = gameInformation;
+    if (!Particles::Initialize(Particles::DefaultCapacity)) {
+        Finalize();
+        return false;
+    }
+
+    if (!Timers::Initialize()) {
+        Finalize();
+        return false;
+    }
+
+    frameTimeMetric         = Telemetry::RegisterHistogram("Engine.FrameTime");
+    transitionLatencyMetric = Telemetry::RegisterHistogram("Engine.TransitionLatency");
+
+    // Steps and key handling are the gameplay ticks, nothing in them should allocate once the game is warm.
+    stepZone   = Allocations::RegisterZone("Step", true);
+    inputZone  = Allocations::RegisterZone("Input", true);
+    renderZone = Allocations::RegisterZone("Render", false);
+
+    stepPhase    = PerfCounters::RegisterPhase("Step");
+    inputPhase   = PerfCounters::RegisterPhase("Input");
+    renderPhase  = PerfCounters::RegisterPhase("Render");
+    presentPhase = PerfCounters::RegisterPhase("Present");
+
     INFO(Txt::Initialized);
     return true;
 }
@@ -77,22 +196,47 @@ void Engine::Finalize() {
     INFO(Txt::Finalizing);
 
     Stop();
+    FinishInputRecording();
+    DrawRecorder::Stop();
+    Overdraw::Stop();
+    Allocations::Report();
+    PerfCounters::Disable();
+    ReleaseStates();
+    Timers::Finalize();
     World::Finalize();
+    Particles::Finalize();
+    FrameArena::Finalize();
     Sound::Finalize();
+    Capture::Stop();
     Renderer::Finalize();
+    Spectator::Close();
+    Telemetry::Close();
 
     INFO(Txt::Finalized);
 }
 
-void Engine::Run(const charconst initialState) {
+void Engine::Run(const uint initialStateId) {
     if (isRunning) {
         return;
     }
 
+    if ((initialStateId >= MaxStates) || (gameStates[initialStateId].state == NULL)) {
+        ERROR(Txt::StateNotFound, initialStateId);
+        return;
+    }
+
     INFO(Txt::Running);
 
     isRunning = true;
-    ChangeState(initialState);
+
+    // The initial state is prepared right here, there is nothing on screen to keep alive yet.
+    nextStateId           = initialStateId;
+    transitionRequestTime = GetPreciseTicks();
+
+    {
+        Startup::Phase startupPhase("First state");
+        SwitchState(true);
+    }
 
     SDL_Event sdlEvent;
 
@@ -101,13 +245,46 @@ void Engine::Run(const charconst initialState) {
     int lastFrameTime = 0;
 
     float frameTime = game.targetFPS / 1000.0f;
+    f64   frameStartTime = GetPreciseTicks();
 
     while (isRunning) {
+        // Lockstep runs switch at a fixed step as well, so they wait for the next state to be ready.
+        if (nextStateId != NoState) {
+            SwitchState(isLockstep);
+        }
+
         currentTick = GetTicks();
         lastFrameTime = currentTick - lastTick;
         lastTick = currentTick;
 
-        currentState->Step(lastFrameTime * frameTime);
+        if (isLockstep) {
+            uint stepTime = 1000 / simulationRate;
+            StepState(stepTime, stepTime * frameTime);
+        } else if (simulationRate == 0) {
+            StepState(lastFrameTime, lastFrameTime * frameTime);
+        } else {
+            // Fixed steps: catch up with real time, but never by more than MaxStepsPerFrame steps in a single frame.
+            uint stepTime = 1000 / simulationRate;
+            uint steps    = 0;
+
+            simulationBacklog += lastFrameTime;
+
+            while ((simulationBacklog >= stepTime) && (steps < Engine::MaxStepsPerFrame)) {
+                simulationBacklog -= stepTime;
+                StepState(stepTime, stepTime * frameTime);
+                steps++;
+            }
+
+            if (simulationBacklog >= stepTime) {
+                simulationBacklog = 0;
+            }
+        }
+
+        PerfCounters::BeginPhase(inputPhase);
+
+        if (inputReplay.size() > 0) {
+            ReplayInputEvents();
+        }
 
         while (isRunning && (SDL_PollEvent(&sdlEvent) != 0)) {
             switch (sdlEvent.type) {
@@ -117,20 +294,83 @@ void Engine::Run(const charconst initialState) {
                 }
 
                 case SDL_KEYDOWN: {
-                    currentState->OnPress(SDLKeyToGameKey(sdlEvent.key.keysym.sym));
+                    HandleKey(true, SDLKeyToGameKey(sdlEvent.key.keysym.sym));
                     break;
                 }
 
                 case SDL_KEYUP: {
-                    currentState->OnRelease(SDLKeyToGameKey(sdlEvent.key.keysym.sym));
+                    HandleKey(false, SDLKeyToGameKey(sdlEvent.key.keysym.sym));
+                    break;
+                }
+
+                case SDL_WINDOWEVENT: {
+                    // Exposed, resized or restored windows may have lost what was presented.
+                    World::Invalidate();
                     break;
                 }
             }
         }
 
-        World::Render();
-        Renderer::Update();
+        PerfCounters::EndPhase(inputPhase);
+
+        auto isFramePresented = true;
+
+        {
+            Allocations::Zone renderAllocations(renderZone);
+
+            // Captures and draw recordings follow every frame, in full.
+            if (Capture::IsCapturing() || DrawRecorder::IsRecording()) {
+                World::Invalidate();
+            }
+
+            PerfCounters::BeginPhase(renderPhase);
+            isFramePresented = World::Render();
+            PerfCounters::EndPhase(renderPhase);
+
+            // Render goes through every object of the world, even on frames it skips.
+            if (PerfCounters::IsEnabled()) {
+                for (auto layer : World::GetLayers()) {
+                    PerfCounters::AddObjects(renderPhase, layer->objects.size());
+                }
+            }
+
+            PerfCounters::Phase presentPerfCounters(presentPhase);
+
+            if (isFramePresented) {
+                Renderer::Update();
+            } else {
+                Renderer::SkipFrame();
+            }
+        }
+
+        Startup::FirstFrame();
+
+        auto frameEndTime = GetPreciseTicks();
+        Telemetry::Record(frameTimeMetric, U64((frameEndTime - frameStartTime) * 1000.0));
+        currentState->OnFrame(frameEndTime - frameStartTime);
+        Allocations::EndFrame();
+        PerfCounters::EndFrame();
+        FrameArena::NextFrame();
+        Telemetry::Publish();
+
+        // At low simulation rates there is nothing new to show until the next step is due, give the CPU back. Headless
+        // lockstep runs (replays, captures) go as fast as they can instead.
+        if ((simulationRate != 0) && !(isLockstep && game.isHeadless)) {
+            uint stepTime  = 1000 / simulationRate;
+            uint busyTime  = GetTicks() - currentTick;
+
+            if (simulationBacklog + busyTime < stepTime) {
+                SDL_Delay(stepTime - (simulationBacklog + busyTime));
+            }
+        } else if (!isFramePresented && !game.isHeadless) {
+            // Nothing changed on screen, do not spin on it either.
+            SDL_Delay(1);
+        }
+
         std::this_thread::yield();
+
+        // Frame times leave the pacing out.
+        frameStartTime = GetPreciseTicks();
     }
 
     INFO(Txt::Stopping);
@@ -144,44 +384,318 @@ void Engine::Stop() {
     isRunning = false;
 }
 
+// Simulation
+
+void Engine::SetSimulationRate(const uint stepsPerSecond) {
+    simulationRate    = std::min(stepsPerSecond, 1000u);
+    simulationBacklog = 0;
+
+    if (simulationRate != 0) {
+        DEBUG(Txt::FixedSimulationRate, simulationRate, 1000 / simulationRate);
+    }
+}
+
+void Engine::SetLockstep(const bool lockstep) {
+    isLockstep = lockstep;
+
+    if (isLockstep && (simulationRate == 0)) {
+        SetSimulationRate(game.targetFPS);
+    }
+}
+
+uint Engine::GetSimulationTicks() {
+    return simulationTicks;
+}
+
+u32 Engine::GetSimulationSteps() {
+    return simulationSteps;
+}
+
+void Engine::StepState(const uint stepTime, const float speedMultiplier) {
+    simulationTicks += stepTime;
+    simulationSteps++;
+
+    {
+        Allocations::Zone   stepAllocations(stepZone);
+        PerfCounters::Phase stepPerfCounters(stepPhase);
+
+        // Timers due during the step fire before it, the state sees their effects right away.
+        Timers::Advance(simulationTicks);
+        currentState->Step(speedMultiplier);
+    }
+
+    Spectator::Publish();
+}
+
+// Input Recording
+
+bool Engine::RecordInput(const string& filePath) {
+    inputRecording = fopen(filePath.c_str(), "w");
+
+    if (inputRecording == NULL) {
+        ERROR(Txt::CouldNotOpenInputFile, filePath.c_str());
+        return false;
+    }
+
+    fprintf(inputRecording, "%s", Txt::InputFileHeader);
+    INFO(Txt::RecordingInput, filePath.c_str());
+    return true;
+}
+
+bool Engine::ReplayInput(const string& filePath) {
+    auto replayFile = fopen(filePath.c_str(), "r");
+
+    if (replayFile == NULL) {
+        ERROR(Txt::CouldNotOpenInputFile, filePath.c_str());
+        return false;
+    }
+
+    char line[128];
+    char action[16];
+    u32  step;
+    uint key;
+
+    inputReplay.clear();
+    nextReplayEvent = 0;
+
+    while (fgets(line, sizeof(line), replayFile) != NULL) {
+        if ((line[0] == '#') || (sscanf(line, "%u %15s", &step, action) != 2)) {
+            continue;
+        }
+
+        if (strcmp(action, "end") == 0) {
+            inputReplay.push_back({ step, InputEnd, 0 });
+        } else if (sscanf(line, "%u %15s %u", &step, action, &key) == 3) {
+            inputReplay.push_back({ step, strcmp(action, "press") == 0 ? InputPress : InputRelease, key });
+        }
+    }
+
+    fclose(replayFile);
+
+    if (!isLockstep) {
+        WARNING(Txt::ReplayWithoutLockstep);
+    }
+
+    INFO(Txt::ReplayingInput, filePath.c_str(), inputReplay.size());
+    return true;
+}
+
+void Engine::HandleKey(const bool isPress, const uint key) {
+    // Replays own the input, the keyboard would make them diverge.
+    if (inputReplay.size() > 0) {
+        return;
+    }
+
+    if (inputRecording != NULL) {
+        fprintf(inputRecording, "%u %s %u\n", simulationSteps, isPress ? "press" : "release", key);
+    }
+
+    Allocations::Zone inputAllocations(inputZone);
+
+    if (isPress) {
+        currentState->OnPress(key);
+    } else {
+        currentState->OnRelease(key);
+    }
+}
+
+void Engine::ReplayInputEvents() {
+    while ((nextReplayEvent < inputReplay.size()) && (inputReplay[nextReplayEvent].step <= simulationSteps)) {
+        auto& event = inputReplay[nextReplayEvent++];
+
+        Allocations::Zone inputAllocations(inputZone);
+
+        switch (event.action) {
+            case InputPress: currentState->OnPress(event.key); break;
+            case InputRelease: currentState->OnRelease(event.key); break;
+
+            case InputEnd: {
+                INFO(Txt::ReplayFinished, simulationSteps);
+                Stop();
+                return;
+            }
+        }
+    }
+}
+
+void Engine::FinishInputRecording() {
+    if (inputRecording != NULL) {
+        fprintf(inputRecording, "%u end\n", simulationSteps);
+        fclose(inputRecording);
+        inputRecording = NULL;
+    }
+}
+
 // States
 
-void Engine::RegisterState(const charconst stateName, const State& state) {
-    auto existingState = gameStates.find(stateName);
+void Engine::RegisterState(const uint stateId, const charconst stateName, const State& state) {
+    if (stateId >= MaxStates) {
+        ERROR(Txt::StateNotFound, stateId);
+        return;
+    }
 
-    if (existingState != gameStates.end()) {
-        WARNING(Txt::StateAlreadyRegistered, stateName);
+    if (gameStates[stateId].state != NULL) {
+        WARNING(Txt::StateAlreadyRegistered, stateId);
         return;
     }
 
-    gameStates[stateName] = (State*) &state;
-    DEBUG(Txt::StateRegistered, stateName);
+    gameStates[stateId].state  = (State*) &state;
+    gameStates[stateId].name   = stateName;
+    gameStates[stateId].status = StateUnprepared;
+
+    DEBUG(Txt::StateRegistered, stateName, stateId);
 }
 
-void Engine::ChangeState(const charconst stateName) {
-    auto state = gameStates.find(stateName);
+void Engine::PrepareState(const uint stateId) {
+    if ((stateId >= MaxStates) || (gameStates[stateId].state == NULL)) {
+        ERROR(Txt::StateNotFound, stateId);
+        return;
+    }
+
+    auto& slot = gameStates[stateId];
 
-    if (state == gameStates.end()) {
-        ERROR(Txt::StateNotFound, stateName);
+    if (slot.status != StateUnprepared) {
         return;
     }
 
-    if (isRunning) {
-        if (currentState != NULL) {
-            currentState->Deactivate();
+    // Images loaded from the worker are only decoded there, their textures are uploaded by the renderer a few at a
+    // time (see Renderer::UploadPendingImages) so the active state keeps its frame rate.
+    slot.status = StatePreparing;
+    slot.worker = std::thread(PrepareStateNow, stateId);
+}
+
+void Engine::ChangeState(const uint stateId) {
+    if ((stateId >= MaxStates) || (gameStates[stateId].state == NULL)) {
+        ERROR(Txt::StateNotFound, stateId);
+        return;
+    }
+
+    if (stateId == currentStateId) {
+        nextStateId = NoState;
+        return;
+    }
+
+    nextStateId           = stateId;
+    transitionRequestTime = GetPreciseTicks();
+
+    PrepareState(stateId);
+}
+
+bool Engine::IsStateReady(const uint stateId) {
+    if ((stateId >= MaxStates) || (gameStates[stateId].state == NULL)) {
+        return false;
+    }
+
+    return (gameStates[stateId].status == StatePrepared) && !Renderer::HasPendingImages();
+}
+
+const Engine::TransitionStatistics& Engine::GetTransitionStatistics() {
+    return transitionStatistics;
+}
+
+void Engine::PrepareStateNow(const uint stateId) {
+    auto& slot = gameStates[stateId];
+
+    DEBUG(Txt::PreparingState, slot.name);
+
+    Startup::Phase startupPhase(slot.name);
+
+    auto startTime = GetPreciseTicks();
+
+    slot.status = StatePreparing;
+    slot.state->Prepare(game);
+    slot.status = StatePrepared;
+
+    DEBUG(Txt::StatePrepared, slot.name, GetPreciseTicks() - startTime);
+}
+
+bool Engine::SwitchState(const bool waitUntilReady) {
+    auto& slot = gameStates[nextStateId];
+
+    if (slot.status == StateUnprepared) {
+        if (!waitUntilReady) {
+            PrepareState(nextStateId);
+            return false;
+        }
+
+        PrepareStateNow(nextStateId);
+    }
+
+    if ((slot.status == StatePreparing) && !waitUntilReady) {
+        return false;
+    }
+
+    if (slot.worker.joinable()) {
+        slot.worker.join();
+    }
+
+    if (Renderer::HasPendingImages()) {
+        if (!waitUntilReady) {
+            return false;
+        }
+
+        Renderer::UploadPendingImages(UINT(-1));
+    }
+
+    // Everything is loaded at this point: the swap itself only detaches the old state and attaches the new one.
+    auto swapStartTime = GetPreciseTicks();
+
+    if (currentState != NULL) {
+        currentState->Deactivate();
+    }
+
+    slot.state->Activate(game);
+
+    currentState   = slot.state;
+    currentStateId = nextStateId;
+    nextStateId    = NoState;
+
+    // A new state warms up again before it is expected to stop allocating.
+    Allocations::RestartWarmup();
+
+    auto swapEndTime = GetPreciseTicks();
+
+    transitionStatistics.count++;
+    transitionStatistics.lastLatency  = swapEndTime - transitionRequestTime;
+    transitionStatistics.lastSwapTime = swapEndTime - swapStartTime;
+    transitionStatistics.totalLatency += transitionStatistics.lastLatency;
+
+    if (transitionStatistics.lastLatency > transitionStatistics.maxLatency) {
+        transitionStatistics.maxLatency = transitionStatistics.lastLatency;
+    }
+
+    if (transitionStatistics.lastSwapTime > transitionStatistics.maxSwapTime) {
+        transitionStatistics.maxSwapTime = transitionStatistics.lastSwapTime;
+    }
+
+    Telemetry::Record(transitionLatencyMetric, U64(transitionStatistics.lastLatency * 1000.0));
+
+    DEBUG(Txt::StateChanged, slot.name);
+    INFO(Txt::StateTransition, slot.name, transitionStatistics.lastLatency, transitionStatistics.lastSwapTime);
+    return true;
+}
+
+void Engine::ReleaseStates() {
+    for (auto& slot : gameStates) {
+        if (slot.worker.joinable()) {
+            slot.worker.join();
         }
 
-        state->second->Activate(game);
+        if (slot.status == StatePrepared) {
+            slot.state->Release();
+        }
+
+        slot.status = StateUnprepared;
     }
 
-    currentState = state->second;
-    DEBUG(Txt::StateChanged, stateName);
+    currentState   = NULL;
+    currentStateId = NoState;
 }
 
 // Log
 
 #define LOG(messageFormat) \
-	static char formattedMessage[8192]; \
+	static thread_local char formattedMessage[8192]; \
 	va_list functionArguments; \
 	va_start(functionArguments, logMessage); \
 	vsprintf(formattedMessage, logMessage, functionArguments); \
@@ -218,8 +732,38 @@ uint Engine::GetTicks() {
     return SDL_GetTicks();
 }
 
+f64 Engine::GetPreciseTicks() {
+    static const f64 ticksPerMillisecond = SDL_GetPerformanceFrequency() / 1000.0;
+    return SDL_GetPerformanceCounter() / ticksPerMillisecond;
+}
+
+// The generator is a xorshift64* instead of std::rand, so its whole state can be saved and restored with the game.
+
+void Engine::SetRandomSeed(const uint seed) {
+    // Spread the seed bits (splitmix64 finalizer), the state must never be zero.
+    u64 state = seed + 0x9e3779b97f4a7c15ull;
+
+    state = (state ^ (state >> 30)) * 0xbf58476d1ce4e5b9ull;
+    state = (state ^ (state >> 27)) * 0x94d049bb133111ebull;
+    state = state ^ (state >> 31);
+
+    randomState = state != 0 ? state : 1;
+}
+
 int Engine::RandomNumber(const int minValue, const int maxValue) {
-    return (std::rand() % (maxValue - minValue + 1)) + minValue;
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+
+    return ((randomState * 0x2545f4914f6cdd1dull) >> 32) % (maxValue - minValue + 1) + minValue;
+}
+
+u64 Engine::GetRandomState() {
+    return randomState;
+}
+
+void Engine::SetRandomState(const u64 state) {
+    randomState = state != 0 ? state : 1;
 }
 
 uint Engine::SDLKeyToGameKey(const SDL_Keycode sdlKey) {
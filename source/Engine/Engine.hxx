@@ -51,16 +51,25 @@ enum {
 
 // State
 
+// States are prepared once (possibly on a worker thread, while another state is active) and stay warm until the engine is
+// finalized. Activate and Deactivate only attach and detach the prepared state to the world, so they must be cheap.
+
 class State {
     public:
         State()          = default;
         virtual ~State() = default;
 
+        virtual void Prepare(const GameInformation& game)  = 0;
+        virtual void Release()                             = 0;
         virtual void Activate(const GameInformation& game) = 0;
         virtual void Deactivate()                          = 0;
         virtual void Step(const float speedMultiplier)     = 0;
         virtual void OnPress(const uint key)               = 0;
         virtual void OnRelease(const uint key)             = 0;
+
+        // Called at the end of every frame with its time in milliseconds (steps, events, render and present, without
+        // the sleep that paces fixed rate steps), whether the frame ran a step or not.
+        virtual void OnFrame(const f64 frameTime) {}
 };
 
 // Engine
@@ -71,23 +80,62 @@ class Engine {
 
         // Constants
 
-        static constexpr charconst Tag           = "Biq";
-        static constexpr charconst Name          = "Biq Engine";
-        static constexpr uint      VersionNumber = 0x00000003;
-        static constexpr charconst VersionString = "0.3";
-        static constexpr charconst CopyrightInfo = "Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>";
+        static constexpr charconst Tag              = "Biq";
+        static constexpr charconst Name             = "Biq Engine";
+        static constexpr uint      VersionNumber    = 0x00000003;
+        static constexpr charconst VersionString    = "0.3";
+        static constexpr charconst CopyrightInfo    = "Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>";
+        static constexpr uint      MaxStates        = 8;
+        static constexpr uint      NoState          = UINT(-1);
+        static constexpr uint      MaxStepsPerFrame = 8;
+
+        // Transition Statistics
+
+        struct TransitionStatistics {
+            uint count;
+            f64  lastLatency;
+            f64  lastSwapTime;
+            f64  maxLatency;
+            f64  maxSwapTime;
+            f64  totalLatency;
+        };
 
         // General
 
-        static bool Initialize(const GameInformation& gameInformation);
+        // Everything independent is brought up at once: the audio device, the image codecs and font and (when given,
+        // registered beforehand) the initial state are loaded by workers while this thread creates the window.
+        static bool Initialize(const GameInformation& gameInformation, const uint initialStateId = NoState);
         static void Finalize();
-        static void Run(const charconst initialStateName);
+        static void Run(const uint initialStateId);
         static void Stop();
 
+        // Simulation
+
+        // By default the game is stepped once per frame with the real frame time, a fixed rate steps it with a
+        // constant time instead. The simulation clock only moves forward with the steps.
+        static void SetSimulationRate(const uint stepsPerSecond);
+        static uint GetSimulationTicks();
+        static u32  GetSimulationSteps();
+
+        // Lockstep runs exactly one fixed step per frame, whatever the frame time, so runs with the same input are
+        // the same frame by frame (for replays and captures).
+        static void SetLockstep(const bool lockstep);
+
+        // Input Recording
+
+        // Recordings hold every key event with the number of steps run before it, replays feed them back at the same
+        // steps (and ignore the keyboard) and stop the engine where the recording ended.
+        static bool RecordInput(const string& filePath);
+        static bool ReplayInput(const string& filePath);
+
         // States
 
-        static void RegisterState(const charconst stateName, const State& state);
-        static void ChangeState(const charconst stateName);
+        static void RegisterState(const uint stateId, const charconst stateName, const State& state);
+        static void PrepareState(const uint stateId);
+        static void ChangeState(const uint stateId);
+        static bool IsStateReady(const uint stateId);
+
+        static const TransitionStatistics& GetTransitionStatistics();
 
         // Log
 
@@ -100,17 +148,75 @@ class Engine {
         // Utilities
 
         static uint GetTicks();
+        static f64  GetPreciseTicks();
+        static void SetRandomSeed(const uint seed);
         static int  RandomNumber(const int minValue, const int maxValue);
+        static u64  GetRandomState();
+        static void SetRandomState(const u64 state);
 
     protected:
         Engine() = delete;
 
     private:
-        static std::atomic<bool>        isRunning;
-        static State*                   currentState;
-        static std::map<string, State*> gameStates;
-        static GameInformation          game;
-
+        enum StateStatus {
+            StateUnprepared = 0,
+            StatePreparing,
+            StatePrepared
+        };
+
+        enum InputAction {
+            InputPress = 0,
+            InputRelease,
+            InputEnd
+        };
+
+        struct InputEvent {
+            u32         step;
+            InputAction action;
+            uint        key;
+        };
+
+        struct StateSlot {
+            State*            state;
+            charconst         name;
+            std::atomic<uint> status;
+            std::thread       worker;
+        };
+
+        static std::atomic<bool>       isRunning;
+        static uint                    currentStateId;
+        static State*                  currentState;
+        static StateSlot               gameStates[MaxStates];
+        static GameInformation         game;
+        static uint                    nextStateId;
+        static f64                     transitionRequestTime;
+        static TransitionStatistics    transitionStatistics;
+        static u64                     randomState;
+        static uint                    simulationRate;
+        static uint                    simulationTicks;
+        static uint                    simulationBacklog;
+        static u32                     simulationSteps;
+        static bool                    isLockstep;
+        static FILE*                   inputRecording;
+        static std::vector<InputEvent> inputReplay;
+        static uint                    nextReplayEvent;
+        static uint                    frameTimeMetric;
+        static uint                    transitionLatencyMetric;
+        static uint                    stepZone;
+        static uint                    inputZone;
+        static uint                    renderZone;
+        static uint                    stepPhase;
+        static uint                    inputPhase;
+        static uint                    renderPhase;
+        static uint                    presentPhase;
+
+        static void PrepareStateNow(const uint stateId);
+        static bool SwitchState(const bool waitUntilReady);
+        static void ReleaseStates();
+        static void StepState(const uint stepTime, const float speedMultiplier);
+        static void HandleKey(const bool isPress, const uint key);
+        static void ReplayInputEvents();
+        static void FinishInputRecording();
         static uint SDLKeyToGameKey(const SDL_Keycode sdlKey);
 };
 
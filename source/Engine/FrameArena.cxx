@@ -0,0 +1,180 @@
+/*
+ * Source/Engine/FrameArena.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/FrameArena.hxx"
+
+#include "Engine/Allocations.hxx"
+#include "Engine/Engine.hxx"
+#include "Engine/Telemetry.hxx"
+
+#include <cstdarg>
+
+namespace Biq {
+
+// String Table
+
+namespace Txt {
+static const charconst CouldNotAllocateArena = "Could not allocate %d bytes for the frame arena";
+static const charconst ArenaOverflow         = "A frame needed %d bytes, more than the %d bytes of the frame arena (the rest comes from the heap)";
+static const charconst ArenaReport           = "Frame arena: at most %d of %d bytes in a frame, %d frames overflowed (%llu bytes)";
+}    // namespace Txt
+
+// Static Members
+
+FrameArena::Buffer     FrameArena::buffers[2]     = { { NULL, 0, 0, NULL }, { NULL, 0, 0, NULL } };
+uint                   FrameArena::currentBuffer  = 0;
+FrameArena::Statistics FrameArena::statistics     = { 0, 0, 0, 0, 0 };
+uint                   FrameArena::usedMetric     = Telemetry::InvalidMetric;
+uint                   FrameArena::peakMetric     = Telemetry::InvalidMetric;
+uint                   FrameArena::overflowMetric = Telemetry::InvalidMetric;
+
+static size_t AlignUp(const size_t value, const size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// General
+
+bool FrameArena::Initialize(const uint bytesPerFrame) {
+    DEBUG(Txt::Initializing);
+
+    auto capacity = AlignUp(bytesPerFrame, FrameArena::MaxAlignment);
+
+    for (auto& buffer : buffers) {
+        buffer = { static_cast<u8*>(malloc(capacity)), 0, 0, NULL };
+
+        if (buffer.memory == NULL) {
+            ERROR(Txt::CouldNotAllocateArena, capacity);
+            return false;
+        }
+    }
+
+    currentBuffer = 0;
+    statistics    = { UINT(capacity), 0, 0, 0, 0 };
+
+    usedMetric     = Telemetry::RegisterGauge("FrameArena.Used");
+    peakMetric     = Telemetry::RegisterGauge("FrameArena.Peak");
+    overflowMetric = Telemetry::RegisterCounter("FrameArena.Overflows");
+
+    DEBUG(Txt::Initialized);
+    return true;
+}
+
+void FrameArena::Finalize() {
+    DEBUG(Txt::Finalizing);
+
+    if (buffers[0].memory != NULL) {
+        INFO(Txt::ArenaReport, statistics.peakFrameBytes, statistics.capacity, statistics.overflowFrames, statistics.overflowBytes);
+    }
+
+    for (auto& buffer : buffers) {
+        ResetBuffer(buffer);
+        free(buffer.memory);
+        buffer.memory = NULL;
+    }
+
+    DEBUG(Txt::Finalized);
+}
+
+void FrameArena::NextFrame() {
+    auto& buffer     = buffers[currentBuffer];
+    auto  frameBytes = UINT(buffer.used + buffer.overflowBytes);
+
+    statistics.lastFrameBytes = frameBytes;
+
+    if (frameBytes > statistics.peakFrameBytes) {
+        statistics.peakFrameBytes = frameBytes;
+        Telemetry::Set(peakMetric, frameBytes);
+    }
+
+    if (buffer.overflowBytes > 0) {
+        // Only the first overflow is logged, the counters keep track of the rest.
+        if (statistics.overflowFrames == 0) {
+            WARNING(Txt::ArenaOverflow, frameBytes, statistics.capacity);
+        }
+
+        statistics.overflowFrames++;
+        statistics.overflowBytes += buffer.overflowBytes;
+        Telemetry::Add(overflowMetric, 1);
+    }
+
+    Telemetry::Set(usedMetric, frameBytes);
+
+    // The other buffer was last used two frames ago, nothing can still be pointing into it.
+    currentBuffer ^= 1;
+    ResetBuffer(buffers[currentBuffer]);
+}
+
+// Allocation
+
+void* FrameArena::Allocate(const size_t size, const size_t alignment) {
+    auto& buffer = buffers[currentBuffer];
+    auto  offset = AlignUp(buffer.used, alignment);
+
+    if ((buffer.memory == NULL) || (offset + size > statistics.capacity)) {
+        return AllocateOverflow(buffer, size, alignment);
+    }
+
+    buffer.used = offset + size;
+    return buffer.memory + offset;
+}
+
+char* FrameArena::Format(const charconst format, ...) {
+    va_list arguments;
+
+    va_start(arguments, format);
+    auto length = vsnprintf(NULL, 0, format, arguments);
+    va_end(arguments);
+
+    if (length < 0) {
+        length = 0;
+    }
+
+    auto text = static_cast<char*>(Allocate(length + 1, 1));
+
+    va_start(arguments, format);
+    vsnprintf(text, length + 1, format, arguments);
+    va_end(arguments);
+
+    return text;
+}
+
+const FrameArena::Statistics& FrameArena::GetStatistics() {
+    return statistics;
+}
+
+void* FrameArena::AllocateOverflow(Buffer& buffer, const size_t size, const size_t alignment) {
+    auto headerSize = AlignUp(sizeof(OverflowBlock), alignment);
+    auto block      = static_cast<OverflowBlock*>(malloc(headerSize + size));
+
+    if (block == NULL) {
+        abort();
+    }
+
+    // Overflow is a real heap allocation, it shows up in the allocation tracking as well.
+    Allocations::OnAllocate(size, __builtin_return_address(0));
+
+    block->next           = buffer.overflowBlocks;
+    buffer.overflowBlocks = block;
+    buffer.overflowBytes += size;
+
+    return reinterpret_cast<u8*>(block) + headerSize;
+}
+
+void FrameArena::ResetBuffer(Buffer& buffer) {
+    while (buffer.overflowBlocks != NULL) {
+        auto block            = buffer.overflowBlocks;
+        buffer.overflowBlocks = block->next;
+
+        free(block);
+        Allocations::OnFree();
+    }
+
+    buffer.used          = 0;
+    buffer.overflowBytes = 0;
+}
+
+}    // namespace Biq
@@ -0,0 +1,118 @@
+/*
+ * Source/Engine/FrameArena.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_FRAMEARENA_HXX
+#define BIQ_FRAMEARENA_HXX
+
+#include "Engine/Types.hxx"
+
+#include <cstddef>
+
+namespace Biq {
+
+// Frame arena: a linear allocator for data that only lives for a frame (text, lists of collision targets and the
+// like). There are two buffers, the engine switches them at the end of every frame and resets the one it switches to,
+// so memory taken in a frame stays valid through the next one and is then reused without ever being freed.
+//
+// The arena belongs to the main thread. When a frame needs more than the buffer holds the rest comes from the heap
+// (and is released with the buffer), the overflow is counted so the capacity can be raised.
+
+class FrameArena {
+    public:
+        ~FrameArena() = default;
+
+        // Constants
+
+        static constexpr charconst Tag             = "FrameArena";
+        static constexpr uint      DefaultCapacity = 256 * 1024;
+        static constexpr uint      MaxAlignment    = alignof(std::max_align_t);
+
+        struct Statistics {
+            uint capacity;
+            uint lastFrameBytes;
+            uint peakFrameBytes;
+            uint overflowFrames;
+            u64  overflowBytes;
+        };
+
+        // General
+
+        static bool Initialize(const uint bytesPerFrame);
+        static void Finalize();
+        static void NextFrame();
+
+        static void* Allocate(const size_t size, const size_t alignment = MaxAlignment);
+        static char* Format(const charconst format, ...);
+
+        static const Statistics& GetStatistics();
+
+    protected:
+        FrameArena() = delete;
+
+    private:
+        struct OverflowBlock {
+            OverflowBlock* next;
+        };
+
+        struct Buffer {
+            u8*            memory;
+            size_t         used;
+            size_t         overflowBytes;
+            OverflowBlock* overflowBlocks;
+        };
+
+        static Buffer     buffers[2];
+        static uint       currentBuffer;
+        static Statistics statistics;
+        static uint       usedMetric;
+        static uint       peakMetric;
+        static uint       overflowMetric;
+
+        static void* AllocateOverflow(Buffer& buffer, const size_t size, const size_t alignment);
+        static void  ResetBuffer(Buffer& buffer);
+};
+
+// STL Adapters
+
+// Containers using these must not outlive the frame after the one they were filled in, they are meant to be locals.
+
+template <typename T> class FrameAllocator {
+    public:
+        typedef T value_type;
+
+        template <typename U> struct rebind {
+            typedef FrameAllocator<U> other;
+        };
+
+        FrameAllocator() = default;
+
+        template <typename U> FrameAllocator(const FrameAllocator<U>& allocator) {
+        }
+
+        T* allocate(const size_t count) {
+            return static_cast<T*>(FrameArena::Allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* memory, const size_t count) {
+            // Nothing, the whole buffer is reset at once.
+        }
+};
+
+template <typename T, typename U> bool operator==(const FrameAllocator<T>& first, const FrameAllocator<U>& second) {
+    return true;
+}
+
+template <typename T, typename U> bool operator!=(const FrameAllocator<T>& first, const FrameAllocator<U>& second) {
+    return false;
+}
+
+template <typename T> using FrameVector = std::vector<T, FrameAllocator<T>>;
+typedef std::basic_string<char, std::char_traits<char>, FrameAllocator<char>> FrameString;
+
+}    // namespace Biq
+
+#endif    // BIQ_FRAMEARENA_HXX
@@ -0,0 +1,321 @@
+/*
+ * Source/Engine/Overdraw.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/Overdraw.hxx"
+
+#include "Engine/Engine.hxx"
+#include "Engine/Renderer.hxx"
+
+#include "SDL2/SDL_image.h"
+
+#include <cstring>
+
+namespace Biq {
+
+// String Table
+
+namespace Txt {
+static const charconst AnalyzingOverdraw     = "Counting the writes to each pixel of a %dx%d frame, reporting every %d frames";
+static const charconst IntervalTitle         = "Overdraw, last %llu frames drawn";
+static const charconst RunTitle              = "Overdraw, whole run, %llu frames drawn";
+static const charconst Summary               = "%.2f writes per pixel (%.2f blended), at most %d on one pixel, %.1f%% of the pixels written %d times or more";
+static const charconst LayerHeader           = "%-8s %12s %12s";
+static const charconst LayerReport           = "%-8s %12.3f %12.3f";
+static const charconst OtherLayerName        = "other";
+static const charconst HeatmapWritten        = "Overdraw heatmap written to \"%s\" (black none, blue 1, green 2, yellow 3, orange 4, red 5, white %d or more writes)";
+static const charconst CouldNotWriteHeatmap  = "Could not write the overdraw heatmap \"%s\": %s";
+}    // namespace Txt
+
+// Static Members
+
+bool                 Overdraw::isEnabled    = false;
+string               Overdraw::heatmapPath;
+uint                 Overdraw::reportFrames = Overdraw::DefaultReportFrames;
+int                  Overdraw::frameWidth   = 0;
+int                  Overdraw::frameHeight  = 0;
+SDL_Rect             Overdraw::clipRect;
+uint                 Overdraw::currentLayer = Overdraw::OtherLayer;
+std::vector<u16>     Overdraw::frameWrites;
+std::vector<u32>     Overdraw::runWrites;
+Overdraw::Statistics Overdraw::frame;
+Overdraw::Statistics Overdraw::interval;
+Overdraw::Statistics Overdraw::run;
+
+// General
+
+bool Overdraw::Start(const string& filePath, const uint numberOfFrames) {
+    Stop();
+
+    auto& frameRect = Renderer::GetFrameRect();
+
+    if ((frameRect.w <= 0) || (frameRect.h <= 0)) {
+        return false;
+    }
+
+    heatmapPath  = filePath;
+    reportFrames = std::max(numberOfFrames, 1u);
+    frameWidth   = frameRect.w;
+    frameHeight  = frameRect.h;
+    clipRect     = { 0, 0, frameWidth, frameHeight };
+    currentLayer = Overdraw::OtherLayer;
+    frame        = {};
+    interval     = {};
+    run          = {};
+
+    frameWrites.assign(frameWidth * frameHeight, 0);
+    runWrites.assign(frameWidth * frameHeight, 0);
+
+    isEnabled = true;
+
+    INFO(Txt::AnalyzingOverdraw, frameWidth, frameHeight, reportFrames);
+    return true;
+}
+
+void Overdraw::Stop() {
+    if (!isEnabled) {
+        return;
+    }
+
+    Report(Txt::RunTitle, run);
+
+    if (!heatmapPath.empty() && (run.frames > 0) && WriteHeatmap()) {
+        INFO(Txt::HeatmapWritten, heatmapPath.c_str(), Overdraw::HeatmapMax);
+    }
+
+    frameWrites.clear();
+    frameWrites.shrink_to_fit();
+    runWrites.clear();
+    runWrites.shrink_to_fit();
+
+    isEnabled = false;
+}
+
+bool Overdraw::IsEnabled() {
+    return isEnabled;
+}
+
+const Overdraw::Statistics& Overdraw::GetStatistics() {
+    return run;
+}
+
+// Counting
+
+void Overdraw::SetLayer(const uint layerIndex) {
+    currentLayer = std::min(layerIndex, Overdraw::OtherLayer);
+}
+
+// Partial frames clip their draws to the damage, so do the counts.
+void Overdraw::SetClip(const SDL_Rect* newClipRect) {
+    SDL_Rect frameRect = { 0, 0, frameWidth, frameHeight };
+
+    if ((newClipRect == NULL) || !SDL_IntersectRect(newClipRect, &frameRect, &clipRect)) {
+        clipRect = newClipRect == NULL ? frameRect : SDL_Rect { 0, 0, 0, 0 };
+    }
+}
+
+void Overdraw::AddRect(const SDL_Rect& rect, const bool isBlended) {
+    SDL_Rect countedRect;
+
+    if (!isEnabled || !SDL_IntersectRect(&rect, &clipRect, &countedRect)) {
+        return;
+    }
+
+    for (int y = countedRect.y; y < countedRect.y + countedRect.h; y++) {
+        CountSpan(y, countedRect.x, countedRect.x + countedRect.w, isBlended);
+    }
+}
+
+// Triangles cover the pixels whose centers they contain. Centers right on an edge go to the triangle the edge is a top
+// or left one of, so the two triangles of a quad count their shared diagonal once. Triangles are always blended.
+void Overdraw::AddTriangles(const SDL_Vertex* vertices, const uint numberOfVertices, const int* indices, const uint numberOfIndices) {
+    if (!isEnabled) {
+        return;
+    }
+
+    auto numberOfCorners = indices != NULL ? numberOfIndices : numberOfVertices;
+
+    for (uint cornerIndex = 0; cornerIndex + 2 < numberOfCorners; cornerIndex += 3) {
+        SDL_FPoint corners[3];
+        auto       isValid = true;
+
+        for (uint corner = 0; corner < 3; corner++) {
+            auto vertexIndex = indices != NULL ? UINT(indices[cornerIndex + corner]) : cornerIndex + corner;
+
+            isValid         = isValid && (vertexIndex < numberOfVertices);
+            corners[corner] = isValid ? vertices[vertexIndex].position : SDL_FPoint { 0.0f, 0.0f };
+        }
+
+        auto area = ((corners[1].x - corners[0].x) * (corners[2].y - corners[0].y)) - ((corners[1].y - corners[0].y) * (corners[2].x - corners[0].x));
+
+        if (!isValid || (area == 0.0f)) {
+            continue;
+        }
+
+        // Clockwise on screen (y down), the inside is on the same side of every edge.
+        if (area < 0.0f) {
+            std::swap(corners[1], corners[2]);
+        }
+
+        auto left   = std::max(I32(std::floor(std::min({ corners[0].x, corners[1].x, corners[2].x }))), clipRect.x);
+        auto right  = std::min(I32(std::ceil(std::max({ corners[0].x, corners[1].x, corners[2].x }))), clipRect.x + clipRect.w);
+        auto top    = std::max(I32(std::floor(std::min({ corners[0].y, corners[1].y, corners[2].y }))), clipRect.y);
+        auto bottom = std::min(I32(std::ceil(std::max({ corners[0].y, corners[1].y, corners[2].y }))), clipRect.y + clipRect.h);
+
+        for (int y = top; y < bottom; y++) {
+            auto spanLeft  = right;
+            auto spanRight = left;
+
+            for (int x = left; x < right; x++) {
+                auto isInside = true;
+
+                for (uint edge = 0; isInside && (edge < 3); edge++) {
+                    auto& from      = corners[edge];
+                    auto& to        = corners[(edge + 1) % 3];
+                    auto  side      = ((to.x - from.x) * ((y + 0.5f) - from.y)) - ((to.y - from.y) * ((x + 0.5f) - from.x));
+                    auto  isTopLeft = ((to.y == from.y) && (to.x < from.x)) || (to.y > from.y);
+
+                    isInside = (side > 0.0f) || ((side == 0.0f) && isTopLeft);
+                }
+
+                if (isInside) {
+                    spanLeft  = std::min(spanLeft, x);
+                    spanRight = x + 1;
+                }
+            }
+
+            if (spanLeft < spanRight) {
+                CountSpan(y, spanLeft, spanRight, true);
+            }
+        }
+    }
+}
+
+void Overdraw::CountSpan(const int y, const int left, const int right, const bool isBlended) {
+    auto row = frameWrites.data() + (y * frameWidth);
+
+    for (int x = left; x < right; x++) {
+        row[x] += row[x] < 0xFFFF ? 1 : 0;
+    }
+
+    frame.layerWrites[currentLayer] += right - left;
+    frame.layerBlended[currentLayer] += isBlended ? right - left : 0;
+}
+
+void Overdraw::EndFrame() {
+    if (!isEnabled) {
+        return;
+    }
+
+    frame.frames = 1;
+
+    for (uint pixelIndex = 0; pixelIndex < frameWrites.size(); pixelIndex++) {
+        auto writes = frameWrites[pixelIndex];
+
+        frame.maxWrites   = std::max(frame.maxWrites, UINT(writes));
+        frame.deepPixels += writes >= Overdraw::DeepOverdraw ? 1 : 0;
+        runWrites[pixelIndex] += writes;
+    }
+
+    Accumulate(interval);
+    Accumulate(run);
+
+    std::fill(frameWrites.begin(), frameWrites.end(), 0);
+    frame        = {};
+    currentLayer = Overdraw::OtherLayer;
+
+    if (interval.frames >= reportFrames) {
+        Report(Txt::IntervalTitle, interval);
+        interval = {};
+    }
+}
+
+void Overdraw::Accumulate(Statistics& totals) {
+    totals.frames     += frame.frames;
+    totals.deepPixels += frame.deepPixels;
+    totals.maxWrites   = std::max(totals.maxWrites, frame.maxWrites);
+
+    for (uint layerIndex = 0; layerIndex <= Overdraw::MaxLayers; layerIndex++) {
+        totals.layerWrites[layerIndex] += frame.layerWrites[layerIndex];
+        totals.layerBlended[layerIndex] += frame.layerBlended[layerIndex];
+    }
+}
+
+// Reporting
+
+// Everything is per pixel of the frame, averaged over the frames drawn.
+void Overdraw::Report(const charconst title, const Statistics& totals) {
+    if (totals.frames == 0) {
+        return;
+    }
+
+    auto framePixels = F64(frameWidth) * frameHeight * totals.frames;
+    u64  writes      = 0;
+    u64  blended     = 0;
+
+    for (uint layerIndex = 0; layerIndex <= Overdraw::MaxLayers; layerIndex++) {
+        writes += totals.layerWrites[layerIndex];
+        blended += totals.layerBlended[layerIndex];
+    }
+
+    INFO(title, (unsigned long long) totals.frames);
+    INFO(Txt::Summary, writes / framePixels, blended / framePixels, totals.maxWrites, (totals.deepPixels / framePixels) * 100.0, Overdraw::DeepOverdraw);
+    INFO(Txt::LayerHeader, "layer", "writes/px", "blended/px");
+
+    for (uint layerIndex = 0; layerIndex <= Overdraw::MaxLayers; layerIndex++) {
+        if (totals.layerWrites[layerIndex] == 0) {
+            continue;
+        }
+
+        char layerName[16];
+        snprintf(layerName, sizeof(layerName), "%u", layerIndex);
+
+        INFO(Txt::LayerReport, layerIndex == Overdraw::OtherLayer ? Txt::OtherLayerName : layerName, totals.layerWrites[layerIndex] / framePixels, totals.layerBlended[layerIndex] / framePixels);
+    }
+}
+
+// Average writes per pixel, on a ramp with one color per write.
+bool Overdraw::WriteHeatmap() {
+    static const u32 RampColors[Overdraw::HeatmapMax + 1] = { 0x000000, 0x2040C0, 0x20A040, 0xE0E020, 0xF08020, 0xE02020, 0xFFFFFF };
+
+    auto heatmapSurface = SDL_CreateRGBSurfaceWithFormat(0, frameWidth, frameHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+
+    if (heatmapSurface == NULL) {
+        ERROR(Txt::CouldNotWriteHeatmap, heatmapPath.c_str(), SDL_GetError());
+        return false;
+    }
+
+    for (int y = 0; y < frameHeight; y++) {
+        auto heatmapRow = reinterpret_cast<u32*>(DATA(heatmapSurface->pixels) + y * heatmapSurface->pitch);
+
+        for (int x = 0; x < frameWidth; x++) {
+            auto writes = std::min(F32(runWrites[(y * frameWidth) + x]) / run.frames, F32(Overdraw::HeatmapMax));
+            auto stop   = std::min(UINT(writes), Overdraw::HeatmapMax - 1);
+            auto weight = writes - stop;
+            u32  color  = 0xFF000000;
+
+            for (uint shift = 0; shift < 24; shift += 8) {
+                auto from = F32((RampColors[stop] >> shift) & 0xFF);
+                auto to   = F32((RampColors[stop + 1] >> shift) & 0xFF);
+
+                color |= U32(from + ((to - from) * weight) + 0.5f) << shift;
+            }
+
+            heatmapRow[x] = color;
+        }
+    }
+
+    auto isWritten = IMG_SavePNG(heatmapSurface, heatmapPath.c_str()) == 0;
+
+    if (!isWritten) {
+        ERROR(Txt::CouldNotWriteHeatmap, heatmapPath.c_str(), IMG_GetError());
+    }
+
+    SDL_FreeSurface(heatmapSurface);
+    return isWritten;
+}
+
+}    // namespace Biq
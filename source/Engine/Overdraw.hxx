@@ -0,0 +1,91 @@
+/*
+ * Source/Engine/Overdraw.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_OVERDRAW_HXX
+#define BIQ_OVERDRAW_HXX
+
+#include "Engine/Types.hxx"
+#include "SDL2/SDL.h"
+
+namespace Biq {
+
+// Overdraw analysis: every rect and triangle the renderer fills is also counted, pixel by pixel, in a shadow buffer the
+// size of the frame (in logical pixels, whatever the resolution scale). At the end of each drawn frame the counts give
+// the mean and maximum number of writes per pixel, and the writes of each world layer are split into blended and
+// opaque ones. Every n frames the totals are logged, and once more for the whole run when the analysis stops, which
+// also writes a heatmap of the average writes per pixel (black none, then blue, green, yellow, orange and red, white
+// from HeatmapMax on).
+//
+// Draws made before the world sets a layer (partial frame clears, states drawing on their own) count as "other".
+// Frames that are skipped are not drawn and not counted.
+
+class Overdraw {
+    public:
+        ~Overdraw() = default;
+
+        // Constants
+
+        static constexpr charconst Tag                 = "Overdraw";
+        static constexpr uint      MaxLayers           = 16;
+        static constexpr uint      OtherLayer          = MaxLayers;
+        static constexpr uint      DefaultReportFrames = 300;
+        static constexpr uint      DeepOverdraw        = 4;
+        static constexpr uint      HeatmapMax          = 6;
+
+        // Writes are counted in pixels, summed over the frames drawn.
+        struct Statistics {
+            u64  frames;
+            u64  deepPixels;
+            uint maxWrites;
+            u64  layerWrites[MaxLayers + 1];
+            u64  layerBlended[MaxLayers + 1];
+        };
+
+        // General
+
+        // Must be called after the renderer is initialized. The heatmap is not written when the path is empty.
+        static bool Start(const string& heatmapPath, const uint reportFrames = DefaultReportFrames);
+        static void Stop();
+        static bool IsEnabled();
+
+        // Counting (called by the world and the renderer)
+
+        static void SetLayer(const uint layerIndex);
+        static void SetClip(const SDL_Rect* clipRect);
+        static void AddRect(const SDL_Rect& rect, const bool isBlended);
+        static void AddTriangles(const SDL_Vertex* vertices, const uint numberOfVertices, const int* indices, const uint numberOfIndices);
+        static void EndFrame();
+
+        // The whole run so far.
+        static const Statistics& GetStatistics();
+
+    protected:
+        Overdraw() = delete;
+
+    private:
+        static bool             isEnabled;
+        static string           heatmapPath;
+        static uint             reportFrames;
+        static int              frameWidth;
+        static int              frameHeight;
+        static SDL_Rect         clipRect;
+        static uint             currentLayer;
+        static std::vector<u16> frameWrites;
+        static std::vector<u32> runWrites;
+        static Statistics       frame;
+        static Statistics       interval;
+        static Statistics       run;
+
+        static void CountSpan(const int y, const int left, const int right, const bool isBlended);
+        static void Accumulate(Statistics& totals);
+        static void Report(const charconst title, const Statistics& totals);
+        static bool WriteHeatmap();
+};
+
+}    // namespace Biq
+
+#endif    // BIQ_OVERDRAW_HXX
@@ -0,0 +1,227 @@
+/*
+ * Source/Engine/Overlap.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/Overlap.hxx"
+
+#include "Engine/Engine.hxx"
+#include "Engine/FrameArena.hxx"
+
+#include <cstring>
+
+#if defined(ArchX64) || defined(ArchX86)
+    #include <immintrin.h>
+
+    #define OverlapSIMD
+#endif
+
+namespace Biq {
+
+// String Table
+
+namespace Txt {
+static const charconst UsingImplementation = "Batched overlap tests use the %s implementation";
+
+static const charconst ImplementationNames[Overlap::MaxImplementations] = { "scalar", "SSE", "AVX2" };
+}    // namespace Txt
+
+// Static Members
+
+Overlap::Implementation Overlap::currentImplementation = Overlap::Scalar;
+Overlap::Kernel         Overlap::kernels[Overlap::MaxImplementations] = { Overlap::TestScalar, Overlap::TestSSE, Overlap::TestAVX2 };
+
+// Boxes
+
+Overlap::Boxes::Boxes() :
+    lefts(NULL), tops(NULL), rights(NULL), bottoms(NULL), count(0), capacity(0) {
+}
+
+// Growing copies the boxes to a new block of the arena, reserving enough up front avoids that.
+void Overlap::Boxes::Reserve(const uint newCapacity) {
+    if (newCapacity <= capacity) {
+        return;
+    }
+
+    auto paddedCapacity = (newCapacity + Overlap::BatchSize - 1) & ~(Overlap::BatchSize - 1);
+    auto coordinates    = static_cast<f32*>(FrameArena::Allocate(paddedCapacity * 4 * sizeof(f32)));
+
+    // Padding is NaN, every comparison with it is false.
+    std::fill(coordinates, coordinates + (paddedCapacity * 4), NAN);
+
+    if (count > 0) {
+        memcpy(coordinates, lefts, count * sizeof(f32));
+        memcpy(coordinates + paddedCapacity, tops, count * sizeof(f32));
+        memcpy(coordinates + (paddedCapacity * 2), rights, count * sizeof(f32));
+        memcpy(coordinates + (paddedCapacity * 3), bottoms, count * sizeof(f32));
+    }
+
+    lefts    = coordinates;
+    tops     = coordinates + paddedCapacity;
+    rights   = coordinates + (paddedCapacity * 2);
+    bottoms  = coordinates + (paddedCapacity * 3);
+    capacity = paddedCapacity;
+}
+
+void Overlap::Boxes::Add(const Box& box) {
+    if (count == capacity) {
+        Reserve(std::max(capacity * 2, Overlap::BatchSize));
+    }
+
+    lefts[count]   = box.left;
+    tops[count]    = box.top;
+    rights[count]  = box.right;
+    bottoms[count] = box.bottom;
+    count++;
+}
+
+void Overlap::Boxes::Remove(const uint boxIndex) {
+    if (boxIndex >= count) {
+        return;
+    }
+
+    lefts[boxIndex]   = NAN;
+    tops[boxIndex]    = NAN;
+    rights[boxIndex]  = NAN;
+    bottoms[boxIndex] = NAN;
+}
+
+uint Overlap::Boxes::GetCount() const {
+    return count;
+}
+
+// General
+
+void Overlap::Initialize() {
+#ifdef OverlapSIMD
+    __builtin_cpu_init();
+#endif
+
+    currentImplementation = IsSupported(Overlap::AVX2) ? Overlap::AVX2 : (IsSupported(Overlap::SSE) ? Overlap::SSE : Overlap::Scalar);
+    DEBUG(Txt::UsingImplementation, GetImplementationName(currentImplementation));
+}
+
+bool Overlap::SetImplementation(const Implementation implementation) {
+    if (!IsSupported(implementation)) {
+        return false;
+    }
+
+    currentImplementation = implementation;
+    return true;
+}
+
+Overlap::Implementation Overlap::GetImplementation() {
+    return currentImplementation;
+}
+
+bool Overlap::IsSupported(const Implementation implementation) {
+    switch (implementation) {
+        case Overlap::Scalar: return true;
+
+#ifdef OverlapSIMD
+        case Overlap::SSE: return __builtin_cpu_supports("sse");
+        case Overlap::AVX2: return __builtin_cpu_supports("avx2");
+#endif
+
+        default: return false;
+    }
+}
+
+charconst Overlap::GetImplementationName(const Implementation implementation) {
+    return implementation < Overlap::MaxImplementations ? Txt::ImplementationNames[implementation] : Txt::Empty;
+}
+
+// Tests
+
+uint Overlap::Test(const Box& box, const Boxes& boxes, u32* hitMask) {
+    return kernels[currentImplementation](box, boxes, hitMask);
+}
+
+uint Overlap::MaskWords(const uint numberOfBoxes) {
+    return (numberOfBoxes + 31) / 32;
+}
+
+bool Overlap::IsHit(const u32* hitMask, const uint boxIndex) {
+    return (hitMask[boxIndex / 32] & (1u << (boxIndex % 32))) != 0;
+}
+
+// Kernels
+
+// The reference: the same comparisons as World::CheckCollision, with the right and bottom edges already added up.
+uint Overlap::TestScalar(const Box& box, const Boxes& boxes, u32* hitMask) {
+    uint hits = 0;
+
+    memset(hitMask, 0, MaskWords(boxes.count) * sizeof(u32));
+
+    for (uint boxIndex = 0; boxIndex < boxes.count; boxIndex++) {
+        if ((box.right > boxes.lefts[boxIndex]) && (box.left < boxes.rights[boxIndex]) && (box.bottom > boxes.tops[boxIndex]) && (box.top < boxes.bottoms[boxIndex])) {
+            hitMask[boxIndex / 32] |= 1u << (boxIndex % 32);
+            hits++;
+        }
+    }
+
+    return hits;
+}
+
+// The SIMD kernels go through whole batches, the padding past the count never overlaps. Batches never straddle two
+// mask words (32 is a multiple of both widths).
+
+#ifdef OverlapSIMD
+
+__attribute__((target("sse"))) uint Overlap::TestSSE(const Box& box, const Boxes& boxes, u32* hitMask) {
+    auto left   = _mm_set1_ps(box.left);
+    auto top    = _mm_set1_ps(box.top);
+    auto right  = _mm_set1_ps(box.right);
+    auto bottom = _mm_set1_ps(box.bottom);
+    uint hits   = 0;
+
+    memset(hitMask, 0, MaskWords(boxes.count) * sizeof(u32));
+
+    for (uint boxIndex = 0; boxIndex < boxes.count; boxIndex += 4) {
+        auto horizontal = _mm_and_ps(_mm_cmpgt_ps(right, _mm_loadu_ps(boxes.lefts + boxIndex)), _mm_cmplt_ps(left, _mm_loadu_ps(boxes.rights + boxIndex)));
+        auto vertical   = _mm_and_ps(_mm_cmpgt_ps(bottom, _mm_loadu_ps(boxes.tops + boxIndex)), _mm_cmplt_ps(top, _mm_loadu_ps(boxes.bottoms + boxIndex)));
+        auto batchMask  = UINT(_mm_movemask_ps(_mm_and_ps(horizontal, vertical)));
+
+        hitMask[boxIndex / 32] |= batchMask << (boxIndex % 32);
+        hits += __builtin_popcount(batchMask);
+    }
+
+    return hits;
+}
+
+__attribute__((target("avx2"))) uint Overlap::TestAVX2(const Box& box, const Boxes& boxes, u32* hitMask) {
+    auto left   = _mm256_set1_ps(box.left);
+    auto top    = _mm256_set1_ps(box.top);
+    auto right  = _mm256_set1_ps(box.right);
+    auto bottom = _mm256_set1_ps(box.bottom);
+    uint hits   = 0;
+
+    memset(hitMask, 0, MaskWords(boxes.count) * sizeof(u32));
+
+    for (uint boxIndex = 0; boxIndex < boxes.count; boxIndex += 8) {
+        auto horizontal = _mm256_and_ps(_mm256_cmp_ps(right, _mm256_loadu_ps(boxes.lefts + boxIndex), _CMP_GT_OQ), _mm256_cmp_ps(left, _mm256_loadu_ps(boxes.rights + boxIndex), _CMP_LT_OQ));
+        auto vertical   = _mm256_and_ps(_mm256_cmp_ps(bottom, _mm256_loadu_ps(boxes.tops + boxIndex), _CMP_GT_OQ), _mm256_cmp_ps(top, _mm256_loadu_ps(boxes.bottoms + boxIndex), _CMP_LT_OQ));
+        auto batchMask  = UINT(_mm256_movemask_ps(_mm256_and_ps(horizontal, vertical)));
+
+        hitMask[boxIndex / 32] |= batchMask << (boxIndex % 32);
+        hits += __builtin_popcount(batchMask);
+    }
+
+    return hits;
+}
+
+#else
+
+uint Overlap::TestSSE(const Box& box, const Boxes& boxes, u32* hitMask) {
+    return TestScalar(box, boxes, hitMask);
+}
+
+uint Overlap::TestAVX2(const Box& box, const Boxes& boxes, u32* hitMask) {
+    return TestScalar(box, boxes, hitMask);
+}
+
+#endif
+
+}    // namespace Biq
@@ -0,0 +1,98 @@
+/*
+ * Source/Engine/Overlap.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_OVERLAP_HXX
+#define BIQ_OVERLAP_HXX
+
+#include "Engine/Types.hxx"
+
+namespace Biq {
+
+// Overlap: tests one box against many at once and sets a bit for every box it overlaps (they share more than an
+// edge, like World::CheckCollision). The boxes are packed one coordinate after the other, so the SSE implementation
+// compares 4 boxes per instruction and the AVX2 one 8. The best implementation the processor supports is picked when
+// the engine starts, the others can still be selected (the benchmark compares them).
+
+class Overlap {
+    public:
+        ~Overlap() = default;
+
+        // Constants
+
+        static constexpr charconst Tag       = "Overlap";
+        static constexpr uint      BatchSize = 8;
+
+        enum Implementation {
+            Scalar = 0,
+            SSE,
+            AVX2,
+            MaxImplementations
+        };
+
+        struct Box {
+            f32 left;
+            f32 top;
+            f32 right;
+            f32 bottom;
+        };
+
+        // Packed boxes live in the frame arena, like the other lists built during a frame. The capacity is rounded up
+        // to BatchSize, the boxes past the count (and removed ones) never overlap anything.
+
+        class Boxes {
+            public:
+                Boxes();
+
+                void Reserve(const uint capacity);
+                void Add(const Box& box);
+                void Remove(const uint boxIndex);
+                uint GetCount() const;
+
+            private:
+                friend class Overlap;
+
+                f32* lefts;
+                f32* tops;
+                f32* rights;
+                f32* bottoms;
+                uint count;
+                uint capacity;
+        };
+
+        // General
+
+        static void           Initialize();
+        static bool           SetImplementation(const Implementation implementation);
+        static Implementation GetImplementation();
+        static bool           IsSupported(const Implementation implementation);
+        static charconst      GetImplementationName(const Implementation implementation);
+
+        // Tests
+
+        // The hit mask needs MaskWords(count) words, bit n of word n / 32 is set when the box overlaps box n. Returns the
+        // number of boxes it overlaps.
+        static uint Test(const Box& box, const Boxes& boxes, u32* hitMask);
+        static uint MaskWords(const uint numberOfBoxes);
+        static bool IsHit(const u32* hitMask, const uint boxIndex);
+
+    protected:
+        Overlap() = delete;
+
+    private:
+        typedef uint (*Kernel)(const Box& box, const Boxes& boxes, u32* hitMask);
+
+        static Implementation currentImplementation;
+        static Kernel         kernels[MaxImplementations];
+
+        static uint TestScalar(const Box& box, const Boxes& boxes, u32* hitMask);
+        static uint TestSSE(const Box& box, const Boxes& boxes, u32* hitMask);
+        static uint TestAVX2(const Box& box, const Boxes& boxes, u32* hitMask);
+};
+
+}    // namespace Biq
+
+#endif    // BIQ_OVERLAP_HXX
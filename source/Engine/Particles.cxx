@@ -0,0 +1,297 @@
+/*
+ * Source/Engine/Particles.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/Particles.hxx"
+
+#include "Engine/Engine.hxx"
+#include "Engine/Renderer.hxx"
+#include "Engine/Telemetry.hxx"
+
+#include <cstring>
+
+namespace Biq {
+
+// String Table
+
+namespace Txt {
+static const charconst CouldNotAllocateParticles = "Could not allocate the pool for %d particles";
+static const charconst InitializingParticles     = "Initializing the particle pool (%d particles, %d KB)";
+}    // namespace Txt
+
+// Static Members
+
+u8*  Particles::memory      = NULL;
+uint Particles::capacity    = 0;
+uint Particles::count       = 0;
+uint Particles::layerCounts[Particles::MaxLayers];
+u32  Particles::randomState = 0x9e3779b9;
+
+f32*       Particles::positionsX     = NULL;
+f32*       Particles::positionsY     = NULL;
+f32*       Particles::speedsX        = NULL;
+f32*       Particles::speedsY        = NULL;
+f32*       Particles::lifetimes      = NULL;
+f32*       Particles::lifetimeScales = NULL;
+f32*       Particles::alphas         = NULL;
+f32*       Particles::sizes          = NULL;
+SDL_Color* Particles::colors         = NULL;
+u8*        Particles::layers         = NULL;
+
+SDL_Vertex* Particles::vertices = NULL;
+int*        Particles::indices  = NULL;
+
+uint Particles::countMetric = Telemetry::InvalidMetric;
+
+// Four lanes vectors (SSE on x86, NEON on ARM), loaded and stored through memcpy so they can not break aliasing rules.
+
+typedef f32 f32x4 __attribute__((vector_size(16)));
+typedef i32 i32x4 __attribute__((vector_size(16)));
+
+static inline f32x4 Load(const f32* source) {
+    f32x4 value;
+    memcpy(&value, source, sizeof(value));
+    return value;
+}
+
+static inline void Store(f32* destination, const f32x4 value) {
+    memcpy(destination, &value, sizeof(value));
+}
+
+static inline f32x4 Splat(const f32 value) {
+    return f32x4 { value, value, value, value };
+}
+
+static size_t AlignUp(const size_t value, const size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// General
+
+bool Particles::Initialize(const uint poolCapacity) {
+    // Every array is padded to a whole number of cache lines, the update then never needs a scalar tail.
+    auto paddedCapacity = AlignUp(poolCapacity, Particles::Alignment / sizeof(f32));
+    auto floatsSize     = paddedCapacity * sizeof(f32);
+    auto verticesSize   = AlignUp(poolCapacity * 4 * sizeof(SDL_Vertex), Particles::Alignment);
+    auto indicesSize    = AlignUp(poolCapacity * 6 * sizeof(int), Particles::Alignment);
+    auto totalSize      = (floatsSize * 9) + AlignUp(paddedCapacity, Particles::Alignment) + verticesSize + indicesSize;
+
+    DEBUG(Txt::InitializingParticles, poolCapacity, totalSize / 1024);
+
+    memory = static_cast<u8*>(malloc(totalSize + Particles::Alignment));
+
+    if (memory == NULL) {
+        ERROR(Txt::CouldNotAllocateParticles, poolCapacity);
+        return false;
+    }
+
+    auto block = reinterpret_cast<u8*>(AlignUp(reinterpret_cast<uintptr_t>(memory), Particles::Alignment));
+
+    // Lanes past the count are zeroed (here, and by Remove and Clear as particles leave them), the update goes through
+    // the ones sharing a vector with live particles and zeros can not decay into denormals or turn into NaNs.
+    memset(block, 0, totalSize);
+
+    positionsX     = reinterpret_cast<f32*>(block);
+    positionsY     = reinterpret_cast<f32*>(block += floatsSize);
+    speedsX        = reinterpret_cast<f32*>(block += floatsSize);
+    speedsY        = reinterpret_cast<f32*>(block += floatsSize);
+    lifetimes      = reinterpret_cast<f32*>(block += floatsSize);
+    lifetimeScales = reinterpret_cast<f32*>(block += floatsSize);
+    alphas         = reinterpret_cast<f32*>(block += floatsSize);
+    sizes          = reinterpret_cast<f32*>(block += floatsSize);
+    colors         = reinterpret_cast<SDL_Color*>(block += floatsSize);
+    layers         = reinterpret_cast<u8*>(block += floatsSize);
+    vertices       = reinterpret_cast<SDL_Vertex*>(block += AlignUp(paddedCapacity, Particles::Alignment));
+    indices        = reinterpret_cast<int*>(block += verticesSize);
+
+    for (uint particleIndex = 0; particleIndex < poolCapacity; particleIndex++) {
+        auto firstVertex = I32(particleIndex * 4);
+        auto quad        = indices + (particleIndex * 6);
+
+        quad[0] = firstVertex;
+        quad[1] = firstVertex + 1;
+        quad[2] = firstVertex + 2;
+        quad[3] = firstVertex + 2;
+        quad[4] = firstVertex + 3;
+        quad[5] = firstVertex;
+    }
+
+    capacity    = poolCapacity;
+    countMetric = Telemetry::RegisterGauge("Particles.Count");
+
+    Clear();
+
+    DEBUG(Txt::Initialized);
+    return true;
+}
+
+void Particles::Finalize() {
+    DEBUG(Txt::Finalizing);
+
+    free(memory);
+
+    memory   = NULL;
+    capacity = 0;
+    count    = 0;
+
+    DEBUG(Txt::Finalized);
+}
+
+void Particles::Clear() {
+    // Removing from the back only zeroes the lanes and takes the layer counts down to zero.
+    while (count > 0) {
+        Remove(count - 1);
+    }
+}
+
+void Particles::Update(const float speedMultiplier) {
+    if (count == 0) {
+        return;
+    }
+
+    auto elapsed = Splat(speedMultiplier);
+    auto drag    = Splat(std::pow(Particles::Drag, speedMultiplier));
+    auto zero    = Splat(0.0f);
+
+    for (uint particleIndex = 0; particleIndex < count; particleIndex += 4) {
+        auto speedX   = Load(speedsX + particleIndex);
+        auto speedY   = Load(speedsY + particleIndex);
+        auto lifetime = Load(lifetimes + particleIndex) - elapsed;
+        auto alpha    = lifetime * Load(lifetimeScales + particleIndex);
+
+        Store(positionsX + particleIndex, Load(positionsX + particleIndex) + speedX * elapsed);
+        Store(positionsY + particleIndex, Load(positionsY + particleIndex) + speedY * elapsed);
+        Store(speedsX + particleIndex, speedX * drag);
+        Store(speedsY + particleIndex, speedY * drag);
+        Store(lifetimes + particleIndex, lifetime);
+
+        // Fades out linearly, clamped at zero (the comparison gives all bits set on the lanes still alive).
+        Store(alphas + particleIndex, reinterpret_cast<f32x4>(reinterpret_cast<i32x4>(alpha) & (lifetime > zero)));
+    }
+
+    // Dead particles are replaced by the last one, going backwards every particle moved is already known to be alive.
+    for (uint particleIndex = count; particleIndex-- > 0;) {
+        if (lifetimes[particleIndex] <= 0.0f) {
+            Remove(particleIndex);
+        }
+    }
+
+    Telemetry::Set(countMetric, count);
+}
+
+// Particles are emitted in world coordinates, the offset (the camera) takes them to the screen.
+void Particles::Render(const uint layerIndex, const Vector2D& offset) {
+    if ((layerIndex >= Particles::MaxLayers) || (layerCounts[layerIndex] == 0)) {
+        return;
+    }
+
+    auto vertex = vertices;
+
+    for (uint particleIndex = 0; particleIndex < count; particleIndex++) {
+        if (layers[particleIndex] != layerIndex) {
+            continue;
+        }
+
+        auto halfSize = sizes[particleIndex] * 0.5f;
+        auto left     = positionsX[particleIndex] - halfSize - offset.x;
+        auto top      = positionsY[particleIndex] - halfSize - offset.y;
+        auto right    = left + sizes[particleIndex];
+        auto bottom   = top + sizes[particleIndex];
+        auto color    = colors[particleIndex];
+
+        color.a = U8(color.a * alphas[particleIndex]);
+
+        vertex[0] = { { left, top }, color, { 0.0f, 0.0f } };
+        vertex[1] = { { right, top }, color, { 0.0f, 0.0f } };
+        vertex[2] = { { right, bottom }, color, { 0.0f, 0.0f } };
+        vertex[3] = { { left, bottom }, color, { 0.0f, 0.0f } };
+
+        vertex += 4;
+    }
+
+    auto numberOfParticles = UINT(vertex - vertices) / 4;
+    Renderer::DrawGeometry(vertices, numberOfParticles * 4, indices, numberOfParticles * 6);
+}
+
+// Emission
+
+uint Particles::Burst(const uint layerIndex, const Vector2D& center, const uint numberOfParticles, const Style& style) {
+    static constexpr f32 fullTurn = 6.2831853f;
+
+    if (layerIndex >= Particles::MaxLayers) {
+        return 0;
+    }
+
+    auto emitted = std::min(numberOfParticles, capacity - count);
+
+    for (uint emittedIndex = 0; emittedIndex < emitted; emittedIndex++) {
+        auto angle    = RandomRange(0.0f, fullTurn);
+        auto speed    = RandomRange(style.minSpeed, style.maxSpeed);
+        auto lifetime = RandomRange(style.minLifetime, style.maxLifetime);
+
+        positionsX[count]     = center.x;
+        positionsY[count]     = center.y;
+        speedsX[count]        = std::cos(angle) * speed;
+        speedsY[count]        = std::sin(angle) * speed;
+        lifetimes[count]      = lifetime;
+        lifetimeScales[count] = 1.0f / lifetime;
+        alphas[count]         = 1.0f;
+        sizes[count]          = style.size;
+        colors[count]         = style.color;
+        layers[count]         = U8(layerIndex);
+
+        count++;
+    }
+
+    layerCounts[layerIndex] += emitted;
+    return emitted;
+}
+
+uint Particles::GetCount() {
+    return count;
+}
+
+uint Particles::GetCapacity() {
+    return capacity;
+}
+
+// Utilities
+
+f32 Particles::RandomRange(const f32 minValue, const f32 maxValue) {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return minValue + ((randomState >> 8) * (1.0f / 16777216.0f)) * (maxValue - minValue);
+}
+
+void Particles::Remove(const uint particleIndex) {
+    auto lastIndex = --count;
+
+    layerCounts[layers[particleIndex]]--;
+
+    positionsX[particleIndex]     = positionsX[lastIndex];
+    positionsY[particleIndex]     = positionsY[lastIndex];
+    speedsX[particleIndex]        = speedsX[lastIndex];
+    speedsY[particleIndex]        = speedsY[lastIndex];
+    lifetimes[particleIndex]      = lifetimes[lastIndex];
+    lifetimeScales[particleIndex] = lifetimeScales[lastIndex];
+    alphas[particleIndex]         = alphas[lastIndex];
+    sizes[particleIndex]          = sizes[lastIndex];
+    colors[particleIndex]         = colors[lastIndex];
+    layers[particleIndex]         = layers[lastIndex];
+
+    // The vacated slot becomes a padding lane again, a dead particle left there would keep decaying its speed.
+    positionsX[lastIndex]     = 0.0f;
+    positionsY[lastIndex]     = 0.0f;
+    speedsX[lastIndex]        = 0.0f;
+    speedsY[lastIndex]        = 0.0f;
+    lifetimes[lastIndex]      = 0.0f;
+    lifetimeScales[lastIndex] = 0.0f;
+    alphas[lastIndex]         = 0.0f;
+}
+
+}    // namespace Biq
@@ -0,0 +1,96 @@
+/*
+ * Source/Engine/Particles.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_PARTICLES_HXX
+#define BIQ_PARTICLES_HXX
+
+#include "Engine/Types.hxx"
+#include "SDL2/SDL.h"
+
+namespace Biq {
+
+// Particles: short lived colored squares for effects (hits, explosions), drawn by the world after the objects of their
+// layer. Speeds and lifetimes use the same units as world objects (pixels per frame and frames at the target rate).
+//
+// The pool has a fixed capacity and keeps every attribute in its own array (structure of arrays), so the update runs
+// four particles at a time and emitting never allocates: when the pool is full new particles are dropped. Each layer
+// is drawn with a single geometry submission. Particles are cosmetic, they have their own random generator and are not
+// part of snapshots.
+
+class Particles {
+    public:
+        ~Particles() = default;
+
+        // Constants
+
+        static constexpr charconst Tag             = "Particles";
+        static constexpr uint      DefaultCapacity = 16384;
+        static constexpr uint      MaxLayers       = 16;
+        static constexpr uint      Alignment       = 64;
+        static constexpr f32       Drag            = 0.94f;
+
+        struct Style {
+            f32       minSpeed;
+            f32       maxSpeed;
+            f32       minLifetime;
+            f32       maxLifetime;
+            f32       size;
+            SDL_Color color;
+        };
+
+        // General
+
+        static bool Initialize(const uint capacity);
+        static void Finalize();
+        static void Clear();
+        static void Update(const float speedMultiplier);
+        static void Render(const uint layerIndex, const Vector2D& offset = { 0.0f, 0.0f });
+
+        // Emission
+
+        static uint Burst(const uint layerIndex, const Vector2D& center, const uint count, const Style& style);
+
+        static uint GetCount();
+        static uint GetCapacity();
+
+    protected:
+        Particles() = delete;
+
+    private:
+        static u8*  memory;
+        static uint capacity;
+        static uint count;
+        static uint layerCounts[MaxLayers];
+        static u32  randomState;
+
+        // Attributes (capacity entries each, padded to whole vectors)
+
+        static f32*       positionsX;
+        static f32*       positionsY;
+        static f32*       speedsX;
+        static f32*       speedsY;
+        static f32*       lifetimes;
+        static f32*       lifetimeScales;
+        static f32*       alphas;
+        static f32*       sizes;
+        static SDL_Color* colors;
+        static u8*        layers;
+
+        // Geometry (four vertices and six indices per particle, the indices never change)
+
+        static SDL_Vertex* vertices;
+        static int*        indices;
+
+        static uint countMetric;
+
+        static f32  RandomRange(const f32 minValue, const f32 maxValue);
+        static void Remove(const uint particleIndex);
+};
+
+}    // namespace Biq
+
+#endif    // BIQ_PARTICLES_HXX
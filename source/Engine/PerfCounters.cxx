@@ -0,0 +1,334 @@
+/*
+ * Source/Engine/PerfCounters.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/PerfCounters.hxx"
+
+#include "Engine/Engine.hxx"
+
+#include <cstring>
+
+#ifdef LinuxOS
+    #include <cerrno>
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace Biq {
+
+// String Table
+
+namespace Txt {
+static const charconst CountingEvents    = "Counting %d of %d hardware events per frame phase, reporting every %d frames";
+static const charconst TimingOnly        = "Hardware performance counters are not available, frame phases are only timed";
+static const charconst EventNotAvailable = "Could not open the %s counter: %s";
+static const charconst TooManyPhases     = "Could not register the phase \"%s\", there are too many phases";
+static const charconst IntervalTitle     = "Last %llu frames";
+static const charconst RunTitle          = "Whole run, %llu frames";
+static const charconst ReportHeader      = "%-12s %10s %8s %14s %14s";
+static const charconst PhaseReport       = "%-12s %10.3f %8s %14s %14s per %s";
+static const charconst NotCounted        = "-";
+static const charconst PerObject         = "object";
+static const charconst PerFrame          = "frame";
+
+static const charconst EventNames[PerfCounters::MaxEvents] = { "cycles", "instructions", "cache misses", "branch misses" };
+}    // namespace Txt
+
+// Static Members
+
+bool                        PerfCounters::isEnabled       = false;
+int                         PerfCounters::groupDescriptor = -1;
+int                         PerfCounters::eventDescriptors[PerfCounters::MaxEvents] = { -1, -1, -1, -1 };
+uint                        PerfCounters::eventSlots[PerfCounters::MaxEvents];
+uint                        PerfCounters::numberOfSlots   = 0;
+uint                        PerfCounters::reportFrames    = PerfCounters::DefaultReportFrames;
+uint                        PerfCounters::intervalFrames  = 0;
+u64                         PerfCounters::runFrames       = 0;
+PerfCounters::PhaseCounters PerfCounters::phases[PerfCounters::MaxPhases];
+uint                        PerfCounters::numberOfPhases  = 0;
+
+// Ratios
+
+static void FormatRatio(char* text, const uint size, const bool isCounted, const u64 value, const u64 divisor) {
+    if (!isCounted || (divisor == 0)) {
+        snprintf(text, size, "%s", Txt::NotCounted);
+    } else {
+        snprintf(text, size, "%.2f", F64(value) / divisor);
+    }
+}
+
+// General
+
+bool PerfCounters::Enable(const uint numberOfFrames) {
+    if (isEnabled) {
+        return groupDescriptor >= 0;
+    }
+
+    reportFrames   = std::max(numberOfFrames, 1u);
+    intervalFrames = 0;
+    runFrames      = 0;
+
+    for (uint phaseIndex = 0; phaseIndex < numberOfPhases; phaseIndex++) {
+        auto phaseName          = phases[phaseIndex].name;
+        phases[phaseIndex]      = {};
+        phases[phaseIndex].name = phaseName;
+    }
+
+    isEnabled = true;
+
+    if (!OpenCounters()) {
+        WARNING(Txt::TimingOnly);
+        return false;
+    }
+
+    INFO(Txt::CountingEvents, numberOfSlots, PerfCounters::MaxEvents, reportFrames);
+    return true;
+}
+
+void PerfCounters::Disable() {
+    if (!isEnabled) {
+        return;
+    }
+
+    FoldInterval();
+    Report(Txt::RunTitle, runFrames, true);
+    CloseCounters();
+
+    isEnabled = false;
+}
+
+bool PerfCounters::IsEnabled() {
+    return isEnabled;
+}
+
+bool PerfCounters::IsCounting(const Event event) {
+    return (event < PerfCounters::MaxEvents) && (eventDescriptors[event] >= 0);
+}
+
+// Phases
+
+uint PerfCounters::RegisterPhase(const charconst phaseName) {
+    for (uint phaseIndex = 0; phaseIndex < numberOfPhases; phaseIndex++) {
+        if (strcmp(phases[phaseIndex].name, phaseName) == 0) {
+            return phaseIndex;
+        }
+    }
+
+    if (numberOfPhases >= PerfCounters::MaxPhases) {
+        WARNING(Txt::TooManyPhases, phaseName);
+        return PerfCounters::InvalidPhase;
+    }
+
+    phases[numberOfPhases]      = {};
+    phases[numberOfPhases].name = phaseName;
+
+    return numberOfPhases++;
+}
+
+// A phase entered again before it ended (recursion) is counted once, from the outermost entry.
+void PerfCounters::BeginPhase(const uint phaseId) {
+    if (!isEnabled || (phaseId >= numberOfPhases)) {
+        return;
+    }
+
+    auto& phase = phases[phaseId];
+
+    if (phase.depth++ == 0) {
+        Read(phase.start);
+    }
+}
+
+void PerfCounters::EndPhase(const uint phaseId) {
+    if (!isEnabled || (phaseId >= numberOfPhases) || (phases[phaseId].depth == 0)) {
+        return;
+    }
+
+    auto& phase = phases[phaseId];
+
+    if (--phase.depth > 0) {
+        return;
+    }
+
+    Sample endSample;
+    Read(endSample);
+
+    // Scaled counts of a multiplexed group may step back a little between two reads.
+    for (uint eventIndex = 0; eventIndex < PerfCounters::MaxEvents; eventIndex++) {
+        if (endSample.events[eventIndex] > phase.start.events[eventIndex]) {
+            phase.interval.events[eventIndex] += endSample.events[eventIndex] - phase.start.events[eventIndex];
+        }
+    }
+
+    phase.interval.time += endSample.time - phase.start.time;
+}
+
+void PerfCounters::AddObjects(const uint phaseId, const uint numberOfObjects) {
+    if (isEnabled && (phaseId < numberOfPhases)) {
+        phases[phaseId].interval.objects += numberOfObjects;
+    }
+}
+
+void PerfCounters::EndFrame() {
+    if (!isEnabled) {
+        return;
+    }
+
+    runFrames++;
+
+    if (++intervalFrames < reportFrames) {
+        return;
+    }
+
+    Report(Txt::IntervalTitle, intervalFrames, false);
+    FoldInterval();
+}
+
+// Counters
+
+// Every event is opened in one group led by the first one that opens, so the kernel schedules them together and a
+// single read returns all of them. Events the processor (or the hypervisor) does not have are left out.
+bool PerfCounters::OpenCounters() {
+#ifdef LinuxOS
+    static const u64 EventConfigs[PerfCounters::MaxEvents] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+    numberOfSlots = 0;
+
+    for (uint eventIndex = 0; eventIndex < PerfCounters::MaxEvents; eventIndex++) {
+        perf_event_attr attributes = {};
+
+        attributes.size           = sizeof(attributes);
+        attributes.type           = PERF_TYPE_HARDWARE;
+        attributes.config         = EventConfigs[eventIndex];
+        attributes.disabled       = groupDescriptor < 0 ? 1 : 0;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv     = 1;
+        attributes.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // This thread only, on whatever processor it runs.
+        auto descriptor = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, groupDescriptor, 0));
+
+        if (descriptor < 0) {
+            DEBUG(Txt::EventNotAvailable, Txt::EventNames[eventIndex], strerror(errno));
+            continue;
+        }
+
+        if (groupDescriptor < 0) {
+            groupDescriptor = descriptor;
+        }
+
+        eventDescriptors[eventIndex] = descriptor;
+        eventSlots[eventIndex]       = numberOfSlots++;
+    }
+
+    if (groupDescriptor < 0) {
+        return false;
+    }
+
+    ioctl(groupDescriptor, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(groupDescriptor, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void PerfCounters::CloseCounters() {
+#ifdef LinuxOS
+    // Members first, the group goes away with its leader.
+    for (uint eventIndex = 0; eventIndex < PerfCounters::MaxEvents; eventIndex++) {
+        if ((eventDescriptors[eventIndex] >= 0) && (eventDescriptors[eventIndex] != groupDescriptor)) {
+            close(eventDescriptors[eventIndex]);
+        }
+    }
+
+    if (groupDescriptor >= 0) {
+        close(groupDescriptor);
+    }
+#endif
+
+    for (auto& descriptor : eventDescriptors) {
+        descriptor = -1;
+    }
+
+    groupDescriptor = -1;
+    numberOfSlots   = 0;
+}
+
+void PerfCounters::Read(Sample& sample) {
+    memset(sample.events, 0, sizeof(sample.events));
+
+#ifdef LinuxOS
+    if (groupDescriptor >= 0) {
+        // Group layout: number of events, time enabled, time running, then one value per event.
+        u64  values[3 + PerfCounters::MaxEvents];
+        auto readBytes = read(groupDescriptor, values, sizeof(values));
+
+        if ((readBytes >= static_cast<ssize_t>((3 + numberOfSlots) * sizeof(u64))) && (values[2] > 0)) {
+            // When the processor has fewer counters than events, the kernel takes turns and the counts are estimated
+            // from the time each one actually ran.
+            auto scale = F64(values[1]) / values[2];
+
+            for (uint eventIndex = 0; eventIndex < PerfCounters::MaxEvents; eventIndex++) {
+                if (eventDescriptors[eventIndex] >= 0) {
+                    sample.events[eventIndex] = U64(values[3 + eventSlots[eventIndex]] * scale);
+                }
+            }
+        }
+    }
+#endif
+
+    sample.time = Engine::GetPreciseTicks();
+}
+
+void PerfCounters::FoldInterval() {
+    for (uint phaseIndex = 0; phaseIndex < numberOfPhases; phaseIndex++) {
+        auto& phase = phases[phaseIndex];
+
+        for (uint eventIndex = 0; eventIndex < PerfCounters::MaxEvents; eventIndex++) {
+            phase.run.events[eventIndex] += phase.interval.events[eventIndex];
+        }
+
+        phase.run.time    += phase.interval.time;
+        phase.run.objects += phase.interval.objects;
+        phase.interval     = {};
+    }
+
+    intervalFrames = 0;
+}
+
+// Misses are reported per object the phase went through, or per frame for phases that do not count any.
+void PerfCounters::Report(const charconst title, const u64 numberOfFrames, const bool isRun) {
+    if (numberOfFrames == 0) {
+        return;
+    }
+
+    INFO(title, numberOfFrames);
+    INFO(Txt::ReportHeader, "phase", "ms/frame", "IPC", "cache misses", "branch misses");
+
+    for (uint phaseIndex = 0; phaseIndex < numberOfPhases; phaseIndex++) {
+        auto& phase  = phases[phaseIndex];
+        auto& totals = isRun ? phase.run : phase.interval;
+
+        if (totals.time <= 0.0) {
+            continue;
+        }
+
+        auto divisor = totals.objects > 0 ? totals.objects : numberOfFrames;
+        char instructionsPerCycle[16];
+        char cacheMisses[16];
+        char branchMisses[16];
+
+        FormatRatio(instructionsPerCycle, sizeof(instructionsPerCycle), IsCounting(PerfCounters::Instructions) && IsCounting(PerfCounters::Cycles), totals.events[PerfCounters::Instructions], totals.events[PerfCounters::Cycles]);
+        FormatRatio(cacheMisses, sizeof(cacheMisses), IsCounting(PerfCounters::CacheMisses), totals.events[PerfCounters::CacheMisses], divisor);
+        FormatRatio(branchMisses, sizeof(branchMisses), IsCounting(PerfCounters::BranchMisses), totals.events[PerfCounters::BranchMisses], divisor);
+
+        INFO(Txt::PhaseReport, phase.name, totals.time / numberOfFrames, instructionsPerCycle, cacheMisses, branchMisses, totals.objects > 0 ? Txt::PerObject : Txt::PerFrame);
+    }
+}
+
+}    // namespace Biq
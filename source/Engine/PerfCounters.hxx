@@ -0,0 +1,119 @@
+/*
+ * Source/Engine/PerfCounters.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_PERF_COUNTERS_HXX
+#define BIQ_PERF_COUNTERS_HXX
+
+#include "Engine/Types.hxx"
+
+namespace Biq {
+
+// Performance counters: the processor's own counters (cycles, instructions, cache misses and branch misses) are read
+// around each phase of a frame, so a slow phase shows whether it is waiting on memory, mispredicting or simply doing
+// more work. The engine times Step, Input, Render and Present, states add their own phases (which are counted in the
+// engine phase they run in as well). Every n frames the totals are logged per phase, per frame and per object handled,
+// and once more for the whole run when the counters are disabled.
+//
+// Counters are read through perf_event_open on Linux and only count the main thread. When the kernel refuses them
+// (perf_event_paranoid, containers, virtual machines without a PMU) or on other platforms, the phases are only timed.
+
+class PerfCounters {
+    public:
+        ~PerfCounters() = default;
+
+        // Constants
+
+        static constexpr charconst Tag                 = "PerfCounters";
+        static constexpr uint      MaxPhases           = 16;
+        static constexpr uint      DefaultReportFrames = 300;
+        static constexpr uint      InvalidPhase        = UINT(-1);
+
+        enum Event {
+            Cycles = 0,
+            Instructions,
+            CacheMisses,
+            BranchMisses,
+            MaxEvents
+        };
+
+        // Phases
+
+        class Phase {
+            public:
+                explicit Phase(const uint phaseId) :
+                    phaseId(phaseId) {
+                    PerfCounters::BeginPhase(phaseId);
+                }
+
+                ~Phase() {
+                    PerfCounters::EndPhase(phaseId);
+                }
+
+            private:
+                uint phaseId;
+        };
+
+        // General
+
+        // Must be called from the main thread. Returns false when only the timing is available.
+        static bool Enable(const uint reportFrames = DefaultReportFrames);
+        static void Disable();
+        static bool IsEnabled();
+        static bool IsCounting(const Event event);
+
+        // Registering a name twice returns the same phase, states register theirs every time they are activated.
+        static uint RegisterPhase(const charconst phaseName);
+        static void BeginPhase(const uint phaseId);
+        static void EndPhase(const uint phaseId);
+        static void AddObjects(const uint phaseId, const uint numberOfObjects);
+
+        static void EndFrame();
+
+    protected:
+        PerfCounters() = delete;
+
+    private:
+        struct Sample {
+            u64 events[MaxEvents];
+            f64 time;
+        };
+
+        struct Totals {
+            u64 events[MaxEvents];
+            f64 time;
+            u64 objects;
+        };
+
+        struct PhaseCounters {
+            charconst name;
+            Sample    start;
+            uint      depth;
+            Totals    interval;
+            Totals    run;
+        };
+
+        static bool          isEnabled;
+        static int           groupDescriptor;
+        static int           eventDescriptors[MaxEvents];
+        static uint          eventSlots[MaxEvents];
+        static uint          numberOfSlots;
+        static uint          reportFrames;
+        static uint          intervalFrames;
+        static u64           runFrames;
+        static PhaseCounters phases[MaxPhases];
+        static uint          numberOfPhases;
+
+        static bool OpenCounters();
+        static void CloseCounters();
+        static void Read(Sample& sample);
+        static void FoldInterval();
+        static void Report(const charconst title, const u64 numberOfFrames, const bool isRun);
+};
+
+}    // namespace Biq
+
+#endif    // BIQ_PERF_COUNTERS_HXX
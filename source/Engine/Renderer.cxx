@@ -7,7 +7,13 @@
 
 #include "Engine/Renderer.hxx"
 
+#include "Engine/Capture.hxx"
+#include "Engine/DrawRecorder.hxx"
 #include "Engine/Engine.hxx"
+#include "Engine/Overdraw.hxx"
+#include "Engine/Startup.hxx"
+#include "Engine/Telemetry.hxx"
+#include "Engine/World.hxx"
 
 namespace Biq {
 
@@ -23,9 +29,11 @@ static const charconst CouldNotLoadDefaultFont       = "Could not load the defau
 static const charconst CouldNotLoadImage             = "Could not load the image from \"%s\": %s";
 static const charconst CouldNotCreateImageTexture    = "Could not create the image texture: %s";
 static const charconst CouldNotCreateTextTexture     = "Could not create the text texture: %s";
+static const charconst CouldNotReadPixels            = "Could not read the frame pixels back: %s";
 
 static const charconst CreatingRendererWindow  = "Creating renderer window";
 static const charconst CreatingRendererContext = "Creating renderer context";
+static const charconst UsingSoftwareRenderer   = "Using the software renderer";
 static const charconst InitializingSDLImage    = "Initializing SDL_image";
 static const charconst InitializingSDLTTF      = "Initializing SDL_ttf";
 static const charconst LoadingDefaultFont      = "Loading default font from \"%s\"";
@@ -34,7 +42,24 @@ static const charconst UnloadingDefaultFont      = "Unloading default font";
 static const charconst DestroyingRendererContext = "Destroying renderer context";
 static const charconst DestroyingRendererWindow  = "Destroying renderer window";
 
-static const charconst ImageLoaded = "Image loaded from \"%s\"";
+static const charconst ImageLoaded      = "Image loaded from \"%s\"";
+static const charconst ImageLevels      = "Images get up to %d downscaled levels (bias %.2f)";
+static const charconst ImagesRecolored  = "Image \"%s\" recolored into %d variants";
+static const charconst MaskSizeMismatch = "The mask \"%s\" is not the size of its base";
+static const charconst InvalidRecipe    = "\"%s\" is not a valid recolored image";
+static const charconst ImageRegions     = "Images are trimmed and split from %dx%d pixels";
+static const charconst NoImageRegions   = "Images are drawn whole";
+static const charconst ImageFill        = "Image \"%s\" blends %.1f%% of its area and draws %.1f%% opaque in %d draws";
+
+static const charconst RenderTargetsNotSupported   = "Render targets are not supported, dynamic resolution is disabled";
+static const charconst NoRetainedFrame             = "Render targets are not supported, damaged frames are drawn in full";
+static const charconst RetainedFrameEnabled        = "Frames are kept in a render target, only their damaged rects are drawn again";
+static const charconst CouldNotCreateRenderTarget  = "Could not create the render target: %s";
+static const charconst ResolutionScalingEnabled    = "Dynamic resolution enabled: %.0f%% to %.0f%% for a %.2f ms frame budget";
+static const charconst ResolutionScaleChanged      = "Resolution scale changed to %.0f%% (average frame time %.2f ms)";
+static const charconst TimeAtResolutionScale       = "%.0f%% scale: %.1f s (%.1f%%)";
+
+static const charconst UnknownBackend = "unknown";
 }    // namespace Txt
 
 // Static Members
@@ -45,23 +70,75 @@ SDL_Window*   Renderer::sdlWindow   = NULL;
 SDL_Renderer* Renderer::sdlRenderer = NULL;
 TTF_Font*     Renderer::textFont    = NULL;
 
+std::thread::id     Renderer::renderThreadId;
+std::mutex          Renderer::pendingImagesMutex;
+std::vector<Image*> Renderer::pendingImages;
+
+std::thread       Renderer::librariesWorker;
+std::mutex        Renderer::librariesMutex;
+std::atomic<bool> Renderer::areLibrariesReady(false);
+
+SDL_Texture* Renderer::renderTarget           = NULL;
+f32          Renderer::resolutionScale        = 1.0f;
+f32          Renderer::minimumResolutionScale = 1.0f;
+f32          Renderer::maximumResolutionScale = 1.0f;
+f32          Renderer::frameTimeBudget        = 0.0f;
+f64          Renderer::averageFrameTime       = 0.0;
+f64          Renderer::lastUpdateTime         = 0.0;
+uint         Renderer::framesSinceScaleChange = 0;
+f64          Renderer::timeAtScale[Renderer::ScaleLevels + 1];
+uint         Renderer::resolutionScaleMetric  = Telemetry::InvalidMetric;
+
+uint Renderer::imageLevels         = Renderer::DefaultImageLevels;
+f32  Renderer::imageLevelBias      = 0.0f;
+u64  Renderer::textureMemory       = 0;
+uint Renderer::textureMemoryMetric = Telemetry::InvalidMetric;
+bool Renderer::areImageRegionsEnabled = true;
+int  Renderer::minimumSplitSize       = Renderer::DefaultMinimumSplitSize;
+
+uint Renderer::drawCalls           = 0;
+uint Renderer::drawCallsMetric     = Telemetry::InvalidMetric;
+u64  Renderer::blendedPixels       = 0;
+uint Renderer::blendedPixelsMetric = Telemetry::InvalidMetric;
+uint Renderer::pendingImagesMetric = Telemetry::InvalidMetric;
+uint Renderer::skippedFramesMetric = Telemetry::InvalidMetric;
+uint Renderer::partialFramesMetric = Telemetry::InvalidMetric;
+
+std::atomic<u32> Renderer::imageSerials(0);
+
 // General
 
+void Renderer::InitializeLibraries() {
+    renderThreadId    = std::this_thread::get_id();
+    areLibrariesReady = false;
+    librariesWorker   = std::thread(LoadLibraries);
+}
+
 bool Renderer::Initialize(const GameInformation& gameInformation) {
     DEBUG(Txt::Initializing);
 
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
-        ERROR(Txt::CouldNotInitializeRenderer, SDL_GetError());
-        return false;
+    {
+        Startup::Phase startupPhase("Video");
+
+        if (SDL_InitSubSystem(SDL_INIT_VIDEO) != 0) {
+            ERROR(Txt::CouldNotInitializeRenderer, SDL_GetError());
+            return false;
+        }
     }
 
-    DEBUG(Txt::CreatingRendererWindow);
+    {
+        Startup::Phase startupPhase("Window");
 
-    sdlWindow = SDL_CreateWindow(gameInformation.name, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, gameInformation.targetWidth, gameInformation.targetHeight, SDL_WINDOW_SHOWN | SDL_WINDOW_UTILITY);
+        DEBUG(Txt::CreatingRendererWindow);
 
-    if (sdlWindow == NULL) {
-        ERROR(Txt::CouldNotCreateRendererWindow, SDL_GetError());
-        return false;
+        auto windowFlags = gameInformation.isHeadless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN | SDL_WINDOW_UTILITY;
+
+        sdlWindow = SDL_CreateWindow(gameInformation.name, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, gameInformation.targetWidth, gameInformation.targetHeight, windowFlags);
+
+        if (sdlWindow == NULL) {
+            ERROR(Txt::CouldNotCreateRendererWindow, SDL_GetError());
+            return false;
+        }
     }
 
     windowRect.x = 0;
@@ -69,42 +146,46 @@ bool Renderer::Initialize(const GameInformation& gameInformation) {
     windowRect.w = gameInformation.targetWidth;
     windowRect.h = gameInformation.targetHeight;
 
-    DEBUG(Txt::CreatingRendererContext);
-
-    sdlRenderer = SDL_CreateRenderer(sdlWindow, -1, SDL_RENDERER_ACCELERATED);
+    {
+        Startup::Phase startupPhase("Renderer context");
 
-    if (sdlRenderer == NULL) {
-        ERROR(Txt::CouldNotCreateRendererContext, SDL_GetError());
-        return false;
-    }
+        DEBUG(Txt::CreatingRendererContext);
 
-    SDL_SetRenderDrawColor(sdlRenderer, 127, 127, 127, 255);
-    SDL_RenderClear(sdlRenderer);
+        if (!gameInformation.isHeadless) {
+            sdlRenderer = SDL_CreateRenderer(sdlWindow, -1, SDL_RENDERER_ACCELERATED);
+        }
 
-    DEBUG(Txt::InitializingSDLImage);
+        if (sdlRenderer == NULL) {
+            DEBUG(Txt::UsingSoftwareRenderer);
+            sdlRenderer = SDL_CreateRenderer(sdlWindow, -1, SDL_RENDERER_SOFTWARE);
+        }
 
-    auto imageTypes = IMG_INIT_PNG | IMG_INIT_JPG;
+        if (sdlRenderer == NULL) {
+            ERROR(Txt::CouldNotCreateRendererContext, SDL_GetError());
+            return false;
+        }
 
-    if (!(IMG_Init(imageTypes) & imageTypes)) {
-        ERROR(Txt::CouldNotInitializeSDLImage, IMG_GetError());
-        return false;
+        SDL_SetRenderDrawColor(sdlRenderer, 127, 127, 127, 255);
+        SDL_RenderClear(sdlRenderer);
     }
 
-    DEBUG(Txt::InitializingSDLTTF);
+    {
+        Startup::Phase startupPhase("Waiting for the libraries");
 
-    if (TTF_Init() != 0) {
-        ERROR(Txt::CouldNotInitializeSDLTTF, TTF_GetError());
-        return false;
+        if (!WaitForLibraries()) {
+            return false;
+        }
     }
 
-    DEBUG(Txt::LoadingDefaultFont, Renderer::DefaultFontPath);
+    drawCallsMetric       = Telemetry::RegisterGauge("Renderer.DrawCalls");
+    blendedPixelsMetric   = Telemetry::RegisterGauge("Renderer.BlendedPixels");
+    pendingImagesMetric   = Telemetry::RegisterGauge("Renderer.PendingImages");
+    resolutionScaleMetric = Telemetry::RegisterGauge("Renderer.ResolutionScale");
+    textureMemoryMetric   = Telemetry::RegisterGauge("Renderer.TextureMemoryKB");
+    skippedFramesMetric   = Telemetry::RegisterCounter("Renderer.SkippedFrames");
+    partialFramesMetric   = Telemetry::RegisterCounter("Renderer.PartialFrames");
 
-    textFont = TTF_OpenFont(Renderer::DefaultFontPath, Renderer::TextSize);
-
-    if (textFont == NULL) {
-        ERROR(Txt::CouldNotLoadDefaultFont, TTF_GetError());
-        return false;
-    }
+    Telemetry::Set(resolutionScaleMetric, 100);
 
     DEBUG(Txt::Initialized);
     return true;
@@ -113,9 +194,28 @@ bool Renderer::Initialize(const GameInformation& gameInformation) {
 void Renderer::Finalize() {
     DEBUG(Txt::Finalizing);
 
+    WaitForLibraries();
+
+    pendingImagesMutex.lock();
+
+    for (auto image : pendingImages) {
+        SDL_FreeSurface((SDL_Surface*) image->surface);
+        image->surface = NULL;
+    }
+
+    pendingImages.clear();
+    pendingImagesMutex.unlock();
+
+    if (renderTarget != NULL) {
+        ReportResolutionScale();
+        SDL_DestroyTexture(renderTarget);
+        renderTarget = NULL;
+    }
+
     if (textFont != NULL) {
         DEBUG(Txt::UnloadingDefaultFont);
         TTF_CloseFont(textFont);
+        textFont = NULL;
     }
 
     if (sdlRenderer != NULL) {
@@ -138,20 +238,341 @@ void Renderer::Finalize() {
 }
 
 void Renderer::Update() {
-    SDL_RenderPresent(sdlRenderer);
+    if (DrawRecorder::IsRecording()) {
+        DrawRecorder::EndFrame();
+    }
+
+    if (Overdraw::IsEnabled()) {
+        Overdraw::EndFrame();
+    }
+
+    if (renderTarget == NULL) {
+        CaptureFrame();
+        SDL_RenderPresent(sdlRenderer);
+    } else {
+        // Only the top left part of the target is used at lower scales, upscale it to the whole window.
+        SDL_Rect sourceRect = { 0, 0, I32(windowRect.w * resolutionScale), I32(windowRect.h * resolutionScale) };
+
+        SDL_SetRenderTarget(sdlRenderer, NULL);
+        SDL_RenderCopy(sdlRenderer, renderTarget, &sourceRect, &windowRect);
+        CaptureFrame();
+        SDL_RenderPresent(sdlRenderer);
+
+        UpdateResolutionScale();
+
+        SDL_SetRenderTarget(sdlRenderer, renderTarget);
+        SDL_RenderSetScale(sdlRenderer, resolutionScale, resolutionScale);
+    }
+
+    UploadPendingImages(Renderer::UploadsPerFrame);
+
+    Telemetry::Set(drawCallsMetric, drawCalls);
+    Telemetry::Set(blendedPixelsMetric, blendedPixels);
+    drawCalls     = 0;
+    blendedPixels = 0;
+}
+
+// Nothing was drawn, the last presented frame stays on screen. Idle time is not frame time, the dynamic resolution
+// does not count it.
+void Renderer::SkipFrame() {
+    UploadPendingImages(Renderer::UploadsPerFrame);
+
+    lastUpdateTime = Engine::GetPreciseTicks();
+
+    Telemetry::Add(skippedFramesMetric);
+    Telemetry::Set(drawCallsMetric, 0);
+    Telemetry::Set(blendedPixelsMetric, 0);
+    drawCalls     = 0;
+    blendedPixels = 0;
+}
+
+const SDL_Rect& Renderer::GetFrameRect() {
+    return windowRect;
+}
+
+charconst Renderer::GetBackendName() {
+    SDL_RendererInfo rendererInfo;
+
+    if ((sdlRenderer == NULL) || (SDL_GetRendererInfo(sdlRenderer, &rendererInfo) != 0)) {
+        return Txt::UnknownBackend;
+    }
+
+    return rendererInfo.name;
+}
+
+// Libraries
+
+// SDL_image and SDL_ttf do not depend on the video subsystem, they are brought up while the window is created.
+void Renderer::LoadLibraries() {
+    {
+        Startup::Phase startupPhase("Image codecs");
+
+        DEBUG(Txt::InitializingSDLImage);
+
+        auto imageTypes = IMG_INIT_PNG | IMG_INIT_JPG;
+
+        if (!(IMG_Init(imageTypes) & imageTypes)) {
+            ERROR(Txt::CouldNotInitializeSDLImage, IMG_GetError());
+            return;
+        }
+    }
+
+    Startup::Phase startupPhase("Font");
+
+    DEBUG(Txt::InitializingSDLTTF);
+
+    if (TTF_Init() != 0) {
+        ERROR(Txt::CouldNotInitializeSDLTTF, TTF_GetError());
+        return;
+    }
+
+    DEBUG(Txt::LoadingDefaultFont, Renderer::DefaultFontPath);
+
+    textFont = TTF_OpenFont(Renderer::DefaultFontPath, Renderer::TextSize);
+
+    if (textFont == NULL) {
+        ERROR(Txt::CouldNotLoadDefaultFont, TTF_GetError());
+        return;
+    }
+
+    areLibrariesReady = true;
+}
+
+bool Renderer::WaitForLibraries() {
+    librariesMutex.lock();
+
+    if (librariesWorker.joinable()) {
+        librariesWorker.join();
+    }
+
+    librariesMutex.unlock();
+    return areLibrariesReady;
+}
+
+// Capture
+
+void Renderer::CaptureFrame() {
+    if (!Capture::IsFrameDue()) {
+        return;
+    }
+
+    auto frame = Capture::AcquireFrame();
+
+    if (frame == NULL) {
+        return;
+    }
+
+    // The pool buffers keep their size, so this only allocates the first time each one is used.
+    frame->width  = windowRect.w;
+    frame->height = windowRect.h;
+    frame->pixels.resize(windowRect.w * windowRect.h * 4);
+
+    if (SDL_RenderReadPixels(sdlRenderer, NULL, SDL_PIXELFORMAT_RGBA32, frame->pixels.data(), windowRect.w * 4) != 0) {
+        WARNING(Txt::CouldNotReadPixels, SDL_GetError());
+        Capture::ReleaseFrame(frame);
+        return;
+    }
+
+    Capture::SubmitFrame(frame);
 }
 
+// Resolution Scaling
+
+bool Renderer::SetResolutionScaling(const f32 minimumScale, const f32 maximumScale, const f32 frameBudget) {
+    if (!SDL_RenderTargetSupported(sdlRenderer)) {
+        WARNING(Txt::RenderTargetsNotSupported);
+        return false;
+    }
+
+    if (!CreateRenderTarget()) {
+        return false;
+    }
+
+    minimumResolutionScale = std::min(std::max(minimumScale, F32(Renderer::ScaleStep)), 1.0f);
+    maximumResolutionScale = std::min(std::max(maximumScale, minimumResolutionScale), 1.0f);
+    resolutionScale        = maximumResolutionScale;
+    frameTimeBudget        = frameBudget;
+    averageFrameTime       = frameBudget;
+    lastUpdateTime         = Engine::GetPreciseTicks();
+    framesSinceScaleChange = 0;
+
+    for (auto& scaleTime : timeAtScale) {
+        scaleTime = 0.0;
+    }
+
+    SDL_RenderSetScale(sdlRenderer, resolutionScale, resolutionScale);
+    Telemetry::Set(resolutionScaleMetric, I64(resolutionScale * 100.0f + 0.5f));
+    World::Invalidate();
+
+    INFO(Txt::ResolutionScalingEnabled, minimumResolutionScale * 100.0f, maximumResolutionScale * 100.0f, frameTimeBudget);
+    return true;
+}
+
+f32 Renderer::GetResolutionScale() {
+    return resolutionScale;
+}
+
+bool Renderer::CreateRenderTarget() {
+    if (renderTarget != NULL) {
+        return true;
+    }
+
+    renderTarget = SDL_CreateTexture(sdlRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, windowRect.w, windowRect.h);
+
+    if (renderTarget == NULL) {
+        WARNING(Txt::CouldNotCreateRenderTarget, SDL_GetError());
+        return false;
+    }
+
+    SDL_SetTextureScaleMode(renderTarget, SDL_ScaleModeLinear);
+    SDL_SetRenderTarget(sdlRenderer, renderTarget);
+
+    // The target starts out undefined.
+    World::Invalidate();
+    return true;
+}
+
+void Renderer::UpdateResolutionScale() {
+    // Retained frames without dynamic resolution stay at full scale.
+    if (frameTimeBudget <= 0.0f) {
+        return;
+    }
+
+    auto currentTime = Engine::GetPreciseTicks();
+    auto frameTime   = currentTime - lastUpdateTime;
+
+    lastUpdateTime   = currentTime;
+    averageFrameTime = (averageFrameTime * (1.0f - Renderer::FrameTimeSmoothing)) + (frameTime * Renderer::FrameTimeSmoothing);
+    timeAtScale[UINT(resolutionScale / Renderer::ScaleStep + 0.5f)] += frameTime / 1000.0;
+
+    if (++framesSinceScaleChange < Renderer::ScaleAdjustFrames) {
+        return;
+    }
+
+    auto newScale = resolutionScale;
+
+    if (averageFrameTime > frameTimeBudget) {
+        newScale = std::max(resolutionScale - Renderer::ScaleStep, minimumResolutionScale);
+    } else if (averageFrameTime < frameTimeBudget * Renderer::ScaleUpHeadroom) {
+        newScale = std::min(resolutionScale + Renderer::ScaleStep, maximumResolutionScale);
+    }
+
+    // Steps accumulate rounding errors, snap to the closest level.
+    newScale = UINT(newScale / Renderer::ScaleStep + 0.5f) * Renderer::ScaleStep;
+
+    if (newScale == resolutionScale) {
+        return;
+    }
+
+    resolutionScale        = newScale;
+    framesSinceScaleChange = 0;
+
+    // The target still holds the frame at the previous scale.
+    World::Invalidate();
+
+    Telemetry::Set(resolutionScaleMetric, I64(resolutionScale * 100.0f + 0.5f));
+    DEBUG(Txt::ResolutionScaleChanged, resolutionScale * 100.0f, averageFrameTime);
+}
+
+void Renderer::ReportResolutionScale() {
+    f64 totalTime = 0.0;
+
+    for (auto scaleTime : timeAtScale) {
+        totalTime += scaleTime;
+    }
+
+    if (totalTime <= 0.0) {
+        return;
+    }
+
+    for (uint scaleLevel = 0; scaleLevel <= Renderer::ScaleLevels; scaleLevel++) {
+        if (timeAtScale[scaleLevel] > 0.0) {
+            INFO(Txt::TimeAtResolutionScale, scaleLevel * Renderer::ScaleStep * 100.0f, timeAtScale[scaleLevel], (timeAtScale[scaleLevel] * 100.0) / totalTime);
+        }
+    }
+}
+
+// Partial Frames
+
+bool Renderer::SetRetainedFrame(const bool retained) {
+    if (!retained) {
+        // Dynamic resolution needs the target.
+        if ((renderTarget != NULL) && (frameTimeBudget <= 0.0f)) {
+            SDL_SetRenderTarget(sdlRenderer, NULL);
+            SDL_DestroyTexture(renderTarget);
+            renderTarget = NULL;
+            World::Invalidate();
+        }
+
+        return true;
+    }
+
+    if (!SDL_RenderTargetSupported(sdlRenderer)) {
+        WARNING(Txt::NoRetainedFrame);
+        return false;
+    }
+
+    if (!CreateRenderTarget()) {
+        return false;
+    }
+
+    DEBUG(Txt::RetainedFrameEnabled);
+    return true;
+}
+
+bool Renderer::HasRetainedFrame() {
+    return renderTarget != NULL;
+}
+
+void Renderer::BeginPartialFrame(const SDL_Rect& damageRect) {
+    // SDL_RenderClear ignores the clip rect, the damage is cleared with the same color.
+    SDL_RenderSetClipRect(sdlRenderer, &damageRect);
+    SDL_SetRenderDrawBlendMode(sdlRenderer, SDL_BLENDMODE_NONE);
+    SDL_RenderFillRect(sdlRenderer, &damageRect);
+
+    if (Overdraw::IsEnabled()) {
+        Overdraw::SetClip(&damageRect);
+        Overdraw::AddRect(damageRect, false);
+    }
+
+    Telemetry::Add(partialFramesMetric);
+}
+
+void Renderer::EndPartialFrame() {
+    SDL_RenderSetClipRect(sdlRenderer, NULL);
+
+    if (Overdraw::IsEnabled()) {
+        Overdraw::SetClip(NULL);
+    }
+}
+
+bool Renderer::ReadPixels(std::vector<u8>& pixels) {
+    pixels.resize(windowRect.w * windowRect.h * 4);
+
+    if (SDL_RenderReadPixels(sdlRenderer, NULL, SDL_PIXELFORMAT_RGBA32, pixels.data(), windowRect.w * 4) != 0) {
+        WARNING(Txt::CouldNotReadPixels, SDL_GetError());
+        return false;
+    }
+
+    return true;
+}
+
+// Drawing
+
 void Renderer::Splash(const Image* image) {
-    if (image == NULL) {
+    if ((image == NULL) || (image->data == NULL)) {
         return;
     }
 
-    auto imageTexture = (SDL_Texture*) image->data;
-    SDL_RenderCopy(sdlRenderer, imageTexture, NULL, &windowRect);
+    if (DrawRecorder::IsRecording()) {
+        DrawRecorder::RecordSplash(image);
+    }
+
+    DrawImage(image, 0, windowRect);
 }
 
-void Renderer::Draw(const Image* image, const Vector2D& position, const Vector2D& size) {
-    if (image == NULL) {
+void Renderer::Draw(const Image* image, const Vector2D& position, const Vector2D& size, const u32 tint) {
+    if ((image == NULL) || (image->data == NULL)) {
         return;
     }
 
@@ -162,11 +583,153 @@ void Renderer::Draw(const Image* image, const Vector2D& position, const Vector2D
     destinationRect.w = size.x;
     destinationRect.h = size.y;
 
-    auto imageTexture = (SDL_Texture*) image->data;
-    SDL_RenderCopy(sdlRenderer, imageTexture, NULL, &destinationRect);
+    if (DrawRecorder::IsRecording()) {
+        DrawRecorder::RecordDraw(image, destinationRect, tint);
+    }
+
+    auto imageLevel = SelectImageLevel(image, size.x);
+
+    // The modulation is texture state, variants drawn one after the other only change it when their tints differ.
+    if (image->tints[imageLevel] != tint) {
+        auto imageTexture = (SDL_Texture*) (imageLevel == 0 ? image->data : image->levels[imageLevel - 1]);
+
+        SDL_SetTextureColorMod(imageTexture, U8(tint >> 16), U8(tint >> 8), U8(tint));
+        image->tints[imageLevel] = tint;
+    }
+
+    DrawImage(image, imageLevel, destinationRect);
+}
+
+// Untextured triangles, blended with their vertex colors.
+void Renderer::DrawGeometry(const SDL_Vertex* vertices, const uint numberOfVertices, const int* indices, const uint numberOfIndices) {
+    if (numberOfIndices == 0) {
+        return;
+    }
+
+    if (DrawRecorder::IsRecording()) {
+        DrawRecorder::RecordGeometry(vertices, numberOfVertices, indices, numberOfIndices);
+    }
+
+    SDL_SetRenderDrawBlendMode(sdlRenderer, SDL_BLENDMODE_BLEND);
+    SDL_RenderGeometry(sdlRenderer, NULL, vertices, numberOfVertices, indices, numberOfIndices);
+    drawCalls++;
+
+    if (Overdraw::IsEnabled()) {
+        Overdraw::AddTriangles(vertices, numberOfVertices, indices, numberOfIndices);
+    }
+}
+
+// At full size the regions of a split image are drawn one by one, opaque ones without blending. Otherwise the bounds
+// are drawn in one piece, widened to whole texels of the level.
+void Renderer::DrawImage(const Image* image, const uint imageLevel, const SDL_Rect& destinationRect) {
+    auto imageTexture = (SDL_Texture*) (imageLevel == 0 ? image->data : image->levels[imageLevel - 1]);
+
+    if ((imageLevel == 0) && (image->numberOfRegions > 0)) {
+        if (image->numberOfOpaqueRegions > 0) {
+            SDL_SetTextureBlendMode(imageTexture, SDL_BLENDMODE_NONE);
+
+            for (uint regionIndex = 0; regionIndex < image->numberOfOpaqueRegions; regionIndex++) {
+                DrawImagePart(imageTexture, image->regions[regionIndex], image->width, image->height, destinationRect, false);
+            }
+
+            SDL_SetTextureBlendMode(imageTexture, SDL_BLENDMODE_BLEND);
+        }
+
+        for (uint regionIndex = image->numberOfOpaqueRegions; regionIndex < image->numberOfRegions; regionIndex++) {
+            DrawImagePart(imageTexture, image->regions[regionIndex], image->width, image->height, destinationRect, true);
+        }
+
+        return;
+    }
+
+    auto          levelWidth  = image->width >> imageLevel;
+    auto          levelHeight = image->height >> imageLevel;
+    auto&         bounds      = image->bounds;
+    Image::Region levelBounds;
+
+    levelBounds.x      = (bounds.x * levelWidth) / image->width;
+    levelBounds.y      = (bounds.y * levelHeight) / image->height;
+    levelBounds.width  = ((((bounds.x + bounds.width) * levelWidth) + image->width - 1) / image->width) - levelBounds.x;
+    levelBounds.height = ((((bounds.y + bounds.height) * levelHeight) + image->height - 1) / image->height) - levelBounds.y;
+
+    DrawImagePart(imageTexture, levelBounds, levelWidth, levelHeight, destinationRect, !image->isOpaque);
+}
+
+// Part edges are mapped to the destination one by one, so parts that share an edge meet without a gap or an overlap.
+void Renderer::DrawImagePart(SDL_Texture* texture, const Image::Region& part, const int levelWidth, const int levelHeight, const SDL_Rect& destinationRect, const bool isBlended) {
+    auto left   = destinationRect.x + ((part.x * destinationRect.w) + (levelWidth / 2)) / levelWidth;
+    auto top    = destinationRect.y + ((part.y * destinationRect.h) + (levelHeight / 2)) / levelHeight;
+    auto right  = destinationRect.x + (((part.x + part.width) * destinationRect.w) + (levelWidth / 2)) / levelWidth;
+    auto bottom = destinationRect.y + (((part.y + part.height) * destinationRect.h) + (levelHeight / 2)) / levelHeight;
+
+    if ((right <= left) || (bottom <= top)) {
+        return;
+    }
+
+    SDL_Rect sourceRect = { part.x, part.y, part.width, part.height };
+    SDL_Rect partRect   = { left, top, right - left, bottom - top };
+
+    SDL_RenderCopy(sdlRenderer, texture, &sourceRect, &partRect);
+    drawCalls++;
+
+    if (isBlended) {
+        blendedPixels += U64(partRect.w) * partRect.h;
+    }
+
+    if (Overdraw::IsEnabled()) {
+        Overdraw::AddRect(partRect, isBlended);
+    }
+}
+
+uint Renderer::SelectImageLevel(const Image* image, const f32 destinationWidth) {
+    if ((image->numberOfLevels == 0) || (destinationWidth <= 0.0f)) {
+        return 0;
+    }
+
+    // The destination is in logical units, what is sampled depends on the current resolution scale too.
+    auto level = std::log2(image->width / (destinationWidth * resolutionScale)) + imageLevelBias;
+
+    if (level < 0.5f) {
+        return 0;
+    }
+
+    return std::min(UINT(level + 0.5f), image->numberOfLevels);
+}
+
+// Images
+
+void Renderer::SetImageLevels(const uint maxLevels, const f32 levelBias) {
+    imageLevels    = std::min(maxLevels, UINT(Image::MaxLevels));
+    imageLevelBias = levelBias;
+
+    DEBUG(Txt::ImageLevels, imageLevels, imageLevelBias);
+}
+
+u64 Renderer::GetTextureMemory() {
+    return textureMemory;
+}
+
+// Only images loaded afterwards are affected.
+void Renderer::SetImageRegions(const bool isEnabled, const int minimumSize) {
+    areImageRegionsEnabled = isEnabled;
+    minimumSplitSize       = std::max(minimumSize, I32(Renderer::RegionTileSize));
+
+    if (areImageRegionsEnabled) {
+        DEBUG(Txt::ImageRegions, minimumSplitSize, minimumSplitSize);
+    } else {
+        DEBUG(Txt::NoImageRegions);
+    }
 }
 
 Image* Renderer::LoadImage(const std::string& filePath) {
+    if (!WaitForLibraries()) {
+        return NULL;
+    }
+
+    if (filePath.find(Renderer::RecipeSeparator) != string::npos) {
+        return LoadRecipe(filePath);
+    }
+
     auto imageSurface = IMG_Load(filePath.c_str());
 
     if (imageSurface == NULL) {
@@ -175,50 +738,575 @@ Image* Renderer::LoadImage(const std::string& filePath) {
     }
 
     DEBUG(Txt::ImageLoaded, filePath.c_str());
-    return ImageFromSurface(imageSurface);
-}
 
-Image* Renderer::ImageFromSurface(SDL_Surface* surface) {
-    int imageWidth  = surface->w;
-    int imageHeight = surface->h;
+    return ImageFromSurface(imageSurface, true, filePath);
+}
 
-    SDL_Texture* imageTexture = SDL_CreateTextureFromSurface(sdlRenderer, surface);
-    SDL_FreeSurface(surface);
+SDL_Surface* Renderer::LoadSurface(const string& filePath) {
+    auto fileSurface = IMG_Load(filePath.c_str());
 
-    if (imageTexture == NULL) {
-        WARNING(Txt::CouldNotCreateImageTexture, SDL_GetError());
+    if (fileSurface == NULL) {
+        WARNING(Txt::CouldNotLoadImage, filePath.c_str(), IMG_GetError());
         return NULL;
     }
 
+    auto imageSurface = SDL_ConvertSurfaceFormat(fileSurface, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(fileSurface);
+
+    if (imageSurface == NULL) {
+        WARNING(Txt::CouldNotLoadImage, filePath.c_str(), SDL_GetError());
+    }
+
+    return imageSurface;
+}
+
+Image* Renderer::ImageFromSurface(SDL_Surface* surface, const bool withLevels, const string& filePath) {
     auto image = new Image();
 
-    image->width  = imageWidth;
-    image->height = imageHeight;
-    image->data   = imageTexture;
+    image->width   = surface->w;
+    image->height  = surface->h;
+    image->data    = NULL;
+    image->surface = surface;
+    image->path    = filePath;
+    image->serial  = ++imageSerials;
+
+    std::fill(image->tints, image->tints + Image::MaxLevels + 1, Image::NoTint);
+    AnalyzeAlpha(image, surface);
+
+    // Levels are built here, so images loaded by a worker thread do that work off the render thread as well.
+    if (withLevels) {
+        auto levelSurface = surface;
+
+        while ((image->numberOfLevels < imageLevels) && (levelSurface->w / 2 >= Renderer::MinimumLevelSize) && (levelSurface->h / 2 >= Renderer::MinimumLevelSize)) {
+            levelSurface = DownscaleSurface(levelSurface);
+
+            if (levelSurface == NULL) {
+                break;
+            }
+
+            image->levelSurfaces[image->numberOfLevels++] = levelSurface;
+        }
+    }
+
+    // Textures can only be created by the thread that owns the renderer, images decoded anywhere else wait for
+    // UploadPendingImages.
+    if (std::this_thread::get_id() != renderThreadId) {
+        pendingImagesMutex.lock();
+        pendingImages.push_back(image);
+        pendingImagesMutex.unlock();
+        return image;
+    }
+
+    if (!UploadImage(image)) {
+        UnloadImage(image);
+        return NULL;
+    }
 
     return image;
 }
 
+SDL_Surface* Renderer::DownscaleSurface(SDL_Surface* surface) {
+    // Every level after the first is already built in the right format, only a decoded image may need a conversion.
+    auto sourceSurface = surface->format->format == SDL_PIXELFORMAT_ARGB8888 ? surface : SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+
+    if (sourceSurface == NULL) {
+        return NULL;
+    }
+
+    auto levelSurface = SDL_CreateRGBSurfaceWithFormat(0, sourceSurface->w / 2, sourceSurface->h / 2, 32, SDL_PIXELFORMAT_ARGB8888);
+
+    if (levelSurface == NULL) {
+        if (sourceSurface != surface) {
+            SDL_FreeSurface(sourceSurface);
+        }
+
+        return NULL;
+    }
+
+    // 2x2 box filter, weighting colors by alpha so transparent pixels do not darken the edges.
+    for (int y = 0; y < levelSurface->h; y++) {
+        auto sourceRow0 = reinterpret_cast<const u32*>(DATA(sourceSurface->pixels) + (y * 2) * sourceSurface->pitch);
+        auto sourceRow1 = reinterpret_cast<const u32*>(DATA(sourceSurface->pixels) + (y * 2 + 1) * sourceSurface->pitch);
+        auto levelRow   = reinterpret_cast<u32*>(DATA(levelSurface->pixels) + y * levelSurface->pitch);
+
+        for (int x = 0; x < levelSurface->w; x++) {
+            u32 pixels[4] = { sourceRow0[x * 2], sourceRow0[x * 2 + 1], sourceRow1[x * 2], sourceRow1[x * 2 + 1] };
+            u32 alpha = 0, red = 0, green = 0, blue = 0;
+
+            for (auto pixel : pixels) {
+                auto pixelAlpha = pixel >> 24;
+
+                alpha += pixelAlpha;
+                red += ((pixel >> 16) & 0xFF) * pixelAlpha;
+                green += ((pixel >> 8) & 0xFF) * pixelAlpha;
+                blue += (pixel & 0xFF) * pixelAlpha;
+            }
+
+            if (alpha == 0) {
+                levelRow[x] = 0;
+                continue;
+            }
+
+            levelRow[x] = ((alpha / 4) << 24) | ((red / alpha) << 16) | ((green / alpha) << 8) | (blue / alpha);
+        }
+    }
+
+    if (sourceSurface != surface) {
+        SDL_FreeSurface(sourceSurface);
+    }
+
+    return levelSurface;
+}
+
+// Only exact values count (alpha 0 is left out, 255 is drawn without blending), what ends up on screen does not change.
+void Renderer::AnalyzeAlpha(Image* image, SDL_Surface* surface) {
+    image->isOpaque              = false;
+    image->bounds                = { 0, 0, surface->w, surface->h };
+    image->numberOfRegions       = 0;
+    image->numberOfOpaqueRegions = 0;
+
+    // Without any alpha SDL already draws the texture without blending, regions or not.
+    if ((surface->format->Amask == 0) && (surface->format->palette == NULL) && !SDL_HasColorKey(surface)) {
+        image->isOpaque = true;
+        return;
+    }
+
+    if (!areImageRegionsEnabled) {
+        return;
+    }
+
+    auto alphaSurface = surface->format->format == SDL_PIXELFORMAT_ARGB8888 ? surface : SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+
+    if (alphaSurface == NULL) {
+        return;
+    }
+
+    int  left           = alphaSurface->w;
+    int  top            = alphaSurface->h;
+    int  right          = 0;
+    int  bottom         = 0;
+    bool hasTranslucent = false;
+
+    for (int y = 0; y < alphaSurface->h; y++) {
+        auto row = reinterpret_cast<const u32*>(DATA(alphaSurface->pixels) + y * alphaSurface->pitch);
+
+        for (int x = 0; x < alphaSurface->w; x++) {
+            auto alpha = row[x] >> 24;
+
+            hasTranslucent |= alpha != 0xFF;
+
+            if (alpha == 0) {
+                continue;
+            }
+
+            left   = std::min(left, x);
+            right  = std::max(right, x + 1);
+            top    = std::min(top, y);
+            bottom = y + 1;
+        }
+    }
+
+    if (right == 0) {
+        image->bounds = { 0, 0, 0, 0 };
+    } else if (!hasTranslucent) {
+        image->isOpaque = true;
+    } else {
+        image->bounds = { left, top, right - left, bottom - top };
+
+        if ((image->bounds.width >= minimumSplitSize) && (image->bounds.height >= minimumSplitSize)) {
+            SplitRegions(image, alphaSurface);
+        }
+    }
+
+    if (alphaSurface != surface) {
+        SDL_FreeSurface(alphaSurface);
+    }
+
+    // Text is left out, it changes all the time.
+    if (!image->path.empty()) {
+        auto imageArea     = F64(image->width) * image->height;
+        u64  blendedArea   = image->isOpaque ? 0 : U64(image->bounds.width) * image->bounds.height;
+        u64  opaqueArea    = image->isOpaque ? U64(imageArea) : 0;
+        auto numberOfDraws = std::max(image->numberOfRegions, 1u);
+
+        if (image->numberOfRegions > 0) {
+            blendedArea = 0;
+
+            for (uint regionIndex = 0; regionIndex < image->numberOfRegions; regionIndex++) {
+                auto regionArea = U64(image->regions[regionIndex].width) * image->regions[regionIndex].height;
+
+                if (regionIndex < image->numberOfOpaqueRegions) {
+                    opaqueArea += regionArea;
+                } else {
+                    blendedArea += regionArea;
+                }
+            }
+        }
+
+        DEBUG(Txt::ImageFill, image->path.c_str(), (blendedArea / imageArea) * 100.0, (opaqueArea / imageArea) * 100.0, numberOfDraws);
+    }
+}
+
+// The bounds are cut into tiles, each one opaque, translucent or transparent. Tiles of the same kind next to each
+// other on a row make a region, which grows downwards while the rows below have the same one. Splits that take too
+// many regions or do not save enough blending are dropped, the bounds are drawn whole.
+void Renderer::SplitRegions(Image* image, const SDL_Surface* surface) {
+    enum TileFlags {
+        Visible     = 1,
+        Translucent = 2
+    };
+
+    struct Part {
+        Image::Region region;
+        bool          isOpaque;
+    };
+
+    auto& bounds = image->bounds;
+    auto  tilesX = (bounds.width + Renderer::RegionTileSize - 1) / Renderer::RegionTileSize;
+    auto  tilesY = (bounds.height + Renderer::RegionTileSize - 1) / Renderer::RegionTileSize;
+
+    std::vector<u8>   tiles(tilesX * tilesY, 0);
+    std::vector<Part> parts;
+
+    for (int y = 0; y < bounds.height; y++) {
+        auto row     = reinterpret_cast<const u32*>(DATA(surface->pixels) + (bounds.y + y) * surface->pitch) + bounds.x;
+        auto tileRow = tiles.data() + (y / Renderer::RegionTileSize) * tilesX;
+
+        for (int x = 0; x < bounds.width; x++) {
+            auto alpha = row[x] >> 24;
+
+            tileRow[x / Renderer::RegionTileSize] |= (alpha != 0 ? Visible : 0) | (alpha != 0xFF ? Translucent : 0);
+        }
+    }
+
+    for (int tileY = 0; tileY < tilesY; tileY++) {
+        auto partTop    = bounds.y + (tileY * Renderer::RegionTileSize);
+        auto partHeight = std::min(I32(Renderer::RegionTileSize), bounds.y + bounds.height - partTop);
+        auto tileRow    = tiles.data() + (tileY * tilesX);
+
+        for (int tileX = 0; tileX < tilesX;) {
+            auto tileKind = tileRow[tileX];
+            auto runEnd   = tileX + 1;
+
+            while ((runEnd < tilesX) && (tileRow[runEnd] == tileKind)) {
+                runEnd++;
+            }
+
+            auto partLeft  = bounds.x + (tileX * Renderer::RegionTileSize);
+            auto partRight = std::min(bounds.x + (runEnd * Renderer::RegionTileSize), bounds.x + bounds.width);
+            auto isOpaque  = tileKind == Visible;
+
+            tileX = runEnd;
+
+            if ((tileKind & Visible) == 0) {
+                continue;
+            }
+
+            auto part = std::find_if(parts.begin(), parts.end(), [&](const Part& other) {
+                return (other.isOpaque == isOpaque) && (other.region.x == partLeft) && (other.region.width == partRight - partLeft) && (other.region.y + other.region.height == partTop);
+            });
+
+            if (part != parts.end()) {
+                part->region.height += partHeight;
+            } else if (parts.size() < Image::MaxRegions) {
+                parts.push_back({ { partLeft, partTop, partRight - partLeft, partHeight }, isOpaque });
+            } else {
+                return;
+            }
+        }
+    }
+
+    u64 blendedArea = 0;
+
+    for (auto& part : parts) {
+        blendedArea += part.isOpaque ? 0 : U64(part.region.width) * part.region.height;
+    }
+
+    if (blendedArea > (Renderer::MaxSplitBlending * bounds.width * bounds.height)) {
+        return;
+    }
+
+    // Opaque regions first, Draw switches the blending off for them only once.
+    std::stable_partition(parts.begin(), parts.end(), [](const Part& part) {
+        return part.isOpaque;
+    });
+
+    for (auto& part : parts) {
+        image->regions[image->numberOfRegions++] = part.region;
+        image->numberOfOpaqueRegions += part.isOpaque ? 1 : 0;
+    }
+}
+
+bool Renderer::UploadImage(Image* image) {
+    auto imageSurface = (SDL_Surface*) image->surface;
+
+    image->data    = SDL_CreateTextureFromSurface(sdlRenderer, imageSurface);
+    image->surface = NULL;
+    SDL_FreeSurface(imageSurface);
+
+    if (image->data == NULL) {
+        WARNING(Txt::CouldNotCreateImageTexture, SDL_GetError());
+        return false;
+    }
+
+    textureMemory += U64(image->width) * image->height * 4;
+
+    // Textures of images with an alpha channel blend by default, even when every pixel is opaque.
+    if (image->isOpaque) {
+        SDL_SetTextureBlendMode((SDL_Texture*) image->data, SDL_BLENDMODE_NONE);
+    }
+
+    for (uint levelIndex = 0; levelIndex < image->numberOfLevels; levelIndex++) {
+        auto levelSurface = (SDL_Surface*) image->levelSurfaces[levelIndex];
+
+        image->levels[levelIndex]        = SDL_CreateTextureFromSurface(sdlRenderer, levelSurface);
+        image->levelSurfaces[levelIndex] = NULL;
+
+        // Without the texture the level is useless, so are the smaller ones: Draw falls back to the larger levels.
+        if (image->levels[levelIndex] == NULL) {
+            WARNING(Txt::CouldNotCreateImageTexture, SDL_GetError());
+
+            for (auto smallerIndex = levelIndex + 1; smallerIndex < image->numberOfLevels; smallerIndex++) {
+                SDL_FreeSurface((SDL_Surface*) image->levelSurfaces[smallerIndex]);
+                image->levelSurfaces[smallerIndex] = NULL;
+            }
+
+            image->numberOfLevels = levelIndex;
+        } else {
+            textureMemory += U64(levelSurface->w) * levelSurface->h * 4;
+
+            if (image->isOpaque) {
+                SDL_SetTextureBlendMode((SDL_Texture*) image->levels[levelIndex], SDL_BLENDMODE_NONE);
+            }
+        }
+
+        SDL_FreeSurface(levelSurface);
+    }
+
+    Telemetry::Set(textureMemoryMetric, textureMemory / 1024);
+    return true;
+}
+
+void Renderer::UploadPendingImages(const uint maxImages) {
+    uint uploadedImages = 0;
+
+    pendingImagesMutex.lock();
+
+    while (!pendingImages.empty() && (uploadedImages < maxImages)) {
+        UploadImage(pendingImages.back());
+        pendingImages.pop_back();
+        uploadedImages++;
+    }
+
+    Telemetry::Set(pendingImagesMetric, pendingImages.size());
+    pendingImagesMutex.unlock();
+
+    // Objects already pointing at these images were not drawn so far.
+    if (uploadedImages > 0) {
+        World::Invalidate();
+    }
+}
+
+bool Renderer::HasPendingImages() {
+    pendingImagesMutex.lock();
+    auto hasPendingImages = !pendingImages.empty();
+    pendingImagesMutex.unlock();
+
+    return hasPendingImages;
+}
+
 void Renderer::UnloadImage(const Image* image) {
     if (image == NULL) {
         return;
     }
 
-    SDL_DestroyTexture((SDL_Texture*) image->data);
+    if (image->surface != NULL) {
+        pendingImagesMutex.lock();
+
+        auto pendingImage = std::find(pendingImages.begin(), pendingImages.end(), image);
+
+        if (pendingImage != pendingImages.end()) {
+            pendingImages.erase(pendingImage);
+        }
+
+        pendingImagesMutex.unlock();
+        SDL_FreeSurface((SDL_Surface*) image->surface);
+    }
+
+    if (image->data != NULL) {
+        SDL_DestroyTexture((SDL_Texture*) image->data);
+        textureMemory -= U64(image->width) * image->height * 4;
+    }
+
+    for (uint levelIndex = 0; levelIndex < Image::MaxLevels; levelIndex++) {
+        if (image->levelSurfaces[levelIndex] != NULL) {
+            SDL_FreeSurface((SDL_Surface*) image->levelSurfaces[levelIndex]);
+        }
+
+        if (image->levels[levelIndex] != NULL) {
+            SDL_DestroyTexture((SDL_Texture*) image->levels[levelIndex]);
+            textureMemory -= U64(image->width >> (levelIndex + 1)) * (image->height >> (levelIndex + 1)) * 4;
+        }
+    }
+
+    Telemetry::Set(textureMemoryMetric, textureMemory / 1024);
     delete image;
 }
 
+// Recoloring
+
+bool Renderer::RecolorImages(const string& basePath, const string& maskPath, const TintRegion* regions, const uint numberOfRegions, Image** variants, const uint numberOfVariants) {
+    std::fill(variants, variants + numberOfVariants, static_cast<Image*>(NULL));
+
+    if (!WaitForLibraries()) {
+        return false;
+    }
+
+    // Both are decoded once, whatever the number of variants.
+    auto baseSurface = LoadSurface(basePath);
+    auto maskSurface = LoadSurface(maskPath);
+    auto isLoaded    = (baseSurface != NULL) && (maskSurface != NULL);
+
+    if (isLoaded && ((baseSurface->w != maskSurface->w) || (baseSurface->h != maskSurface->h))) {
+        WARNING(Txt::MaskSizeMismatch, maskPath.c_str());
+        isLoaded = false;
+    }
+
+    uint numberOfRecolored = 0;
+
+    for (uint variantIndex = 0; isLoaded && (variantIndex < numberOfVariants); variantIndex++) {
+        auto variantSurface = SDL_ConvertSurfaceFormat(baseSurface, SDL_PIXELFORMAT_ARGB8888, 0);
+
+        if (variantSurface == NULL) {
+            WARNING(Txt::CouldNotLoadImage, basePath.c_str(), SDL_GetError());
+            break;
+        }
+
+        for (uint regionIndex = 0; regionIndex < numberOfRegions; regionIndex++) {
+            BlendTinted(variantSurface, maskSurface, regions[(variantIndex * numberOfRegions) + regionIndex]);
+        }
+
+        variants[variantIndex] = ImageFromSurface(variantSurface, true, RecipePath(basePath, maskPath, regions + (variantIndex * numberOfRegions), numberOfRegions));
+        numberOfRecolored += variants[variantIndex] != NULL ? 1 : 0;
+    }
+
+    SDL_FreeSurface(baseSurface);
+    SDL_FreeSurface(maskSurface);
+
+    if (numberOfRecolored > 0) {
+        DEBUG(Txt::ImagesRecolored, basePath.c_str(), numberOfRecolored);
+    }
+
+    return numberOfRecolored == numberOfVariants;
+}
+
+string Renderer::RecipePath(const string& basePath, const string& maskPath, const TintRegion* regions, const uint numberOfRegions) {
+    auto recipePath = basePath + Renderer::RecipeSeparator + maskPath;
+    char regionText[64];
+
+    for (uint regionIndex = 0; regionIndex < numberOfRegions; regionIndex++) {
+        auto& region = regions[regionIndex];
+
+        snprintf(regionText, sizeof(regionText), "%c%d,%d,%d,%d,%06X", Renderer::RecipeSeparator, region.rect.x, region.rect.y, region.rect.w, region.rect.h, region.tint & 0xFFFFFF);
+        recipePath += regionText;
+    }
+
+    return recipePath;
+}
+
+// The variant is baked again from its recipe, it gets the same path back.
+Image* Renderer::LoadRecipe(const string& recipePath) {
+    std::vector<string> parts;
+    size_t              partStart = 0;
+    size_t              partEnd;
+
+    while ((partEnd = recipePath.find(Renderer::RecipeSeparator, partStart)) != string::npos) {
+        parts.push_back(recipePath.substr(partStart, partEnd - partStart));
+        partStart = partEnd + 1;
+    }
+
+    parts.push_back(recipePath.substr(partStart));
+
+    std::vector<TintRegion> regions(parts.size() - 1);
+    auto                    isValid = parts.size() >= 2;
+
+    for (uint partIndex = 2; isValid && (partIndex < parts.size()); partIndex++) {
+        auto& region = regions[partIndex - 2];
+        int   length = 0;
+
+        isValid = (sscanf(parts[partIndex].c_str(), "%d,%d,%d,%d,%x%n", &region.rect.x, &region.rect.y, &region.rect.w, &region.rect.h, &region.tint, &length) == 5) && (UINT(length) == parts[partIndex].size());
+    }
+
+    if (!isValid) {
+        WARNING(Txt::InvalidRecipe, recipePath.c_str());
+        return NULL;
+    }
+
+    Image* variant = NULL;
+
+    RecolorImages(parts[0], parts[1], regions.data(), parts.size() - 2, &variant, 1);
+    return variant;
+}
+
+// Tinting the mask and blending it are fused, each pixel is read and written once. Both surfaces are ARGB8888 with
+// straight alpha, the result stays that way.
+void Renderer::BlendTinted(SDL_Surface* target, const SDL_Surface* mask, const TintRegion& region) {
+    SDL_Rect surfaceRect = { 0, 0, target->w, target->h };
+    SDL_Rect blendRect;
+
+    if (!SDL_IntersectRect(&region.rect, &surfaceRect, &blendRect)) {
+        return;
+    }
+
+    u32 tintRed   = (region.tint >> 16) & 0xFF;
+    u32 tintGreen = (region.tint >> 8) & 0xFF;
+    u32 tintBlue  = region.tint & 0xFF;
+
+    for (int y = blendRect.y; y < blendRect.y + blendRect.h; y++) {
+        auto maskRow   = reinterpret_cast<const u32*>(DATA(mask->pixels) + y * mask->pitch);
+        auto targetRow = reinterpret_cast<u32*>(DATA(target->pixels) + y * target->pitch);
+
+        for (int x = blendRect.x; x < blendRect.x + blendRect.w; x++) {
+            auto maskPixel = maskRow[x];
+            auto maskAlpha = maskPixel >> 24;
+
+            if (maskAlpha == 0) {
+                continue;
+            }
+
+            auto sourceRed   = ((((maskPixel >> 16) & 0xFF) * tintRed) + 127) / 255;
+            auto sourceGreen = ((((maskPixel >> 8) & 0xFF) * tintGreen) + 127) / 255;
+            auto sourceBlue  = (((maskPixel & 0xFF) * tintBlue) + 127) / 255;
+
+            // What shows of the target through the mask.
+            auto targetPixel  = targetRow[x];
+            auto targetWeight = (((targetPixel >> 24) * (255 - maskAlpha)) + 127) / 255;
+            auto outputAlpha  = maskAlpha + targetWeight;
+
+            auto red   = ((sourceRed * maskAlpha) + (((targetPixel >> 16) & 0xFF) * targetWeight) + (outputAlpha / 2)) / outputAlpha;
+            auto green = ((sourceGreen * maskAlpha) + (((targetPixel >> 8) & 0xFF) * targetWeight) + (outputAlpha / 2)) / outputAlpha;
+            auto blue  = ((sourceBlue * maskAlpha) + ((targetPixel & 0xFF) * targetWeight) + (outputAlpha / 2)) / outputAlpha;
+
+            targetRow[x] = (outputAlpha << 24) | (red << 16) | (green << 8) | blue;
+        }
+    }
+}
+
 Image* Renderer::TextImage(const std::string& text) {
+    return TextImage(text.c_str());
+}
+
+Image* Renderer::TextImage(const charconst text) {
     static SDL_Color textColor = {255, 255, 255, 255};
 
-    auto textSurface = TTF_RenderText_Blended(textFont, text.c_str(), textColor);
+    auto textSurface = TTF_RenderText_Blended(textFont, text, textColor);
 
     if (textSurface == NULL) {
         WARNING(Txt::CouldNotCreateTextTexture, SDL_GetError());
         return NULL;
     }
 
-    return ImageFromSurface(textSurface);
+    return ImageFromSurface(textSurface, false, string());
 }
 
 }    // namespace Biq
\ No newline at end of file
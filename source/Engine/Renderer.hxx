@@ -26,26 +26,101 @@ class Renderer {
         static constexpr charconst Tag             = "Renderer";
         static constexpr charconst DefaultFontPath = "assets/font.ttf";
         static constexpr int       TextSize        = 36;
+        static constexpr uint      UploadsPerFrame = 4;
+
+        // Loaded images get up to ImageLevels downscaled copies (each half the size of the previous one, down to
+        // MinimumLevelSize), Draw picks the one closest to the destination size. More levels cost up to a third more
+        // texture memory, the bias moves the choice towards smaller (positive) or larger (negative) levels.
+
+        static constexpr uint DefaultImageLevels = 4;
+        static constexpr int  MinimumLevelSize   = 16;
+
+        // Image regions: the transparent borders of loaded images are trimmed, only their bounds are drawn. Images with
+        // bounds of at least MinimumSplitSize on both sides are split on a RegionTileSize grid into opaque regions
+        // (drawn without blending) and translucent ones, leaving fully transparent tiles out, when that blends no more
+        // than MaxSplitBlending of the bounds in at most Image::MaxRegions draws. Regions are only used at full size,
+        // levels are drawn in one piece. Images without any translucent pixel are never blended.
+
+        static constexpr int DefaultMinimumSplitSize = 128;
+        static constexpr int RegionTileSize          = 16;
+        static constexpr f32 MaxSplitBlending        = 0.75f;
+
+        // Dynamic resolution: the scale moves in ScaleStep increments, at most once every ScaleAdjustFrames frames,
+        // going down when the average frame time is over budget and up when it has ScaleUpHeadroom to spare.
+
+        static constexpr f32  ScaleStep          = 0.05f;
+        static constexpr uint ScaleLevels        = 20;
+        static constexpr uint ScaleAdjustFrames  = 15;
+        static constexpr f32  ScaleUpHeadroom    = 0.75f;
+        static constexpr f32  FrameTimeSmoothing = 0.1f;
 
         // General
 
-        static bool Initialize(const GameInformation& gameInformation);
-        static void Finalize();
-        static void Update();
+        // InitializeLibraries makes the calling thread the render thread and starts loading the image codecs and the
+        // default font on a worker, Initialize then creates the window and waits for them. Images can be loaded (by
+        // any thread) as soon as the libraries are started, they wait for the codecs.
+        static void      InitializeLibraries();
+        static bool      Initialize(const GameInformation& gameInformation);
+        static void      Finalize();
+        static void      Update();
+        static void      SkipFrame();
+        static charconst GetBackendName();
+        static const SDL_Rect& GetFrameRect();
+
+        // Partial Frames
+
+        // Frames drawn into a render target (dynamic resolution or SetRetainedFrame) keep their content, so only the
+        // damaged rect needs to be drawn again: BeginPartialFrame clips to it and clears it, EndPartialFrame lifts the
+        // clip. Presented frames are always whole. ReadPixels reads the frame drawn so far (RGBA, GetFrameRect sized).
+        static bool SetRetainedFrame(const bool retained);
+        static bool HasRetainedFrame();
+        static void BeginPartialFrame(const SDL_Rect& damageRect);
+        static void EndPartialFrame();
+        static bool ReadPixels(std::vector<u8>& pixels);
+
+        // Resolution Scaling
+
+        static bool SetResolutionScaling(const f32 minimumScale, const f32 maximumScale, const f32 frameBudget);
+        static f32  GetResolutionScale();
 
         // Drawing
 
         static void Splash(const Image* image);
-        static void Draw(const Image* image, const Vector2D& position, const Vector2D& size);
+        static void Draw(const Image* image, const Vector2D& position, const Vector2D& size, const u32 tint = Image::NoTint);
+        static void DrawGeometry(const SDL_Vertex* vertices, const uint numberOfVertices, const int* indices, const uint numberOfIndices);
 
         // Images
 
+        static void   SetImageLevels(const uint maxLevels, const f32 levelBias);
+        static u64    GetTextureMemory();
+        static void   SetImageRegions(const bool isEnabled, const int minimumSize = DefaultMinimumSplitSize);
         static Image* LoadImage(const string& filePath);
         static void   UnloadImage(const Image* image);
+        static void   UploadPendingImages(const uint maxImages);
+        static bool   HasPendingImages();
+
+        // Recoloring
+
+        // Color variants of a sprite are a neutral base and a grayscale mask (shaded like the sprite, its alpha covering
+        // the colored parts): drawing the mask over the base with a tint gives any variant from the same two textures.
+        // Sprites with several colors at once are baked instead, each region of the mask is tinted and blended over the
+        // base in a single pass on the CPU (the same blend SDL does). Regions are in image pixels, numberOfRegions per
+        // variant. Baked variants are named after their recipe (base|mask|x,y,w,h,RRGGBB|...) and LoadImage bakes such
+        // a path again, so tools that load images by path (draw replays, spectators) draw the same colors.
+
+        static constexpr char RecipeSeparator = '|';
+
+        struct TintRegion {
+            SDL_Rect rect;
+            u32      tint;
+        };
+
+        static bool RecolorImages(const string& basePath, const string& maskPath, const TintRegion* regions, const uint numberOfRegions, Image** variants, const uint numberOfVariants);
 
         // Text
 
         static Image* TextImage(const string& text);
+        static Image* TextImage(const charconst text);
 
     protected:
         Renderer() = delete;
@@ -56,7 +131,60 @@ class Renderer {
         static SDL_Renderer* sdlRenderer;
         static TTF_Font*     textFont;
 
-        static Image* ImageFromSurface(SDL_Surface* surface);
+        static std::thread::id     renderThreadId;
+        static std::mutex          pendingImagesMutex;
+        static std::vector<Image*> pendingImages;
+
+        static std::thread       librariesWorker;
+        static std::mutex        librariesMutex;
+        static std::atomic<bool> areLibrariesReady;
+
+        static SDL_Texture* renderTarget;
+        static f32          resolutionScale;
+        static f32          minimumResolutionScale;
+        static f32          maximumResolutionScale;
+        static f32          frameTimeBudget;
+        static f64          averageFrameTime;
+        static f64          lastUpdateTime;
+        static uint         framesSinceScaleChange;
+        static f64          timeAtScale[ScaleLevels + 1];
+        static uint         resolutionScaleMetric;
+
+        static uint imageLevels;
+        static f32  imageLevelBias;
+        static u64  textureMemory;
+        static uint textureMemoryMetric;
+        static bool areImageRegionsEnabled;
+        static int  minimumSplitSize;
+
+        static uint drawCalls;
+        static uint drawCallsMetric;
+        static u64  blendedPixels;
+        static uint blendedPixelsMetric;
+        static uint pendingImagesMetric;
+        static uint skippedFramesMetric;
+        static uint partialFramesMetric;
+
+        static std::atomic<u32> imageSerials;
+
+        static void         LoadLibraries();
+        static bool         WaitForLibraries();
+        static Image*       ImageFromSurface(SDL_Surface* surface, const bool withLevels, const string& filePath);
+        static SDL_Surface* DownscaleSurface(SDL_Surface* surface);
+        static void         AnalyzeAlpha(Image* image, SDL_Surface* surface);
+        static void         SplitRegions(Image* image, const SDL_Surface* surface);
+        static SDL_Surface* LoadSurface(const string& filePath);
+        static void         BlendTinted(SDL_Surface* target, const SDL_Surface* mask, const TintRegion& region);
+        static string       RecipePath(const string& basePath, const string& maskPath, const TintRegion* regions, const uint numberOfRegions);
+        static Image*       LoadRecipe(const string& recipePath);
+        static bool         UploadImage(Image* image);
+        static uint         SelectImageLevel(const Image* image, const f32 destinationWidth);
+        static void         DrawImage(const Image* image, const uint imageLevel, const SDL_Rect& destinationRect);
+        static void         DrawImagePart(SDL_Texture* texture, const Image::Region& part, const int levelWidth, const int levelHeight, const SDL_Rect& destinationRect, const bool isBlended);
+        static void         CaptureFrame();
+        static bool         CreateRenderTarget();
+        static void         UpdateResolutionScale();
+        static void         ReportResolutionScale();
 };
 
 }    // namespace Biq
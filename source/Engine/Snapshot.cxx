@@ -0,0 +1,247 @@
+/*
+ * Source/Engine/Snapshot.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/Snapshot.hxx"
+
+#include "Engine/Engine.hxx"
+
+namespace Biq {
+
+// String Table
+
+namespace Txt {
+static const charconst InvalidSnapshot   = "Invalid snapshot (magic %08x, version %d, %d bytes)";
+static const charconst ContentMismatch   = "The snapshot content version is %d, expected %d";
+static const charconst TruncatedSnapshot = "The snapshot is truncated (%d bytes needed at offset %d of %d)";
+static const charconst InvalidDelta      = "Invalid snapshot delta (%d bytes)";
+}    // namespace Txt
+
+// Changed runs absorb unchanged gaps shorter than this, two run lengths would cost more than the gap itself.
+static constexpr uint MinimumUnchangedRun = 4;
+
+// General
+
+Snapshot::Snapshot() :
+    size(0), readOffset(0) {
+}
+
+// Writing
+
+void Snapshot::Begin(const u32 contentVersion) {
+    Header header = { Snapshot::Magic, Snapshot::Version, 0, contentVersion };
+
+    size       = 0;
+    readOffset = 0;
+
+    Reserve(Snapshot::InitialSize);
+    Write(header);
+}
+
+void Snapshot::End() {
+    auto header = reinterpret_cast<Header*>(buffer.data());
+    header->size = size;
+}
+
+void Snapshot::WriteBytes(const void* bytes, const uint numberOfBytes) {
+    Reserve(size + numberOfBytes);
+    memcpy(buffer.data() + size, bytes, numberOfBytes);
+    size += numberOfBytes;
+}
+
+void Snapshot::Reserve(const uint numberOfBytes) {
+    if (numberOfBytes > buffer.size()) {
+        // The buffer is kept between snapshots, so steady state saves never allocate.
+        buffer.resize(std::max(numberOfBytes, UINT(buffer.size() * 2)));
+    }
+}
+
+// Reading
+
+bool Snapshot::Open(const u32 contentVersion) const {
+    readOffset = 0;
+
+    Header header;
+
+    if ((size < sizeof(Header)) || !Read(header) || (header.magic != Snapshot::Magic) || (header.version != Snapshot::Version) || (header.size != size)) {
+        ERROR(Txt::InvalidSnapshot, size < sizeof(Header) ? 0 : header.magic, size < sizeof(Header) ? 0 : header.version, size);
+        return false;
+    }
+
+    if (header.contentVersion != contentVersion) {
+        ERROR(Txt::ContentMismatch, header.contentVersion, contentVersion);
+        return false;
+    }
+
+    return true;
+}
+
+bool Snapshot::ReadBytes(void* bytes, const uint numberOfBytes) const {
+    if (readOffset + numberOfBytes > size) {
+        ERROR(Txt::TruncatedSnapshot, numberOfBytes, readOffset, size);
+        return false;
+    }
+
+    memcpy(bytes, buffer.data() + readOffset, numberOfBytes);
+    readOffset += numberOfBytes;
+    return true;
+}
+
+// Contents
+
+void Snapshot::SetData(const void* bytes, const uint numberOfBytes) {
+    size       = 0;
+    readOffset = 0;
+
+    WriteBytes(bytes, numberOfBytes);
+}
+
+const u8* Snapshot::GetData() const {
+    return buffer.data();
+}
+
+uint Snapshot::GetSize() const {
+    return size;
+}
+
+bool Snapshot::IsEqual(const Snapshot& snapshot) const {
+    return (size == snapshot.size) && (memcmp(buffer.data(), snapshot.buffer.data(), size) == 0);
+}
+
+// Deltas
+
+// A delta is the target size followed by (unchanged length, changed length, changed bytes) runs, lengths are stored as
+// 7 bit varints and changed bytes are XORed with the base. Bytes past the end of the base are XORed with zero and the
+// trailing unchanged run is left out.
+
+static void WriteLength(std::vector<u8>& delta, uint length) {
+    while (length >= 0x80) {
+        delta.push_back(U8(length | 0x80));
+        length >>= 7;
+    }
+
+    delta.push_back(U8(length));
+}
+
+static bool ReadLength(const std::vector<u8>& delta, uint& offset, uint& length) {
+    length = 0;
+
+    for (uint shift = 0; (shift < 32) && (offset < delta.size()); shift += 7) {
+        auto byte = delta[offset++];
+        length |= UINT(byte & 0x7f) << shift;
+
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Snapshot::EncodeDelta(const Snapshot& base, const Snapshot& target, std::vector<u8>& delta) {
+    auto baseData   = base.buffer.data();
+    auto targetData = target.buffer.data();
+    auto commonSize = std::min(base.size, target.size);
+
+    delta.clear();
+
+    for (uint shift = 0; shift < 32; shift += 8) {
+        delta.push_back(U8(target.size >> shift));
+    }
+
+    uint offset = 0;
+
+    while (offset < target.size) {
+        auto unchangedStart = offset;
+
+        // Skip unchanged words first, snapshots of consecutive frames are mostly identical.
+        while ((offset + sizeof(u64) <= commonSize) && (memcmp(baseData + offset, targetData + offset, sizeof(u64)) == 0)) {
+            offset += sizeof(u64);
+        }
+
+        while ((offset < commonSize) && (baseData[offset] == targetData[offset])) {
+            offset++;
+        }
+
+        if (offset >= target.size) {
+            break;
+        }
+
+        auto changedStart = offset;
+        auto equalBytes   = 0u;
+
+        // Past the end of the base every byte is a changed one.
+        while ((offset < target.size) && (equalBytes < MinimumUnchangedRun)) {
+            equalBytes = (offset < commonSize) && (baseData[offset] == targetData[offset]) ? equalBytes + 1 : 0;
+            offset++;
+        }
+
+        if (equalBytes >= MinimumUnchangedRun) {
+            offset -= equalBytes;
+        }
+
+        WriteLength(delta, changedStart - unchangedStart);
+        WriteLength(delta, offset - changedStart);
+
+        for (auto byteOffset = changedStart; byteOffset < offset; byteOffset++) {
+            delta.push_back(targetData[byteOffset] ^ (byteOffset < commonSize ? baseData[byteOffset] : 0));
+        }
+    }
+}
+
+bool Snapshot::DecodeDelta(const Snapshot& base, const std::vector<u8>& delta, Snapshot& target) {
+    if (delta.size() < sizeof(u32)) {
+        ERROR(Txt::InvalidDelta, delta.size());
+        return false;
+    }
+
+    uint targetSize = 0;
+
+    for (uint shift = 0; shift < 32; shift += 8) {
+        targetSize |= UINT(delta[shift / 8]) << shift;
+    }
+
+    target.size       = 0;
+    target.readOffset = 0;
+    target.Reserve(targetSize);
+
+    auto baseData    = base.buffer.data();
+    auto targetData  = target.buffer.data();
+    auto commonSize  = std::min(base.size, targetSize);
+    uint deltaOffset = sizeof(u32);
+    uint offset      = 0;
+
+    while (deltaOffset < delta.size()) {
+        uint unchangedLength, changedLength;
+
+        // The lengths come from the wire, the sums are taken in 64 bits so a crafted length can not wrap past a bound.
+        if (!ReadLength(delta, deltaOffset, unchangedLength) || !ReadLength(delta, deltaOffset, changedLength) || (U64(offset) + unchangedLength + changedLength > targetSize) || (U64(deltaOffset) + changedLength > delta.size()) || (U64(offset) + unchangedLength > commonSize)) {
+            ERROR(Txt::InvalidDelta, delta.size());
+            return false;
+        }
+
+        memcpy(targetData + offset, baseData + offset, unchangedLength);
+        offset += unchangedLength;
+
+        for (uint byteIndex = 0; byteIndex < changedLength; byteIndex++, offset++) {
+            targetData[offset] = delta[deltaOffset++] ^ (offset < commonSize ? baseData[offset] : 0);
+        }
+    }
+
+    if (offset < targetSize) {
+        if (targetSize > commonSize) {
+            ERROR(Txt::InvalidDelta, delta.size());
+            return false;
+        }
+
+        memcpy(targetData + offset, baseData + offset, targetSize - offset);
+    }
+
+    target.size = targetSize;
+    return true;
+}
+
+}    // namespace Biq
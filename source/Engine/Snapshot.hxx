@@ -0,0 +1,83 @@
+/*
+ * Source/Engine/Snapshot.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_SNAPSHOT_HXX
+#define BIQ_SNAPSHOT_HXX
+
+#include "Engine/Types.hxx"
+
+#include <cstring>
+
+namespace Biq {
+
+// Snapshots are flat binary buffers: a small header followed by whatever the owner writes, in the same order it will be
+// read back. Values are copied as they are in memory (native endianness), so snapshots are meant for the running
+// build (save and restore, rewind, re-simulation), not for files shared between platforms.
+//
+// Deltas XOR a snapshot against a previous one and store the runs of changed bytes, so they stay small as long as
+// both snapshots keep their fields at the same offsets (fixed size records, stable ordering).
+
+class Snapshot {
+    public:
+        // Constants
+
+        static constexpr charconst Tag          = "Snapshot";
+        static constexpr u32       Magic        = 0x53514942;
+        static constexpr u32       Version      = 1;
+        static constexpr uint      InitialSize  = 4096;
+
+        struct Header {
+            u32 magic;
+            u32 version;
+            u32 size;
+            u32 contentVersion;
+        };
+
+        Snapshot();
+
+        // Writing
+
+        void Begin(const u32 contentVersion);
+        void End();
+        void WriteBytes(const void* bytes, const uint numberOfBytes);
+
+        template <typename T> void Write(const T& value) {
+            WriteBytes(&value, sizeof(T));
+        }
+
+        // Reading
+
+        bool Open(const u32 contentVersion) const;
+        bool ReadBytes(void* bytes, const uint numberOfBytes) const;
+
+        template <typename T> bool Read(T& value) const {
+            return ReadBytes(&value, sizeof(T));
+        }
+
+        // Contents
+
+        void      SetData(const void* bytes, const uint numberOfBytes);
+        const u8* GetData() const;
+        uint      GetSize() const;
+        bool      IsEqual(const Snapshot& snapshot) const;
+
+        // Deltas (the target must be another snapshot than the base)
+
+        static void EncodeDelta(const Snapshot& base, const Snapshot& target, std::vector<u8>& delta);
+        static bool DecodeDelta(const Snapshot& base, const std::vector<u8>& delta, Snapshot& target);
+
+    private:
+        std::vector<u8> buffer;
+        uint            size;
+        mutable uint    readOffset;
+
+        void Reserve(const uint numberOfBytes);
+};
+
+}    // namespace Biq
+
+#endif    // BIQ_SNAPSHOT_HXX
@@ -7,6 +7,7 @@
 
 #include "Engine/Engine.hxx"
 #include "Engine/Sound.hxx"
+#include "Engine/Startup.hxx"
 
 namespace Biq {
 
@@ -24,34 +25,69 @@ namespace Txt {
     static const charconst MusicUnloaded    = "Music unloaded";
 }
 
+// Static Members
+
+std::thread       Sound::initializationWorker;
+std::mutex        Sound::initializationMutex;
+std::atomic<bool> Sound::isReady(false);
+
 // General
 
 bool Sound::Initialize() {
     DEBUG(Txt::Initializing);
 
-    if (SDL_Init(SDL_INIT_AUDIO) != 0) {
+    isReady = false;
+
+    // SDL's subsystem counts are not thread safe, only opening the device is left to the worker.
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
         ERROR(Txt::CouldNotInitializeSound, SDL_GetError());
         return false;
     }
 
-    if (Mix_OpenAudio(48000, MIX_DEFAULT_FORMAT, 2, 2048) != 0) {
-        ERROR(Txt::CouldNotInitializeSDLMixer, Mix_GetError());
-        return false;
-    }
+    initializationWorker = std::thread(OpenDevice);
 
-    DEBUG(Txt::Initialized);
     return true;
 }
 
 void Sound::Finalize() {
     DEBUG(Txt::Finalizing);
+
+    WaitUntilReady();
     SDL_QuitSubSystem(SDL_INIT_AUDIO);
+
     DEBUG(Txt::Finalized);
 }
 
+bool Sound::WaitUntilReady() {
+    initializationMutex.lock();
+
+    if (initializationWorker.joinable()) {
+        initializationWorker.join();
+    }
+
+    initializationMutex.unlock();
+    return isReady;
+}
+
+void Sound::OpenDevice() {
+    Startup::Phase startupPhase("Audio device");
+
+    if (Mix_OpenAudio(48000, MIX_DEFAULT_FORMAT, 2, 2048) != 0) {
+        ERROR(Txt::CouldNotInitializeSDLMixer, Mix_GetError());
+        return;
+    }
+
+    isReady = true;
+    DEBUG(Txt::Initialized);
+}
+
 // Samples
 
 void* Sound::LoadSample(const std::string& filePath) {
+    if (!WaitUntilReady()) {
+        return NULL;
+    }
+
     auto sample = Mix_LoadWAV(filePath.c_str());
 
     if (sample == NULL) {
@@ -82,6 +118,10 @@ void Sound::PlaySample(void* sample) {
 // Music
 
 void* Sound::LoadMusic(const std::string& filePath) {
+    if (!WaitUntilReady()) {
+        return NULL;
+    }
+
     auto music = Mix_LoadMUS(filePath.c_str());
 
     if (music == NULL) {
@@ -26,8 +26,11 @@ class Sound {
 
         // General
 
+        // Must be called from the main thread before any other thread uses SDL. The audio device is opened by a worker
+        // thread (sound servers can take a while to answer), loading samples and music waits for it.
         static bool Initialize();
         static void Finalize();
+        static bool WaitUntilReady();
 
         // Samples
 
@@ -44,6 +47,13 @@ class Sound {
 
     protected:
         Sound() = delete;
+
+    private:
+        static std::thread       initializationWorker;
+        static std::mutex        initializationMutex;
+        static std::atomic<bool> isReady;
+
+        static void OpenDevice();
 };
 
 } // namespace Biq
@@ -0,0 +1,355 @@
+/*
+ * Source/Engine/Spectator.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/Spectator.hxx"
+
+#include "Engine/Engine.hxx"
+#include "Engine/Telemetry.hxx"
+#include "Engine/World.hxx"
+
+#ifdef LinuxOS
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+namespace Biq {
+
+// String Table
+
+namespace Txt {
+static const charconst CouldNotOpenSocket    = "Could not open the spectator socket \"%s\"";
+static const charconst SpectatorNotSupported = "The spectator stream is not supported on this platform";
+static const charconst TooManySubscribers    = "Refusing a subscriber, there are already %d";
+static const charconst TooManyValues         = "Could not register the value \"%s\", there are too many values";
+static const charconst StreamingSpectators   = "Streaming the world to \"%s\"";
+static const charconst SubscriberJoined      = "Subscriber joined (%d connected)";
+static const charconst SubscriberLeft        = "Subscriber left (%d connected)";
+}    // namespace Txt
+
+// Static Members
+
+int                                Spectator::listenSocket     = -1;
+string                             Spectator::socketPath;
+std::vector<Spectator::Subscriber> Spectator::subscribers;
+Snapshot                           Spectator::states[2];
+uint                               Spectator::currentState     = 0;
+bool                               Spectator::hasPreviousState = false;
+std::vector<u8>                    Spectator::delta;
+u32                                Spectator::frame            = 0;
+
+std::map<const Image*, int> Spectator::imageIndexes;
+std::vector<string>         Spectator::imagePaths;
+std::vector<string>         Spectator::valueNames;
+std::vector<i32>            Spectator::values;
+
+uint Spectator::subscribersMetric   = Telemetry::InvalidMetric;
+uint Spectator::bytesSentMetric     = Telemetry::InvalidMetric;
+uint Spectator::skippedFramesMetric = Telemetry::InvalidMetric;
+
+// General
+
+bool Spectator::Open(const string& path) {
+#ifdef LinuxOS
+    if (listenSocket >= 0) {
+        return true;
+    }
+
+    sockaddr_un address = {};
+    address.sun_family  = AF_UNIX;
+
+    if (path.size() >= sizeof(address.sun_path)) {
+        ERROR(Txt::CouldNotOpenSocket, path.c_str());
+        return false;
+    }
+
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    unlink(path.c_str());
+
+    listenSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if ((listenSocket < 0) || (bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) || (listen(listenSocket, Spectator::MaxSubscribers) != 0)) {
+        ERROR(Txt::CouldNotOpenSocket, path.c_str());
+        Close();
+        return false;
+    }
+
+    socketPath = path;
+
+    subscribersMetric   = Telemetry::RegisterGauge("Spectator.Subscribers");
+    bytesSentMetric     = Telemetry::RegisterCounter("Spectator.BytesSent");
+    skippedFramesMetric = Telemetry::RegisterCounter("Spectator.SkippedFrames");
+
+    INFO(Txt::StreamingSpectators, path.c_str());
+    return true;
+#else
+    WARNING(Txt::SpectatorNotSupported);
+    return false;
+#endif
+}
+
+void Spectator::Close() {
+#ifdef LinuxOS
+    for (auto& subscriber : subscribers) {
+        close(subscriber.socket);
+    }
+
+    subscribers.clear();
+
+    if (listenSocket >= 0) {
+        close(listenSocket);
+        unlink(socketPath.c_str());
+        listenSocket = -1;
+    }
+
+    hasPreviousState = false;
+#endif
+}
+
+bool Spectator::IsOpen() {
+    return listenSocket >= 0;
+}
+
+void Spectator::Publish() {
+#ifdef LinuxOS
+    if (listenSocket < 0) {
+        return;
+    }
+
+    AcceptSubscribers();
+
+    // Nothing is encoded while nobody is watching, the next subscriber starts from a keyframe anyway.
+    if (subscribers.empty()) {
+        hasPreviousState = false;
+        return;
+    }
+
+    auto& state         = states[currentState];
+    auto& previousState = states[currentState ^ 1];
+
+    frame++;
+    EncodeState(state);
+
+    auto hasDelta = hasPreviousState && ((frame % Spectator::KeyframeInterval) != 0);
+
+    if (hasDelta) {
+        Snapshot::EncodeDelta(previousState, state, delta);
+    }
+
+    auto subscriberIterator = subscribers.begin();
+    while (subscriberIterator != subscribers.end()) {
+        auto& subscriber = *subscriberIterator;
+        auto  isAlive    = Flush(subscriber);
+
+        if (isAlive && subscriber.pending.empty()) {
+            auto isKeyframe = !hasDelta || subscriber.needsKeyframe;
+
+            FrameHeader header = { Spectator::Magic, U32(isKeyframe ? Keyframe : DeltaFrame), frame, isKeyframe ? state.GetSize() : UINT(delta.size()) };
+
+            isAlive                  = Send(subscriber, header, isKeyframe ? state.GetData() : delta.data());
+            subscriber.needsKeyframe = false;
+        } else if (isAlive) {
+            // It still has part of an older frame to take, the next frame it gets must not depend on this one.
+            subscriber.needsKeyframe = true;
+            Telemetry::Add(skippedFramesMetric, 1);
+        }
+
+        if (!isAlive) {
+            close(subscriber.socket);
+            subscriberIterator = subscribers.erase(subscriberIterator);
+            INFO(Txt::SubscriberLeft, subscribers.size());
+            continue;
+        }
+
+        subscriberIterator++;
+    }
+
+    Telemetry::Set(subscribersMetric, subscribers.size());
+
+    currentState ^= 1;
+    hasPreviousState = true;
+#endif
+}
+
+// Values
+
+uint Spectator::RegisterValue(const charconst valueName) {
+    for (uint valueIndex = 0; valueIndex < valueNames.size(); valueIndex++) {
+        if (valueNames[valueIndex] == valueName) {
+            return valueIndex;
+        }
+    }
+
+    if (valueNames.size() >= Spectator::MaxValues) {
+        WARNING(Txt::TooManyValues, valueName);
+        return UINT(-1);
+    }
+
+    valueNames.push_back(valueName);
+    values.push_back(0);
+    return valueNames.size() - 1;
+}
+
+void Spectator::SetValue(const uint valueIndex, const i32 value) {
+    if (valueIndex < values.size()) {
+        values[valueIndex] = value;
+    }
+}
+
+// Encoding
+
+void Spectator::EncodeState(Snapshot& state) {
+    auto& layers = World::GetLayers();
+
+    state.Begin(Spectator::Version);
+    state.Write(frame);
+
+    state.Write(U32(values.size()));
+    state.WriteBytes(values.data(), values.size() * sizeof(i32));
+
+    state.Write(U32(layers.size()));
+
+    // Positions are sent as drawn, the viewer does not need the camera. Dormant objects are not sent.
+    for (auto layer : layers) {
+        auto offset = layer->scrolls ? World::GetCamera() : Vector2D { 0.0f, 0.0f };
+
+        state.Write(I32(ImageIndex(layer->background)));
+        state.Write(U32(layer->objects.size()));
+
+        for (auto object : layer->objects) {
+            Vector2D position = { object->position.x - offset.x, object->position.y - offset.y };
+
+            state.Write(I32(ImageIndex(object->image)));
+            state.Write(I32(ImageIndex(object->mask)));
+            state.Write(object->tint);
+            state.Write(position);
+            state.Write(object->size);
+        }
+    }
+
+    state.Write(U32(imagePaths.size()));
+
+    for (auto& imagePath : imagePaths) {
+        state.Write(U16(imagePath.size()));
+        state.WriteBytes(imagePath.data(), imagePath.size());
+    }
+
+    state.Write(U32(valueNames.size()));
+
+    for (auto& valueName : valueNames) {
+        state.Write(U16(valueName.size()));
+        state.WriteBytes(valueName.data(), valueName.size());
+    }
+
+    state.End();
+}
+
+int Spectator::ImageIndex(const Image* image) {
+    if ((image == NULL) || image->path.empty()) {
+        return -1;
+    }
+
+    // Images are matched by address, checking the path catches an address reused by another image.
+    auto imageIndex = imageIndexes.find(image);
+
+    if ((imageIndex != imageIndexes.end()) && (imagePaths[imageIndex->second] == image->path)) {
+        return imageIndex->second;
+    }
+
+    auto pathIndex = std::find(imagePaths.begin(), imagePaths.end(), image->path);
+
+    if (pathIndex == imagePaths.end()) {
+        pathIndex = imagePaths.insert(imagePaths.end(), image->path);
+    }
+
+    return imageIndexes[image] = pathIndex - imagePaths.begin();
+}
+
+// Subscribers
+
+void Spectator::AcceptSubscribers() {
+#ifdef LinuxOS
+    int subscriberSocket;
+
+    while ((subscriberSocket = accept4(listenSocket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        if (subscribers.size() >= Spectator::MaxSubscribers) {
+            WARNING(Txt::TooManySubscribers, subscribers.size());
+            close(subscriberSocket);
+            continue;
+        }
+
+        subscribers.push_back({ subscriberSocket, true, std::vector<u8>() });
+        INFO(Txt::SubscriberJoined, subscribers.size());
+    }
+#endif
+}
+
+bool Spectator::Flush(Subscriber& subscriber) {
+#ifdef LinuxOS
+    if (subscriber.pending.empty()) {
+        return true;
+    }
+
+    auto sentBytes = send(subscriber.socket, subscriber.pending.data(), subscriber.pending.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+
+    if (sentBytes < 0) {
+        return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR);
+    }
+
+    subscriber.pending.erase(subscriber.pending.begin(), subscriber.pending.begin() + sentBytes);
+    Telemetry::Add(bytesSentMetric, sentBytes);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Spectator::Send(Subscriber& subscriber, const FrameHeader& header, const u8* payload) {
+#ifdef LinuxOS
+    // Header and payload go straight from the shared buffers, only what the socket could not take is copied.
+    iovec parts[2] = {
+        { const_cast<FrameHeader*>(&header), sizeof(FrameHeader) },
+        { const_cast<u8*>(payload), header.size },
+    };
+
+    msghdr message     = {};
+    message.msg_iov    = parts;
+    message.msg_iovlen = 2;
+
+    auto sentBytes = sendmsg(subscriber.socket, &message, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+    if (sentBytes < 0) {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+            return false;
+        }
+
+        sentBytes = 0;
+    }
+
+    Telemetry::Add(bytesSentMetric, sentBytes);
+
+    auto headerBytes = UINT(sentBytes) < sizeof(FrameHeader) ? UINT(sentBytes) : UINT(sizeof(FrameHeader));
+    auto payloadSent = UINT(sentBytes) - headerBytes;
+
+    if (headerBytes < sizeof(FrameHeader)) {
+        subscriber.pending.insert(subscriber.pending.end(), reinterpret_cast<const u8*>(&header) + headerBytes, reinterpret_cast<const u8*>(&header) + sizeof(FrameHeader));
+    }
+
+    if (payloadSent < header.size) {
+        subscriber.pending.insert(subscriber.pending.end(), payload + payloadSent, payload + header.size);
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+}    // namespace Biq
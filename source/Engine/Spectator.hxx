@@ -0,0 +1,100 @@
+/*
+ * Source/Engine/Spectator.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_SPECTATOR_HXX
+#define BIQ_SPECTATOR_HXX
+
+#include "Engine/Snapshot.hxx"
+
+namespace Biq {
+
+// The spectator stream sends the world after every simulation step to the subscribers of a local Unix socket. Each
+// message is a FrameHeader followed by either a full state (keyframe) or a Snapshot delta against the previous frame.
+//
+// A state is a Snapshot (content version Spectator::Version) holding, in order: the frame number, the values (i32
+// each), the layers (background image index, number of objects and then image index, mask image index, tint, position
+// and size for each object), the image paths and the value names. Image indexes are -1 for images that were not loaded
+// from a file. Paths and names go last so new ones do not move the objects around in the deltas.
+//
+// Frames are encoded once and sent from the same buffers to every subscriber, without blocking. A subscriber that
+// could not take a whole frame keeps the rest of it and skips frames until it is flushed, then gets a keyframe.
+
+class Spectator {
+    public:
+        ~Spectator() = default;
+
+        // Constants
+
+        static constexpr charconst Tag              = "Spectator";
+        static constexpr u32       Magic            = 0x56514942;
+        static constexpr u32       Version          = 2;
+        static constexpr uint      MaxSubscribers   = 16;
+        static constexpr uint      MaxValues        = 8;
+        static constexpr uint      KeyframeInterval = 600;
+
+        enum FrameType {
+            Keyframe = 0,
+            DeltaFrame
+        };
+
+        struct FrameHeader {
+            u32 magic;
+            u32 type;
+            u32 frame;
+            u32 size;
+        };
+
+        // General
+
+        static bool Open(const string& path);
+        static void Close();
+        static bool IsOpen();
+        static void Publish();
+
+        // Values (game specific numbers, like the score)
+
+        static uint RegisterValue(const charconst valueName);
+        static void SetValue(const uint valueIndex, const i32 value);
+
+    protected:
+        Spectator() = delete;
+
+    private:
+        struct Subscriber {
+            int             socket;
+            bool            needsKeyframe;
+            std::vector<u8> pending;
+        };
+
+        static int                     listenSocket;
+        static string                  socketPath;
+        static std::vector<Subscriber> subscribers;
+        static Snapshot                states[2];
+        static uint                    currentState;
+        static bool                    hasPreviousState;
+        static std::vector<u8>         delta;
+        static u32                     frame;
+
+        static std::map<const Image*, int> imageIndexes;
+        static std::vector<string>         imagePaths;
+        static std::vector<string>         valueNames;
+        static std::vector<i32>            values;
+
+        static uint subscribersMetric;
+        static uint bytesSentMetric;
+        static uint skippedFramesMetric;
+
+        static void AcceptSubscribers();
+        static void EncodeState(Snapshot& state);
+        static int  ImageIndex(const Image* image);
+        static bool Flush(Subscriber& subscriber);
+        static bool Send(Subscriber& subscriber, const FrameHeader& header, const u8* payload);
+};
+
+}    // namespace Biq
+
+#endif    // BIQ_SPECTATOR_HXX
@@ -0,0 +1,123 @@
+/*
+ * Source/Engine/Startup.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/Startup.hxx"
+
+#include "Engine/Engine.hxx"
+
+namespace Biq {
+
+// String Table
+
+namespace Txt {
+static const charconst TimelineHeader = "%-24s %-6s %9s %9s %9s";
+static const charconst TimelinePhase  = "%-24s %-6s %9.2f %9.2f %9.2f";
+static const charconst PhaseRunning   = "%-24s %-6s %9.2f   (still running)";
+static const charconst FirstFrame     = "First frame presented after %.2f ms, the workers took %.2f ms off the main thread";
+static const charconst MainThread     = "main";
+static const charconst WorkerThread   = "worker";
+}    // namespace Txt
+
+// Static Members
+
+std::mutex           Startup::mutex;
+Startup::PhaseRecord Startup::phases[Startup::MaxPhases];
+uint                 Startup::numberOfPhases = 0;
+f64                  Startup::startTime      = 0.0;
+std::thread::id      Startup::mainThreadId;
+std::atomic<bool>    Startup::isFinished(true);
+
+// General
+
+void Startup::Begin() {
+    mutex.lock();
+
+    numberOfPhases = 0;
+    startTime      = Engine::GetPreciseTicks();
+    mainThreadId   = std::this_thread::get_id();
+    isFinished     = false;
+
+    mutex.unlock();
+}
+
+void Startup::FirstFrame() {
+    if (isFinished) {
+        return;
+    }
+
+    mutex.lock();
+
+    auto frameTime  = Engine::GetPreciseTicks() - startTime;
+    f64  workerTime = 0.0;
+
+    isFinished = true;
+
+    INFO(Txt::TimelineHeader, "Phase", "Thread", "Start", "End", "Duration");
+
+    // Phases get their index when they start, so they are already in order.
+    for (uint phaseIndex = 0; phaseIndex < numberOfPhases; phaseIndex++) {
+        auto& phase      = phases[phaseIndex];
+        auto  threadName = phase.isMainThread ? Txt::MainThread : Txt::WorkerThread;
+        auto  phaseStart = phase.startTime - startTime;
+
+        if (phase.endTime <= 0.0) {
+            INFO(Txt::PhaseRunning, phase.name, threadName, phaseStart);
+            continue;
+        }
+
+        auto phaseDuration = phase.endTime - phase.startTime;
+
+        workerTime += phase.isMainThread ? 0.0 : phaseDuration;
+
+        INFO(Txt::TimelinePhase, phase.name, threadName, phaseStart, phase.endTime - startTime, phaseDuration);
+    }
+
+    INFO(Txt::FirstFrame, frameTime, workerTime);
+
+    mutex.unlock();
+}
+
+bool Startup::IsFinished() {
+    return isFinished;
+}
+
+// Phases
+
+uint Startup::BeginPhase(const charconst name) {
+    if (isFinished) {
+        return Startup::MaxPhases;
+    }
+
+    mutex.lock();
+
+    auto phaseIndex = numberOfPhases;
+
+    if (phaseIndex < Startup::MaxPhases) {
+        phases[phaseIndex] = { name, std::this_thread::get_id() == mainThreadId, Engine::GetPreciseTicks(), 0.0 };
+        numberOfPhases++;
+    }
+
+    mutex.unlock();
+    return phaseIndex;
+}
+
+void Startup::EndPhase(const uint phaseIndex) {
+    if (phaseIndex >= Startup::MaxPhases) {
+        return;
+    }
+
+    mutex.lock();
+
+    // Phases that outlive the report are simply left out of it.
+    if (!isFinished) {
+        phases[phaseIndex].endTime = Engine::GetPreciseTicks();
+    }
+
+    mutex.unlock();
+}
+
+}    // namespace Biq
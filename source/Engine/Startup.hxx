@@ -0,0 +1,74 @@
+/*
+ * Source/Engine/Startup.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_STARTUP_HXX
+#define BIQ_STARTUP_HXX
+
+#include "Engine/Types.hxx"
+
+namespace Biq {
+
+// Startup timeline: the engine brings its parts up on several threads at once (window, audio device, fonts, the first
+// state), each part records when it started and finished. The timeline is logged once the first frame is presented,
+// phases from any thread can be recorded until then.
+
+class Startup {
+    public:
+        ~Startup() = default;
+
+        // Constants
+
+        static constexpr charconst Tag       = "Startup";
+        static constexpr uint      MaxPhases = 32;
+
+        // Phases
+
+        class Phase {
+            public:
+                explicit Phase(const charconst name) :
+                    phaseIndex(Startup::BeginPhase(name)) {
+                }
+
+                ~Phase() {
+                    Startup::EndPhase(phaseIndex);
+                }
+
+            private:
+                uint phaseIndex;
+        };
+
+        // General
+
+        static void Begin();
+        static void FirstFrame();
+        static bool IsFinished();
+
+        static uint BeginPhase(const charconst name);
+        static void EndPhase(const uint phaseIndex);
+
+    protected:
+        Startup() = delete;
+
+    private:
+        struct PhaseRecord {
+            charconst name;
+            bool      isMainThread;
+            f64       startTime;
+            f64       endTime;
+        };
+
+        static std::mutex        mutex;
+        static PhaseRecord       phases[MaxPhases];
+        static uint              numberOfPhases;
+        static f64               startTime;
+        static std::thread::id   mainThreadId;
+        static std::atomic<bool> isFinished;
+};
+
+}    // namespace Biq
+
+#endif    // BIQ_STARTUP_HXX
@@ -0,0 +1,202 @@
+/*
+ * Source/Engine/Telemetry.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/Telemetry.hxx"
+
+#include "Engine/Engine.hxx"
+
+#include <cstring>
+#include <new>
+
+#ifdef LinuxOS
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+namespace Biq {
+
+// String Table
+
+namespace Txt {
+static const charconst CouldNotOpenTelemetryFile = "Could not open the telemetry file \"%s\"";
+static const charconst CouldNotMapTelemetryFile  = "Could not map the telemetry file \"%s\"";
+static const charconst TelemetryNotSupported     = "Telemetry publishing is not supported on this platform";
+static const charconst TooManyMetrics            = "Could not register the metric \"%s\", there are too many metrics";
+static const charconst PublishingTelemetry       = "Publishing telemetry to \"%s\"";
+}    // namespace Txt
+
+// Static Members
+
+Telemetry::Page          Telemetry::page;
+Telemetry::SharedHeader* Telemetry::sharedHeader    = NULL;
+Telemetry::Page*         Telemetry::sharedPage      = NULL;
+int                      Telemetry::sharedFile      = -1;
+uint                     Telemetry::lastPublishTick = 0;
+
+// General
+
+bool Telemetry::Open(const string& filePath) {
+#ifdef LinuxOS
+    if (sharedHeader != NULL) {
+        return true;
+    }
+
+    auto mappingSize = sizeof(SharedHeader) + sizeof(Page);
+
+    sharedFile = open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if ((sharedFile < 0) || (ftruncate(sharedFile, mappingSize) != 0)) {
+        ERROR(Txt::CouldNotOpenTelemetryFile, filePath.c_str());
+        Close();
+        return false;
+    }
+
+    auto mapping = mmap(NULL, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, sharedFile, 0);
+
+    if (mapping == MAP_FAILED) {
+        ERROR(Txt::CouldNotMapTelemetryFile, filePath.c_str());
+        Close();
+        return false;
+    }
+
+    sharedHeader = new (mapping) SharedHeader();
+    sharedPage   = reinterpret_cast<Page*>(DATA(mapping) + sizeof(SharedHeader));
+
+    sharedHeader->version  = Telemetry::Version;
+    sharedHeader->pageSize = sizeof(Page);
+    sharedHeader->sequence.store(0, std::memory_order_relaxed);
+
+    // Readers check the magic number last, so they never see a half initialized header.
+    std::atomic_thread_fence(std::memory_order_release);
+    sharedHeader->magic = Telemetry::Magic;
+
+    INFO(Txt::PublishingTelemetry, filePath.c_str());
+    return true;
+#else
+    WARNING(Txt::TelemetryNotSupported);
+    return false;
+#endif
+}
+
+void Telemetry::Close() {
+#ifdef LinuxOS
+    if (sharedHeader != NULL) {
+        munmap(sharedHeader, sizeof(SharedHeader) + sizeof(Page));
+        sharedHeader = NULL;
+        sharedPage   = NULL;
+    }
+
+    if (sharedFile >= 0) {
+        close(sharedFile);
+        sharedFile = -1;
+    }
+#endif
+}
+
+void Telemetry::Publish() {
+    page.frame++;
+
+    if (sharedHeader == NULL) {
+        return;
+    }
+
+    auto currentTick = Engine::GetTicks();
+
+    if (currentTick - lastPublishTick < Telemetry::PublishInterval) {
+        return;
+    }
+
+    lastPublishTick  = currentTick;
+    page.publishTime = currentTick;
+
+    // There is a single writer (the game loop), so it never waits: it only bumps the sequence around the copy.
+    auto sequence = sharedHeader->sequence.load(std::memory_order_relaxed);
+
+    sharedHeader->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(sharedPage, &page, sizeof(Page));
+
+    std::atomic_thread_fence(std::memory_order_release);
+    sharedHeader->sequence.store(sequence + 2, std::memory_order_relaxed);
+}
+
+// Metrics
+
+uint Telemetry::RegisterCounter(const charconst metricName) {
+    return RegisterMetric(metricName, Telemetry::Counter);
+}
+
+uint Telemetry::RegisterGauge(const charconst metricName) {
+    return RegisterMetric(metricName, Telemetry::Gauge);
+}
+
+uint Telemetry::RegisterHistogram(const charconst metricName) {
+    return RegisterMetric(metricName, Telemetry::Histogram);
+}
+
+void Telemetry::Add(const uint metricIndex, const i64 amount) {
+    if (metricIndex < page.numberOfMetrics) {
+        page.metrics[metricIndex].value += amount;
+    }
+}
+
+void Telemetry::Set(const uint metricIndex, const i64 value) {
+    if (metricIndex < page.numberOfMetrics) {
+        page.metrics[metricIndex].value = value;
+    }
+}
+
+void Telemetry::Record(const uint metricIndex, const u64 value) {
+    if ((metricIndex >= page.numberOfMetrics) || (page.metrics[metricIndex].kind != Telemetry::Histogram)) {
+        return;
+    }
+
+    auto& histogram = page.histograms[page.metrics[metricIndex].histogramIndex];
+
+    if ((histogram.count == 0) || (value < histogram.minValue)) {
+        histogram.minValue = value;
+    }
+
+    if (value > histogram.maxValue) {
+        histogram.maxValue = value;
+    }
+
+    histogram.count++;
+    histogram.sum += value;
+    histogram.buckets[BucketIndex(value)]++;
+
+    page.metrics[metricIndex].value = histogram.count;
+}
+
+uint Telemetry::RegisterMetric(const charconst metricName, const Kind metricKind) {
+    for (uint metricIndex = 0; metricIndex < page.numberOfMetrics; metricIndex++) {
+        if (strncmp(page.metrics[metricIndex].name, metricName, Telemetry::MaxNameLength - 1) == 0) {
+            return metricIndex;
+        }
+    }
+
+    if ((page.numberOfMetrics >= Telemetry::MaxMetrics) || ((metricKind == Telemetry::Histogram) && (page.numberOfHistograms >= Telemetry::MaxHistograms))) {
+        WARNING(Txt::TooManyMetrics, metricName);
+        return Telemetry::InvalidMetric;
+    }
+
+    auto& metric = page.metrics[page.numberOfMetrics];
+
+    strncpy(metric.name, metricName, Telemetry::MaxNameLength - 1);
+    metric.kind  = metricKind;
+    metric.value = 0;
+
+    if (metricKind == Telemetry::Histogram) {
+        metric.histogramIndex = page.numberOfHistograms++;
+    }
+
+    return page.numberOfMetrics++;
+}
+
+}    // namespace Biq
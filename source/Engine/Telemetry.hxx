@@ -0,0 +1,138 @@
+/*
+ * Source/Engine/Telemetry.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_TELEMETRY_HXX
+#define BIQ_TELEMETRY_HXX
+
+#include "Engine/Types.hxx"
+
+namespace Biq {
+
+// Telemetry
+
+class Telemetry {
+    public:
+        ~Telemetry() = default;
+
+        // Constants
+
+        static constexpr charconst Tag             = "Telemetry";
+        static constexpr u32       Magic           = 0x54514942;    // "BIQT"
+        static constexpr u32       Version         = 1;
+        static constexpr uint      MaxMetrics      = 64;
+        static constexpr uint      MaxHistograms   = 8;
+        static constexpr uint      MaxNameLength   = 40;
+        static constexpr uint      PublishInterval = 50;
+        static constexpr uint      InvalidMetric   = UINT(-1);
+
+        // Histograms are log-linear (HDR style): values below SubBuckets are exact, above that every power of two is
+        // split into SubBuckets linear buckets, which keeps the relative error under 1 / SubBuckets.
+
+        static constexpr uint SubBucketBits    = 4;
+        static constexpr uint SubBuckets       = 1 << SubBucketBits;
+        static constexpr uint MaxValueBits     = 32;
+        static constexpr uint HistogramBuckets = (MaxValueBits - SubBucketBits + 1) * SubBuckets;
+
+        enum Kind {
+            Counter = 0,
+            Gauge,
+            Histogram
+        };
+
+        // Shared Layout
+
+        struct Metric {
+            char name[MaxNameLength];
+            u32  kind;
+            u32  histogramIndex;
+            i64  value;
+        };
+
+        struct HistogramData {
+            u64 count;
+            u64 sum;
+            u64 minValue;
+            u64 maxValue;
+            u64 buckets[HistogramBuckets];
+        };
+
+        struct Page {
+            u64           frame;
+            u64           publishTime;
+            u32           numberOfMetrics;
+            u32           numberOfHistograms;
+            Metric        metrics[MaxMetrics];
+            HistogramData histograms[MaxHistograms];
+        };
+
+        // The page is published with a sequence lock: the sequence is odd while the writer is copying, readers retry
+        // whenever it is odd or changed while they were reading.
+
+        struct SharedHeader {
+            u32               magic;
+            u32               version;
+            u32               pageSize;
+            u32               reserved;
+            std::atomic<u64>  sequence;
+        };
+
+        // General
+
+        static bool Open(const string& filePath);
+        static void Close();
+        static void Publish();
+
+        // Metrics
+
+        static uint RegisterCounter(const charconst metricName);
+        static uint RegisterGauge(const charconst metricName);
+        static uint RegisterHistogram(const charconst metricName);
+
+        static void Add(const uint metricIndex, const i64 amount = 1);
+        static void Set(const uint metricIndex, const i64 value);
+        static void Record(const uint metricIndex, const u64 value);
+
+        // Histogram Buckets
+
+        static uint BucketIndex(u64 value) {
+            if (value < SubBuckets) {
+                return UINT(value);
+            }
+
+            if (value >= (U64(1) << MaxValueBits)) {
+                value = (U64(1) << MaxValueBits) - 1;
+            }
+
+            auto shift = UINT(63 - __builtin_clzll(value)) - SubBucketBits;
+            return ((shift + 1) * SubBuckets) + UINT((value >> shift) - SubBuckets);
+        }
+
+        static u64 BucketValue(const uint bucketIndex) {
+            if (bucketIndex < SubBuckets) {
+                return bucketIndex;
+            }
+
+            auto shift = (bucketIndex / SubBuckets) - 1;
+            return U64(SubBuckets + (bucketIndex % SubBuckets)) << shift;
+        }
+
+    protected:
+        Telemetry() = delete;
+
+    private:
+        static Page          page;
+        static SharedHeader* sharedHeader;
+        static Page*         sharedPage;
+        static int           sharedFile;
+        static uint          lastPublishTick;
+
+        static uint RegisterMetric(const charconst metricName, const Kind metricKind);
+};
+
+}    // namespace Biq
+
+#endif    // BIQ_TELEMETRY_HXX
@@ -0,0 +1,209 @@
+/*
+ * Source/Engine/Timers.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/Timers.hxx"
+
+#include "Engine/Engine.hxx"
+#include "Engine/Telemetry.hxx"
+
+namespace Biq {
+
+// Static Members
+
+Timers::Timer* Timers::wheels[Timers::Levels][Timers::Slots];
+u64            Timers::occupiedSlots[Timers::Levels];
+uint           Timers::currentTick   = 0;
+uint           Timers::pending       = 0;
+uint           Timers::pendingMetric = Telemetry::InvalidMetric;
+uint           Timers::firedMetric   = Telemetry::InvalidMetric;
+
+static inline u64 SlotIndex(const uint tick, const uint level) {
+    return (U64(tick) >> (Timers::SlotBits * level)) & (Timers::Slots - 1);
+}
+
+// General
+
+bool Timers::Initialize() {
+    DEBUG(Txt::Initializing);
+
+    Clear();
+
+    currentTick   = Engine::GetSimulationTicks();
+    pendingMetric = Telemetry::RegisterGauge("Timers.Pending");
+    firedMetric   = Telemetry::RegisterCounter("Timers.Fired");
+
+    DEBUG(Txt::Initialized);
+    return true;
+}
+
+void Timers::Finalize() {
+    DEBUG(Txt::Finalizing);
+    Clear();
+    DEBUG(Txt::Finalized);
+}
+
+void Timers::Advance(const uint simulationTick) {
+    uint fired = 0;
+
+    while (I32(simulationTick - currentTick) > 0) {
+        if (pending == 0) {
+            currentTick = simulationTick;
+            break;
+        }
+
+        // Nothing is due in the rest of this span of the first level, and nothing comes down before it ends.
+        auto spanEnd = currentTick | (Timers::Slots - 1);
+
+        if ((occupiedSlots[0] == 0) && (spanEnd != currentTick)) {
+            currentTick = I32(simulationTick - spanEnd) > 0 ? spanEnd : simulationTick;
+            continue;
+        }
+
+        currentTick++;
+
+        // Every level whose span turned over brings its next slot down, the highest one first.
+        uint topLevel = 0;
+
+        while ((topLevel + 1 < Timers::Levels) && ((U64(currentTick) & ((U64(1) << (Timers::SlotBits * (topLevel + 1))) - 1)) == 0)) {
+            topLevel++;
+        }
+
+        for (auto level = topLevel; level > 0; level--) {
+            Cascade(level);
+        }
+
+        // Callbacks can schedule and cancel timers (these included), so the slot is read again after each one.
+        auto& slot = wheels[0][SlotIndex(currentTick, 0)];
+
+        while (slot != NULL) {
+            auto timer = slot;
+
+            Unlink(*timer);
+            timer->callback(timer->context, timer->argument);
+            fired++;
+        }
+    }
+
+    Telemetry::Set(pendingMetric, pending);
+
+    if (fired > 0) {
+        Telemetry::Add(firedMetric, fired);
+    }
+}
+
+// Scheduling
+
+void Timers::Schedule(Timer& timer, const uint deadline, const Callback callback, void* context, void* argument) {
+    if (timer.IsScheduled()) {
+        Unlink(timer);
+    }
+
+    timer.deadline = I32(deadline - currentTick) > 0 ? deadline : currentTick + 1;
+    timer.callback = callback;
+    timer.context  = context;
+    timer.argument = argument;
+
+    Insert(timer);
+    pending++;
+}
+
+void Timers::Cancel(Timer& timer) {
+    if (timer.IsScheduled()) {
+        Unlink(timer);
+    }
+}
+
+uint Timers::GetCurrentTick() {
+    return currentTick;
+}
+
+uint Timers::GetPending() {
+    return pending;
+}
+
+// Wheels
+
+// A timer goes to the lowest level whose span (from the current tick) still holds its deadline.
+void Timers::Insert(Timer& timer) {
+    uint level = 0;
+
+    while ((level + 1 < Timers::Levels) && ((U64(timer.deadline) >> (Timers::SlotBits * (level + 1))) != (U64(currentTick) >> (Timers::SlotBits * (level + 1))))) {
+        level++;
+    }
+
+    auto  slotIndex = SlotIndex(timer.deadline, level);
+    auto& slot      = wheels[level][slotIndex];
+
+    timer.next  = slot;
+    timer.link  = &slot;
+    timer.level = level;
+
+    if (slot != NULL) {
+        slot->link = &timer.next;
+    }
+
+    slot = &timer;
+    occupiedSlots[level] |= U64(1) << slotIndex;
+}
+
+void Timers::Unlink(Timer& timer) {
+    *timer.link = timer.next;
+
+    if (timer.next != NULL) {
+        timer.next->link = timer.link;
+    }
+
+    auto slotIndex = SlotIndex(timer.deadline, timer.level);
+
+    if (wheels[timer.level][slotIndex] == NULL) {
+        occupiedSlots[timer.level] &= ~(U64(1) << slotIndex);
+    }
+
+    timer.next  = NULL;
+    timer.link  = NULL;
+    timer.level = Timers::NoLevel;
+    pending--;
+}
+
+void Timers::Cascade(const uint level) {
+    auto  slotIndex = SlotIndex(currentTick, level);
+    auto& slot      = wheels[level][slotIndex];
+    auto  timer     = slot;
+
+    slot = NULL;
+    occupiedSlots[level] &= ~(U64(1) << slotIndex);
+
+    while (timer != NULL) {
+        auto next = timer->next;
+
+        Insert(*timer);
+        timer = next;
+    }
+}
+
+void Timers::Clear() {
+    for (auto& level : wheels) {
+        for (auto& slot : level) {
+            while (slot != NULL) {
+                auto timer = slot;
+
+                slot         = timer->next;
+                timer->next  = NULL;
+                timer->link  = NULL;
+                timer->level = Timers::NoLevel;
+            }
+        }
+    }
+
+    for (auto& slots : occupiedSlots) {
+        slots = 0;
+    }
+
+    pending = 0;
+}
+
+}    // namespace Biq
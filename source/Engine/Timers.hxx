@@ -0,0 +1,106 @@
+/*
+ * Source/Engine/Timers.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_TIMERS_HXX
+#define BIQ_TIMERS_HXX
+
+#include "Engine/Types.hxx"
+
+namespace Biq {
+
+// Timers: callbacks scheduled on the simulation clock (milliseconds), fired by the engine at the start of every step in
+// deadline order, so replays and lockstep runs fire them at the same steps.
+//
+// The timers live in a hierarchical wheel: Levels wheels of Slots lists, each level covering Slots times the span of
+// the previous one. Scheduling and cancelling are O(1) and the timers belong to their owners (there is nothing to
+// allocate), a step only touches the slots it goes through and the timers that come due. Timers far in the future move
+// down a level when the clock reaches their slot.
+
+class Timers {
+    public:
+        ~Timers() = default;
+
+        // Constants
+
+        static constexpr charconst Tag      = "Timers";
+        static constexpr uint      SlotBits = 6;
+        static constexpr uint      Slots    = 1 << SlotBits;
+        static constexpr uint      Levels   = 6;
+        static constexpr uint      NoLevel  = UINT(-1);
+
+        typedef void (*Callback)(void* context, void* argument);
+
+        // Timers are usually members of the objects they act on, destroying one cancels it.
+
+        class Timer {
+            public:
+                Timer() :
+                    next(NULL), link(NULL), level(NoLevel), deadline(0), callback(NULL), context(NULL), argument(NULL) {
+                }
+
+                Timer(const Timer&)            = delete;
+                Timer& operator=(const Timer&) = delete;
+
+                ~Timer() {
+                    Timers::Cancel(*this);
+                }
+
+                uint GetDeadline() const {
+                    return deadline;
+                }
+
+                bool IsScheduled() const {
+                    return link != NULL;
+                }
+
+            private:
+                friend class Timers;
+
+                Timer*   next;
+                Timer**  link;
+                uint     level;
+                uint     deadline;
+                Callback callback;
+                void*    context;
+                void*    argument;
+        };
+
+        // General
+
+        static bool Initialize();
+        static void Finalize();
+        static void Advance(const uint simulationTick);
+
+        // Scheduling
+
+        // Deadlines that already passed fire on the next step. Scheduling a timer that is already scheduled moves it.
+        static void Schedule(Timer& timer, const uint deadline, const Callback callback, void* context, void* argument = NULL);
+        static void Cancel(Timer& timer);
+
+        static uint GetCurrentTick();
+        static uint GetPending();
+
+    protected:
+        Timers() = delete;
+
+    private:
+        static Timer* wheels[Levels][Slots];
+        static u64    occupiedSlots[Levels];
+        static uint   currentTick;
+        static uint   pending;
+        static uint   pendingMetric;
+        static uint   firedMetric;
+
+        static void Insert(Timer& timer);
+        static void Unlink(Timer& timer);
+        static void Cascade(const uint level);
+        static void Clear();
+};
+
+}    // namespace Biq
+
+#endif    // BIQ_TIMERS_HXX
@@ -13,6 +13,8 @@
 #include <cstdlib>
 #include <cstdio>
 #include <cstdint>
+#include <cmath>
+#include <algorithm>
 #include <atomic>
 #include <map>
 #include <mutex>
@@ -136,10 +138,39 @@ struct Vector2D {
 	float y;
 };
 
+// Tints multiply the colors of an image as it is drawn (0xRRGGBB), NoTint leaves them as they are.
 struct Image {
+    static constexpr uint MaxLevels  = 6;
+    static constexpr uint MaxRegions = 16;
+    static constexpr u32  NoTint     = 0xFFFFFF;
+
+    struct Region {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
     int width;
     int height;
     void* data;
+    void* surface;
+    uint numberOfLevels;
+    void* levels[MaxLevels];
+    void* levelSurfaces[MaxLevels];
+    string path;
+    u32 serial;
+
+    // The tint each texture is modulated with right now (the image, then its levels), set by Renderer::Draw.
+    mutable u32 tints[MaxLevels + 1];
+
+    // Found by looking at the alpha when the image is loaded, in image pixels: the bounds of what is not fully
+    // transparent, and for large images the regions within them that are drawn (opaque ones first).
+    bool   isOpaque;
+    Region bounds;
+    Region regions[MaxRegions];
+    uint   numberOfRegions;
+    uint   numberOfOpaqueRegions;
 };
 
 struct GameInformation {
@@ -148,6 +179,7 @@ struct GameInformation {
     uint    targetHeight;
     uint    targetFPS;
 	uint	maxWorldLayers;
+    bool    isHeadless;
 };
 
 } // namespace Biq
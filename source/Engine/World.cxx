@@ -7,7 +7,12 @@
 
 #include "Engine/Engine.hxx"
 #include "Engine/World.hxx"
+#include "Engine/DrawRecorder.hxx"
+#include "Engine/FrameArena.hxx"
+#include "Engine/Overdraw.hxx"
+#include "Engine/Particles.hxx"
 #include "Engine/Renderer.hxx"
+#include "Engine/Telemetry.hxx"
 
 namespace Biq {
 
@@ -15,24 +20,73 @@ namespace Biq {
 
 namespace Txt {
     static const charconst InitializingWorld    = "Initializing world with %d layers";
+    static const charconst LayoutMismatch       = "The world layout has %d layers, the game asked for %d";
     static const charconst Cleared              = "Cleared";
 }
 
 // Static Members
 
 std::vector<World::Layer*> World::layers;
+std::vector<uint> World::layerMetrics;
 std::atomic<uint> World::objectCounter;
 std::mutex World::mutex;
+const World::Configuration* World::configuration = NULL;
+const Overlap::Box World::NoDamage = { INFINITY, INFINITY, -INFINITY, -INFINITY };
+bool World::isInvalid = true;
+bool World::hadParticles = false;
+Vector2D World::camera = { 0.0f, 0.0f };
+Vector2D World::renderedCamera = { 0.0f, 0.0f };
+bool World::isPaging = false;
+World::ChunkRange World::pagedChunks = { 0, 0, -1, -1 };
+uint World::numberOfDormantObjects = 0;
+uint World::dormantMetric = 0;
+
+// Chunks
+
+// Rows of chunks one after the other, chunks may be anywhere in the plane.
+static u64 ChunkKey(const int chunkX, const int chunkY) {
+    return (U64(U32(chunkY)) << 32) | U32(chunkX);
+}
+
+static int ChunkCoordinate(const f32 position, const f32 size) {
+    return I32(std::floor((position + (size / 2.0f)) / World::ChunkSize));
+}
+
+static Vector2D ToScreen(const Vector2D& position, const Vector2D& offset) {
+    return { position.x - offset.x, position.y - offset.y };
+}
 
 // General
 
+// Must be called before Initialize (or between Finalize and Initialize), NULL goes back to sorted layers only.
+void World::Configure(const Configuration* layout) {
+    configuration = layout;
+}
+
 bool World::Initialize(const uint numberOfLayers) {
     DEBUG(Txt::InitializingWorld, numberOfLayers);
 
+    if ((configuration != NULL) && (configuration->numberOfLayers != numberOfLayers)) {
+        ERROR(Txt::LayoutMismatch, configuration->numberOfLayers, numberOfLayers);
+        return false;
+    }
+
+    char metricName[Telemetry::MaxNameLength];
+
     for (auto layerIndex = 0; layerIndex < numberOfLayers; layerIndex++) {
         layers.push_back(new Layer());
+        layers.back()->keepsOrder = configuration == NULL || configuration->keepsOrder[layerIndex];
+        layers.back()->scrolls    = configuration == NULL || configuration->scrolls[layerIndex];
+        layers.back()->pages      = configuration != NULL && configuration->pages[layerIndex];
+
+        isPaging = isPaging || layers.back()->pages;
+
+        snprintf(metricName, sizeof(metricName), "World.Layer%d.Objects", layerIndex);
+        layerMetrics.push_back(Telemetry::RegisterGauge(metricName));
     }
 
+    dormantMetric = Telemetry::RegisterGauge("World.DormantObjects");
+
     DEBUG(Txt::Initialized);
     return true;
 }
@@ -46,7 +100,12 @@ void World::Finalize() {
     }
 
     layers.clear();
+    layerMetrics.clear();
     objectCounter = 0;
+    camera = { 0.0f, 0.0f };
+    isPaging = false;
+    pagedChunks = { 0, 0, -1, -1 };
+    numberOfDormantObjects = 0;
 
     DEBUG(Txt::Finalized);
 }
@@ -57,35 +116,291 @@ void World::Clear() {
     for (auto layer : layers) {
         layer->background = NULL;
         layer->objects.clear();
+        layer->chunks.clear();
     }
 
     objectCounter = 0;
+    isInvalid = true;
+    camera = { 0.0f, 0.0f };
+    pagedChunks = { 0, 0, -1, -1 };
+    numberOfDormantObjects = 0;
 
     mutex.unlock();
+
+    Particles::Clear();
     DEBUG(Txt::Cleared);
 }
 
 void World::Update(const float speedMultiplier) {
-    for (auto layer : layers) {
-        for (auto objectIterator : layer->objects) {
-            auto object = objectIterator.second;
-            object->position.x += object->speed.x * object->speedMultiplier * speedMultiplier;
-            object->position.y += object->speed.y * object->speedMultiplier * speedMultiplier;
-        }
+    if (isPaging) {
+        PageChunks();
+    }
+
+    if (configuration != NULL) {
+        configuration->update(speedMultiplier);
+    } else {
+        UpdateSorted(speedMultiplier);
     }
 }
 
-void World::Render() {
-    for (auto layer : layers) {
+bool World::Render() {
+    auto isFullFrame = isInvalid || hadParticles || (Particles::GetCount() > 0);
+    auto damage      = World::NoDamage;
+
+    hadParticles = Particles::GetCount() > 0;
+
+    // Everything that scrolls moves with the camera.
+    if ((camera.x != renderedCamera.x) || (camera.y != renderedCamera.y)) {
+        renderedCamera = camera;
+        isFullFrame    = true;
+    }
+
+    Telemetry::Set(dormantMetric, numberOfDormantObjects);
+
+    for (uint layerIndex = 0; layerIndex < layers.size(); layerIndex++) {
+        auto layer  = layers[layerIndex];
+        auto offset = LayerOffset(layer);
+
+        Telemetry::Set(layerMetrics[layerIndex], layer->objects.size());
+
+        // Images are compared by serial as well, a new image can get the address of one that was unloaded (texts).
+        auto backgroundSerial = layer->background != NULL ? layer->background->serial : 0;
+
+        if ((layer->background != layer->renderedBackground) || (backgroundSerial != layer->renderedBackgroundSerial)) {
+            layer->renderedBackground       = layer->background;
+            layer->renderedBackgroundSerial = backgroundSerial;
+            isFullFrame                     = true;
+        }
+
+        for (auto object : layer->objects) {
+            auto imageSerial = object->image != NULL ? object->image->serial : 0;
+
+            if ((object->image == object->renderedImage) && (imageSerial == object->renderedSerial) &&
+                (object->mask == object->renderedMask) && (object->tint == object->renderedTint) &&
+                (object->position.x == object->renderedPosition.x) && (object->position.y == object->renderedPosition.y) &&
+                (object->size.x == object->renderedSize.x) && (object->size.y == object->renderedSize.y)) {
+                continue;
+            }
+
+            if ((object->renderedImage != NULL) || (object->renderedMask != NULL)) {
+                AddDamage(layer->damage, ToScreen(object->renderedPosition, offset), object->renderedSize);
+            }
+
+            if ((object->image != NULL) || (object->mask != NULL)) {
+                AddDamage(layer->damage, ToScreen(object->position, offset), object->size);
+            }
+
+            object->renderedImage    = object->image;
+            object->renderedSerial   = imageSerial;
+            object->renderedMask     = object->mask;
+            object->renderedTint     = object->tint;
+            object->renderedPosition = object->position;
+            object->renderedSize     = object->size;
+        }
+
+        damage.left   = std::min(damage.left, layer->damage.left);
+        damage.top    = std::min(damage.top, layer->damage.top);
+        damage.right  = std::max(damage.right, layer->damage.right);
+        damage.bottom = std::max(damage.bottom, layer->damage.bottom);
+        layer->damage = World::NoDamage;
+    }
+
+    isInvalid = false;
+
+    auto isDamaged = (damage.left < damage.right) && (damage.top < damage.bottom);
+
+    if (!isFullFrame && !isDamaged) {
+        return false;
+    }
+
+    auto isPartialFrame = !isFullFrame && Renderer::HasRetainedFrame();
+
+    if (isPartialFrame) {
+        SDL_Rect damageRect = { I32(damage.left), I32(damage.top), I32(damage.right - damage.left), I32(damage.bottom - damage.top) };
+        Renderer::BeginPartialFrame(damageRect);
+    }
+
+    auto& frameRect = Renderer::GetFrameRect();
+
+    for (uint layerIndex = 0; layerIndex < layers.size(); layerIndex++) {
+        auto layer  = layers[layerIndex];
+        auto offset = LayerOffset(layer);
+
+        DrawRecorder::SetLayer(layerIndex);
+        Overdraw::SetLayer(layerIndex);
+
         if (layer->background != NULL) {
             Renderer::Splash(layer->background);
         }
 
         for (auto object : layer->objects) {
-            // TODO: skip objects outside viewport.
-            Renderer::Draw(object.second->image, object.second->position, object.second->size);
+            auto position = ToScreen(object->position, offset);
+
+            if ((position.x + object->size.x <= frameRect.x) || (position.x >= frameRect.x + frameRect.w) ||
+                (position.y + object->size.y <= frameRect.y) || (position.y >= frameRect.y + frameRect.h)) {
+                continue;
+            }
+
+            if (isPartialFrame && !IsDamaged(damage, position, object->size)) {
+                continue;
+            }
+
+            Renderer::Draw(object->image, position, object->size);
+
+            if (object->mask != NULL) {
+                Renderer::Draw(object->mask, position, object->size, object->tint);
+            }
         }
+
+        Particles::Render(layerIndex, offset);
     }
+
+    if (isPartialFrame) {
+        Renderer::EndPartialFrame();
+    }
+
+    return true;
+}
+
+void World::Invalidate() {
+    isInvalid = true;
+}
+
+// The renderer truncates positions and filters scaled frames, the margin covers both. Damage off the frame (objects
+// coming in or leaving) does not count.
+void World::AddDamage(Overlap::Box& damage, const Vector2D& position, const Vector2D& size) {
+    auto& frameRect = Renderer::GetFrameRect();
+
+    auto left   = std::max(std::floor(position.x) - World::DamageMargin, F32(frameRect.x));
+    auto top    = std::max(std::floor(position.y) - World::DamageMargin, F32(frameRect.y));
+    auto right  = std::min(std::ceil(position.x + size.x) + World::DamageMargin, F32(frameRect.x + frameRect.w));
+    auto bottom = std::min(std::ceil(position.y + size.y) + World::DamageMargin, F32(frameRect.y + frameRect.h));
+
+    if ((left >= right) || (top >= bottom)) {
+        return;
+    }
+
+    damage.left   = std::min(damage.left, left);
+    damage.top    = std::min(damage.top, top);
+    damage.right  = std::max(damage.right, right);
+    damage.bottom = std::max(damage.bottom, bottom);
+}
+
+bool World::IsDamaged(const Overlap::Box& damage, const Vector2D& position, const Vector2D& size) {
+    return
+        (position.x + size.x + World::DamageMargin > damage.left) && (position.x - World::DamageMargin < damage.right) &&
+        (position.y + size.y + World::DamageMargin > damage.top) && (position.y - World::DamageMargin < damage.bottom);
+}
+
+// Camera
+
+void World::SetCamera(const Vector2D& position) {
+    camera = position;
+}
+
+const Vector2D& World::GetCamera() {
+    return camera;
+}
+
+uint World::GetDormantCount() {
+    return numberOfDormantObjects;
+}
+
+Vector2D World::LayerOffset(const Layer* layer) {
+    return layer->scrolls ? camera : Vector2D { 0.0f, 0.0f };
+}
+
+World::ChunkRange World::CameraChunks() {
+    auto& frameRect = Renderer::GetFrameRect();
+
+    return {
+        I32(std::floor((camera.x + frameRect.x) / World::ChunkSize)) - World::ChunkMargin,
+        I32(std::floor((camera.y + frameRect.y) / World::ChunkSize)) - World::ChunkMargin,
+        I32(std::floor((camera.x + frameRect.x + frameRect.w) / World::ChunkSize)) + World::ChunkMargin,
+        I32(std::floor((camera.y + frameRect.y + frameRect.h) / World::ChunkSize)) + World::ChunkMargin,
+    };
+}
+
+// Objects out of the chunks around the camera go to sleep first, then the chunks that came in wake up whole, so the
+// dormant objects are always in chunks out of the paged ones. Only the active objects and the chunks that came in are
+// gone through.
+void World::PageChunks() {
+    auto cameraChunks = CameraChunks();
+
+    mutex.lock(); // FIXME: there must be a better way of doing this.
+
+    for (auto layer : layers) {
+        if (!layer->pages) {
+            continue;
+        }
+
+        auto& objects = layer->objects;
+
+        for (uint objectIndex = 0; objectIndex < objects.size();) {
+            auto object = objects[objectIndex];
+            auto chunkX = ChunkCoordinate(object->position.x, object->size.x);
+            auto chunkY = ChunkCoordinate(object->position.y, object->size.y);
+
+            if ((chunkX >= cameraChunks.left) && (chunkX <= cameraChunks.right) && (chunkY >= cameraChunks.top) && (chunkY <= cameraChunks.bottom)) {
+                objectIndex++;
+                continue;
+            }
+
+            auto lastObject = objects.back();
+
+            lastObject->layerPosition = objectIndex;
+            objects[objectIndex] = lastObject;
+            objects.pop_back();
+
+            PageOut(layer, object, ChunkKey(chunkX, chunkY));
+        }
+
+        for (auto chunkY = cameraChunks.top; chunkY <= cameraChunks.bottom; chunkY++) {
+            for (auto chunkX = cameraChunks.left; chunkX <= cameraChunks.right; chunkX++) {
+                if ((chunkX >= pagedChunks.left) && (chunkX <= pagedChunks.right) && (chunkY >= pagedChunks.top) && (chunkY <= pagedChunks.bottom)) {
+                    continue;
+                }
+
+                auto chunk = layer->chunks.find(ChunkKey(chunkX, chunkY));
+
+                if (chunk == layer->chunks.end()) {
+                    continue;
+                }
+
+                for (auto object : chunk->second) {
+                    object->isDormant = false;
+                    object->layerPosition = objects.size();
+                    objects.push_back(object);
+                }
+
+                // Chunks keep their storage, a camera going back and forth does not allocate.
+                numberOfDormantObjects -= chunk->second.size();
+                chunk->second.clear();
+            }
+        }
+    }
+
+    pagedChunks = cameraChunks;
+
+    mutex.unlock();
+}
+
+// Whatever the object left on screen is damaged, it is drawn as a new object when it wakes up.
+void World::PageOut(Layer* layer, Object* object, const u64 chunkKey) {
+    auto& chunk = layer->chunks[chunkKey];
+
+    if ((object->renderedImage != NULL) || (object->renderedMask != NULL)) {
+        AddDamage(layer->damage, ToScreen(object->renderedPosition, LayerOffset(layer)), object->renderedSize);
+    }
+
+    object->renderedImage = NULL;
+    object->renderedMask = NULL;
+    object->isDormant = true;
+    object->chunkKey = chunkKey;
+    object->layerPosition = chunk.size();
+    chunk.push_back(object);
+
+    numberOfDormantObjects++;
 }
 
 // Layers
@@ -100,6 +415,10 @@ void World::SetLayerBackground(const uint layerIndex, Image* image) {
     mutex.unlock();
 }
 
+const std::vector<World::Layer*>& World::GetLayers() {
+    return layers;
+}
+
 // Objects
 
 void World::AddObject(const uint layerIndex, Object* object) {
@@ -109,20 +428,69 @@ void World::AddObject(const uint layerIndex, Object* object) {
 
     mutex.lock(); // FIXME: there must be a better way of doing this.
 
+    auto& objects = layers[layerIndex]->objects;
+
+    // Ids only grow, appending keeps the layers sorted by id.
     object->id = objectCounter++;
     object->layerIndex = layerIndex;
-    layers[layerIndex]->objects[object->id] = object;
+    object->layerPosition = objects.size();
+    object->isDormant = false;
+    object->renderedImage = NULL;
+    object->renderedMask = NULL;
+    objects.push_back(object);
 
     mutex.unlock();
 }
 
 void World::RemoveObject(const Object* object) {
-    if (object == NULL) {
+    if ((object == NULL) || (object->layerIndex >= layers.size())) {
         return;
     }
 
     mutex.lock(); // FIXME: there must be a better way of doing this.
-    layers[object->layerIndex]->objects.erase(object->id);
+
+    auto  layer   = layers[object->layerIndex];
+    auto& objects = layer->objects;
+    auto  offset  = LayerOffset(layer);
+
+    // Objects that are not in the layer anymore (the world was cleared) are left alone, like erasing a missing id.
+    // Dormant objects drew nothing since they went to sleep.
+    if (object->isDormant) {
+        auto chunk = layer->chunks.find(object->chunkKey);
+
+        if ((chunk != layer->chunks.end()) && (object->layerPosition < chunk->second.size()) && (chunk->second[object->layerPosition] == object)) {
+            auto lastObject = chunk->second.back();
+
+            lastObject->layerPosition = object->layerPosition;
+            chunk->second[object->layerPosition] = lastObject;
+            chunk->second.pop_back();
+
+            numberOfDormantObjects--;
+        }
+    } else if (layer->keepsOrder) {
+        auto objectIterator = std::lower_bound(objects.begin(), objects.end(), object->id, [](const Object* layerObject, const uint id) {
+            return layerObject->id < id;
+        });
+
+        if ((objectIterator != objects.end()) && (*objectIterator == object)) {
+            objects.erase(objectIterator);
+
+            if ((object->renderedImage != NULL) || (object->renderedMask != NULL)) {
+                AddDamage(layer->damage, ToScreen(object->renderedPosition, offset), object->renderedSize);
+            }
+        }
+    } else if ((object->layerPosition < objects.size()) && (objects[object->layerPosition] == object)) {
+        auto lastObject = objects.back();
+
+        lastObject->layerPosition = object->layerPosition;
+        objects[object->layerPosition] = lastObject;
+        objects.pop_back();
+
+        if ((object->renderedImage != NULL) || (object->renderedMask != NULL)) {
+            AddDamage(layer->damage, ToScreen(object->renderedPosition, offset), object->renderedSize);
+        }
+    }
+
     mutex.unlock();
 }
 
@@ -132,4 +500,96 @@ bool World::CheckCollision(const Object* object1, const Object* object2) {
         (object1->position.y + object1->size.y > object2->position.y) && (object1->position.y < object2->position.y + object2->size.y);
 }
 
+// Layer Passes
+
+void World::UpdateSorted(const float speedMultiplier) {
+    for (auto layer : layers) {
+        MoveObjects(layer, speedMultiplier, std::true_type());
+    }
+}
+
+void World::MoveObjects(Layer* layer, const float speedMultiplier, std::true_type) {
+    for (auto object : layer->objects) {
+        object->position.x += object->speed.x * object->speedMultiplier * speedMultiplier;
+        object->position.y += object->speed.y * object->speedMultiplier * speedMultiplier;
+    }
+}
+
+// Swept Collisions
+
+// Slab test on each axis, with object2 standing still and object1 moving by the difference of both displacements.
+static bool SweepAxis(const float start1, const float size1, const float start2, const float size2, const float displacement, float& enterTime, float& exitTime) {
+    if (displacement == 0.0f) {
+        return (start1 + size1 > start2) && (start1 < start2 + size2);
+    }
+
+    auto axisEnter = ((displacement > 0.0f ? start2 - size1 : start2 + size2) - start1) / displacement;
+    auto axisExit  = ((displacement > 0.0f ? start2 + size2 : start2 - size1) - start1) / displacement;
+
+    enterTime = std::max(enterTime, axisEnter);
+    exitTime  = std::min(exitTime, axisExit);
+    return true;
+}
+
+bool World::SweepCollision(const Object* object1, const Object* object2, const float speedMultiplier, float& contactTime) {
+    auto displacementX = (object1->speed.x * object1->speedMultiplier - object2->speed.x * object2->speedMultiplier) * speedMultiplier;
+    auto displacementY = (object1->speed.y * object1->speedMultiplier - object2->speed.y * object2->speedMultiplier) * speedMultiplier;
+    auto enterTime     = 0.0f;
+    auto exitTime      = 1.0f;
+
+    if (!SweepAxis(object1->position.x, object1->size.x, object2->position.x, object2->size.x, displacementX, enterTime, exitTime)) {
+        return false;
+    }
+
+    if (!SweepAxis(object1->position.y, object1->size.y, object2->position.y, object2->size.y, displacementY, enterTime, exitTime)) {
+        return false;
+    }
+
+    if (enterTime >= exitTime) {
+        return false;
+    }
+
+    contactTime = enterTime;
+    return true;
+}
+
+Overlap::Box World::SweptBounds(const Object* object, const float speedMultiplier) {
+    auto displacementX = object->speed.x * object->speedMultiplier * speedMultiplier;
+    auto displacementY = object->speed.y * object->speedMultiplier * speedMultiplier;
+
+    return {
+        object->position.x + std::min(displacementX, 0.0f) - World::SweepMargin,
+        object->position.y + std::min(displacementY, 0.0f) - World::SweepMargin,
+        object->position.x + object->size.x + std::max(displacementX, 0.0f) + World::SweepMargin,
+        object->position.y + object->size.y + std::max(displacementY, 0.0f) + World::SweepMargin,
+    };
+}
+
+int World::FirstCollision(const Object* object, Object* const* targets, const Overlap::Boxes& targetBounds, const float speedMultiplier, float& contactTime) {
+    int  firstTarget = -1;
+    auto targetTime  = 0.0f;
+
+    contactTime = 2.0f;
+
+    FrameVector<u32> hitMask(Overlap::MaskWords(targetBounds.GetCount()));
+
+    if (Overlap::Test(SweptBounds(object, speedMultiplier), targetBounds, hitMask.data()) == 0) {
+        return -1;
+    }
+
+    // Hits are swept in the order of the targets, so ties still go to the first one.
+    for (uint wordIndex = 0; wordIndex < hitMask.size(); wordIndex++) {
+        for (auto word = hitMask[wordIndex]; word != 0; word &= word - 1) {
+            auto targetIndex = (wordIndex * 32) + __builtin_ctz(word);
+
+            if (SweepCollision(object, targets[targetIndex], speedMultiplier, targetTime) && (targetTime < contactTime)) {
+                contactTime = targetTime;
+                firstTarget = targetIndex;
+            }
+        }
+    }
+
+    return firstTarget;
+}
+
 } // namespace Biq
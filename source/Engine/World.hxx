@@ -8,8 +8,11 @@
 #ifndef BIQ_WORLD_HXX
 #define BIQ_WORLD_HXX
 
+#include "Engine/Overlap.hxx"
 #include "Engine/Types.hxx"
 
+#include <type_traits>
+
 namespace Biq {
 
 // World
@@ -28,44 +31,155 @@ class World {
                     Enemy
                 };
 
-                Object(Type type) : type(type), image(NULL), speedMultiplier(1.0f) {}
+                Object(Type type) : isDormant(false), type(type), image(NULL), mask(NULL), tint(Image::NoTint), speedMultiplier(1.0f), renderedImage(NULL), renderedMask(NULL) {}
                 virtual ~Object() = default;
 
                 uint        id;
                 uint        layerIndex;
+                uint        layerPosition;
+
+                // Dormant objects are kept in the chunk of their paged layer, layerPosition is their place in it.
+                bool        isDormant;
+                u64         chunkKey;
+
                 Type        type;
                 Image*      image;
+
+                // Color variants share their image, the mask is drawn over it multiplied by the tint.
+                Image*      mask;
+                u32         tint;
+
                 Vector2D    position;
                 Vector2D    size;
                 Vector2D    speed;
                 float       speedMultiplier;
+
+                // What the last rendered frame drew for the object.
+                const Image* renderedImage;
+                u32          renderedSerial;
+                const Image* renderedMask;
+                u32          renderedTint;
+                Vector2D     renderedPosition;
+                Vector2D     renderedSize;
         };
 
         // Layer
 
         class Layer {
             public:
-                Layer() : background(NULL) {}
+                Layer() : background(NULL), keepsOrder(true), scrolls(true), pages(false), renderedBackground(NULL), renderedBackgroundSerial(0), damage(World::NoDamage) {}
+
+                Image*                              background;
+                std::vector<Object*>                objects;
+                bool                                keepsOrder;
+                bool                                scrolls;
+                bool                                pages;
+                std::map<u64, std::vector<Object*>> chunks;
+                const Image*                        renderedBackground;
+                u32                                 renderedBackgroundSerial;
+                Overlap::Box                        damage;
+        };
+
+        // Layer Policies
+
+        // Static layers hold a background and objects that never move (the HUD), Update skips them and they are drawn
+        // in screen coordinates. Sorted layers move their objects and draw them in the order they were added. Dynamic
+        // layers move their objects too, but remove them in constant time by moving the last object to the hole, so
+        // their draw order changes (projectiles). Paged layers are dynamic layers whose objects far from the camera
+        // sleep in chunks (see Camera). Every layer but the static ones scrolls with the camera.
+
+        struct StaticLayer {
+            static constexpr bool Moves      = false;
+            static constexpr bool KeepsOrder = true;
+            static constexpr bool Scrolls    = false;
+            static constexpr bool Pages      = false;
+        };
 
-                Image*                  background;
-                std::map<uint, Object*> objects;
+        struct SortedLayer {
+            static constexpr bool Moves      = true;
+            static constexpr bool KeepsOrder = true;
+            static constexpr bool Scrolls    = true;
+            static constexpr bool Pages      = false;
         };
 
+        struct DynamicLayer {
+            static constexpr bool Moves      = true;
+            static constexpr bool KeepsOrder = false;
+            static constexpr bool Scrolls    = true;
+            static constexpr bool Pages      = false;
+        };
+
+        struct PagedLayer {
+            static constexpr bool Moves      = true;
+            static constexpr bool KeepsOrder = false;
+            static constexpr bool Scrolls    = true;
+            static constexpr bool Pages      = true;
+        };
+
+        // Layouts
+
+        // A game declares its layers in order with their policies (World::Layout<World::StaticLayer, ...>) and hands
+        // the layout to Configure before the engine starts. Update goes through the layers with the code of each
+        // policy picked at compile time, there is no branch or indirect call per object. Without a layout every layer
+        // is a SortedLayer.
+
+        struct Configuration {
+            uint        numberOfLayers;
+            const bool* keepsOrder;
+            const bool* scrolls;
+            const bool* pages;
+            void        (*update)(const float speedMultiplier);
+        };
+
+        template <typename... Policies> class Layout;
+
 		// Constants
 
-		static constexpr charconst Tag = "World";
+		static constexpr charconst Tag          = "World";
+		static constexpr f32       SweepMargin  = 1.0f;
+		static constexpr f32       DamageMargin = 2.0f;
+		static constexpr f32       ChunkSize    = 512.0f;
+		static constexpr int       ChunkMargin  = 1;
 
         // General
 
+        static void Configure(const Configuration* layout);
         static bool Initialize(const uint numberOfLayers);
         static void Finalize();
         static void Clear();
         static void Update(const float speedMultiplier);
-        static void Render();
+        static bool Render();
+
+        // Damage
+
+        // Render compares every object with what it drew for it last time: the rects it left and moved to are damaged,
+        // along with the rects of removed objects. Nothing damaged means nothing is drawn (Render returns false and the
+        // frame is not presented). Renderers that keep their frame (Renderer::HasRetainedFrame) only redraw the damaged
+        // rect, the others redraw everything. Changed backgrounds, live particles, cleared layers and Invalidate damage
+        // the whole frame.
+        static void Invalidate();
+
+        // Camera
+
+        // The camera is the world position of the top left corner of the frame, objects of scrolling layers are drawn
+        // that much up and left (and off screen ones are not drawn). Moving it redraws the whole frame.
+        //
+        // Paged layers split the world in square chunks of ChunkSize. Only the objects of the chunks the frame covers
+        // (and ChunkMargin more around them) stay in the layer, the others are dormant: left in their chunk, they do
+        // not move, are not drawn and are not in the layer's objects, so the cost of a frame follows what is near the
+        // camera and not the size of the world. Update pages the objects that left those chunks out and the chunks that
+        // came in back in, whole, before moving anything. Objects belong to the chunk of their center, they are added
+        // active and go to sleep on the next Update when they are far. A camera set after Update pages on the next one,
+        // the margin hides that as long as it moves less than a chunk per step and the objects are not bigger than a
+        // chunk. Moving a dormant object does not wake it up.
+        static void SetCamera(const Vector2D& position);
+        static const Vector2D& GetCamera();
+        static uint GetDormantCount();
 
         // Layers
 
         static void SetLayerBackground(const uint layerIndex, Image* image);
+        static const std::vector<Layer*>& GetLayers();
 
         // Objects
 
@@ -73,13 +187,90 @@ class World {
         static void RemoveObject(const Object* object);
         static bool CheckCollision(const Object* object1, const Object* object2);
 
+        // Swept Collisions
+
+        // Both objects move by their speed over the step (speed * speedMultiplier, like Update does), the contact time
+        // goes from 0 (already touching) to 1 (touching at the end of the step).
+        static bool SweepCollision(const Object* object1, const Object* object2, const float speedMultiplier, float& contactTime);
+
+        // The swept bounds cover an object over the whole step (and SweepMargin around it), objects whose bounds do not
+        // overlap can not collide during the step. FirstCollision only sweeps the targets whose bounds (packed in the
+        // same order as the targets) overlap the object's.
+        static Overlap::Box SweptBounds(const Object* object, const float speedMultiplier);
+        static int          FirstCollision(const Object* object, Object* const* targets, const Overlap::Boxes& targetBounds, const float speedMultiplier, float& contactTime);
+
     protected:
         World() = delete;
 
     private:
+        template <uint LayerIndex, typename... Policies> struct LayerPass;
+
+        // Chunk coordinates, right and bottom included.
+        struct ChunkRange {
+            int left;
+            int top;
+            int right;
+            int bottom;
+        };
+
         static std::vector<Layer*> layers;
+        static std::vector<uint> layerMetrics;
         static std::atomic<uint> objectCounter;
         static std::mutex mutex;
+        static const Configuration* configuration;
+        static const Overlap::Box NoDamage;
+        static bool isInvalid;
+        static bool hadParticles;
+        static Vector2D camera;
+        static Vector2D renderedCamera;
+        static bool isPaging;
+        static ChunkRange pagedChunks;
+        static uint numberOfDormantObjects;
+        static uint dormantMetric;
+
+        static void AddDamage(Overlap::Box& damage, const Vector2D& position, const Vector2D& size);
+        static bool IsDamaged(const Overlap::Box& damage, const Vector2D& position, const Vector2D& size);
+
+        static Vector2D LayerOffset(const Layer* layer);
+        static ChunkRange CameraChunks();
+        static void PageChunks();
+        static void PageOut(Layer* layer, Object* object, const u64 chunkKey);
+
+        static void UpdateSorted(const float speedMultiplier);
+        static void MoveObjects(Layer* layer, const float speedMultiplier, std::true_type);
+        static void MoveObjects(Layer* layer, const float speedMultiplier, std::false_type) {}
+};
+
+// Layer Passes
+
+template <uint LayerIndex, typename... Policies> struct World::LayerPass {
+    static void Update(const float speedMultiplier) {}
+};
+
+template <uint LayerIndex, typename Policy, typename... Others> struct World::LayerPass<LayerIndex, Policy, Others...> {
+    static void Update(const float speedMultiplier) {
+        World::MoveObjects(World::layers[LayerIndex], speedMultiplier, std::integral_constant<bool, Policy::Moves>());
+        LayerPass<LayerIndex + 1, Others...>::Update(speedMultiplier);
+    }
+};
+
+template <typename... Policies> class World::Layout {
+    public:
+        static constexpr uint NumberOfLayers = sizeof...(Policies);
+
+        static const Configuration* GetConfiguration() {
+            static const bool          keepsOrder[]  = { Policies::KeepsOrder... };
+            static const bool          scrolls[]     = { Policies::Scrolls... };
+            static const bool          pages[]       = { Policies::Pages... };
+            static const Configuration configuration = { NumberOfLayers, keepsOrder, scrolls, pages, Update };
+
+            return &configuration;
+        }
+
+    private:
+        static void Update(const float speedMultiplier) {
+            LayerPass<0, Policies...>::Update(speedMultiplier);
+        }
 };
 
 } // namespace Biq
@@ -0,0 +1,251 @@
+/*
+ * Source/Game/Autopilot.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Game/Autopilot.hxx"
+
+#include <ctime>
+
+namespace Biq {
+namespace Game {
+
+// String Table
+
+namespace Txt {
+static const charconst Playing      = "Playing with the seed %u%s";
+static const charconst Restarting   = ", restarting after every game";
+static const charconst GameFinished = "Game %d finished with %d points at %.1f s";
+static const charconst Summary      = "%d games, best score %d, average score %.1f";
+static const charconst Throughput   = "Simulated %.1f s in %d steps, %.1f s of real time (%.0f steps per second)";
+}    // namespace Txt
+
+static constexpr uint NoKey = UINT(-1);
+
+// Staying is tried first, it wins ties.
+static const int Directions[] = { 0, -1, 1 };
+
+// General
+
+Autopilot::Autopilot(InGame& inGame) :
+    inGame(inGame), randomSeed(UINT(time(NULL))), isRestarting(false), duration(0.0) {
+}
+
+void Autopilot::SetSeed(const uint seed) {
+    randomSeed = seed;
+}
+
+void Autopilot::SetRestart(const bool restart) {
+    isRestarting = restart;
+}
+
+void Autopilot::SetDuration(const f64 seconds) {
+    duration = seconds;
+}
+
+// State
+
+void Autopilot::Prepare(const GameInformation& game) {
+    inGame.Prepare(game);
+}
+
+void Autopilot::Release() {
+    inGame.Release();
+}
+
+void Autopilot::Activate(const GameInformation& game) {
+    INFO(Txt::Playing, randomSeed, isRestarting ? Txt::Restarting : Biq::Txt::Empty);
+
+    Engine::SetRandomSeed(randomSeed);
+
+    inGame.Activate(game);
+
+    currentGame = game;
+    heldKey     = NoKey;
+    nextShot    = Engine::GetSimulationTicks();
+    restartAt   = 0;
+    wasGameOver = false;
+    gamesPlayed = 0;
+    totalScore  = 0;
+    bestScore   = 0;
+    startTicks  = Engine::GetSimulationTicks();
+    startStep   = Engine::GetSimulationSteps();
+    startTime   = Engine::GetPreciseTicks();
+}
+
+void Autopilot::Deactivate() {
+    // A game still running when the engine stops counts as well.
+    if (!wasGameOver) {
+        FinishGame();
+    }
+
+    Report();
+    inGame.Deactivate();
+}
+
+void Autopilot::Step(const float speedMultiplier) {
+    auto currentTick = Engine::GetSimulationTicks();
+
+    if ((duration > 0.0) && (currentTick - startTicks >= duration * 1000.0)) {
+        Engine::Stop();
+        return;
+    }
+
+    if (inGame.IsGameOver()) {
+        if (!wasGameOver) {
+            wasGameOver = true;
+            restartAt   = currentTick + Autopilot::RestartDelay;
+
+            Hold(NoKey);
+            FinishGame();
+
+            if (!isRestarting) {
+                Engine::Stop();
+                return;
+            }
+        } else if (currentTick >= restartAt) {
+            Tap(Input::KeyEnter);
+
+            wasGameOver = false;
+            nextShot    = currentTick;
+        }
+
+        inGame.Step(speedMultiplier);
+        return;
+    }
+
+    // Target the nearest enemy on screen (horizontally, the ship only moves sideways).
+    auto&              player       = inGame.GetPlayer();
+    auto               playerCenter = player.position.x + (player.size.x / 2.0f);
+    const EnemyObject* target       = NULL;
+    float              targetX      = currentGame.targetWidth / 2.0f;
+
+    for (auto enemy : inGame.GetEnemies()) {
+        auto enemyCenter = enemy->position.x + (enemy->size.x / 2.0f);
+
+        if ((enemy->position.y < 0.0f) || ((target != NULL) && (std::abs(enemyCenter - playerCenter) >= std::abs(targetX - playerCenter)))) {
+            continue;
+        }
+
+        target  = enemy;
+        targetX = enemyCenter;
+    }
+
+    if ((target != NULL) && (target->color != player.color)) {
+        Tap(Input::KeyA + target->color);
+    }
+
+    auto direction = ChooseDirection(targetX);
+    Hold(direction < 0 ? Input::KeyLeft : (direction > 0 ? Input::KeyRight : NoKey));
+
+    if ((target != NULL) && (std::abs(targetX - playerCenter) <= Autopilot::AimTolerance) && (currentTick >= nextShot)) {
+        Tap(Input::KeySpacebar);
+        nextShot = currentTick + Autopilot::FireInterval;
+    }
+
+    inGame.Step(speedMultiplier);
+}
+
+void Autopilot::OnPress(const uint key) {
+    // Empty
+}
+
+void Autopilot::OnRelease(const uint key) {
+    if (key == Input::KeyEscape) {
+        Engine::Stop();
+    }
+}
+
+// Decisions
+
+// Each direction is held for the coming frames (at a speed multiplier of one) against where the enemy projectiles will
+// be by then, hits closer in time weigh more. Without any danger the direction that gets closer to the target wins.
+int Autopilot::ChooseDirection(const float targetX) const {
+    auto& player = inGame.GetPlayer();
+    auto  minX   = F32(InGame::HorizontalPadding);
+    auto  maxX   = F32(currentGame.targetWidth - (InGame::ShipWidth + InGame::HorizontalPadding));
+    auto  top    = player.position.y - Autopilot::DodgeMargin;
+    auto  bottom = player.position.y + player.size.y + Autopilot::DodgeMargin;
+
+    int   bestDirection = 0;
+    float bestCost      = 0.0f;
+
+    for (auto direction : Directions) {
+        float danger = 0.0f;
+
+        for (uint frame = 1; frame <= Autopilot::LookaheadFrames; frame++) {
+            auto x     = std::min(std::max(player.position.x + (direction * InGame::PlayerSpeed * frame), minX), maxX);
+            auto left  = x - Autopilot::DodgeMargin;
+            auto right = x + player.size.x + Autopilot::DodgeMargin;
+
+            for (auto projectile : inGame.GetProjectiles()) {
+                if (projectile->type != World::Object::Enemy) {
+                    continue;
+                }
+
+                auto y = projectile->position.y + (projectile->speed.y * projectile->speedMultiplier * frame);
+
+                if ((projectile->position.x < right) && (projectile->position.x + projectile->size.x > left) && (y < bottom) && (y + projectile->size.y > top)) {
+                    danger += Autopilot::LookaheadFrames + 1 - frame;
+                }
+            }
+        }
+
+        auto nextX = std::min(std::max(player.position.x + (direction * InGame::PlayerSpeed), minX), maxX);
+        auto cost  = (danger * currentGame.targetWidth) + std::abs(nextX + (player.size.x / 2.0f) - targetX);
+
+        if ((direction == Directions[0]) || (cost < bestCost)) {
+            bestDirection = direction;
+            bestCost      = cost;
+        }
+    }
+
+    return bestDirection;
+}
+
+void Autopilot::Hold(const uint key) {
+    if (key == heldKey) {
+        return;
+    }
+
+    if (heldKey != NoKey) {
+        inGame.OnRelease(heldKey);
+    }
+
+    if (key != NoKey) {
+        inGame.OnPress(key);
+    }
+
+    heldKey = key;
+}
+
+void Autopilot::Tap(const uint key) {
+    inGame.OnPress(key);
+    inGame.OnRelease(key);
+}
+
+// Results
+
+void Autopilot::FinishGame() {
+    auto score = inGame.GetPlayer().score;
+
+    gamesPlayed++;
+    totalScore += score;
+    bestScore = std::max(bestScore, score);
+
+    INFO(Txt::GameFinished, gamesPlayed, score, (Engine::GetSimulationTicks() - startTicks) / 1000.0);
+}
+
+void Autopilot::Report() const {
+    auto simulatedTime = (Engine::GetSimulationTicks() - startTicks) / 1000.0;
+    auto realTime      = (Engine::GetPreciseTicks() - startTime) / 1000.0;
+    auto steps         = Engine::GetSimulationSteps() - startStep;
+
+    INFO(Txt::Summary, gamesPlayed, bestScore, gamesPlayed > 0 ? F64(totalScore) / gamesPlayed : 0.0);
+    INFO(Txt::Throughput, simulatedTime, steps, realTime, realTime > 0.0 ? steps / realTime : 0.0);
+}
+
+}    // namespace Game
+}    // namespace Biq
@@ -0,0 +1,77 @@
+/*
+ * Source/Game/Autopilot.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_GAME_AUTOPILOT_HXX
+#define BIQ_GAME_AUTOPILOT_HXX
+
+#include "Engine/Engine.hxx"
+#include "Game/InGame.hxx"
+
+namespace Biq {
+namespace Game {
+
+// Autopilot plays InGame for soak and throughput runs. Every step it looks at the world and presses the same keys a
+// player would: it dodges the enemy projectiles coming down on the ship, switches to the color of the nearest enemy,
+// moves under it and fires. Decisions only depend on the world, so with a fixed seed (and lockstep) every run plays
+// the same games. When a game is over it either restarts it or stops the engine.
+
+class Autopilot : public State {
+    public:
+        static constexpr charconst Tag  = "Autopilot";
+        static constexpr charconst Name = "AUTOPILOT";
+        static constexpr uint      Id   = 3;
+
+        static constexpr uint  LookaheadFrames = 12;
+        static constexpr float DodgeMargin     = 12.0f;
+        static constexpr float AimTolerance    = 16.0f;
+        static constexpr uint  FireInterval    = 200;
+        static constexpr uint  RestartDelay    = 2000;
+
+        Autopilot(InGame& inGame);
+
+        void SetSeed(const uint seed);
+        void SetRestart(const bool restart);
+        void SetDuration(const f64 seconds);
+
+        void Prepare(const GameInformation& game);
+        void Release();
+        void Activate(const GameInformation& game);
+        void Deactivate();
+        void Step(const float speedMultiplier);
+        void OnPress(const uint key);
+        void OnRelease(const uint key);
+
+    private:
+        InGame&         inGame;
+        GameInformation currentGame;
+        uint            randomSeed;
+        bool            isRestarting;
+        f64             duration;
+
+        uint heldKey;
+        uint nextShot;
+        uint restartAt;
+        bool wasGameOver;
+
+        uint gamesPlayed;
+        i64  totalScore;
+        int  bestScore;
+        uint startTicks;
+        u32  startStep;
+        f64  startTime;
+
+        int  ChooseDirection(const float targetX) const;
+        void Hold(const uint key);
+        void Tap(const uint key);
+        void FinishGame();
+        void Report() const;
+};
+
+}    // namespace Game
+}    // namespace Biq
+
+#endif    // BIQ_GAME_AUTOPILOT_HXX
@@ -7,30 +7,83 @@
 
 #include "Game/InGame.hxx"
 
+#include "Engine/FrameArena.hxx"
+#include "Engine/Overlap.hxx"
+#include "Engine/Particles.hxx"
+#include "Engine/PerfCounters.hxx"
 #include "Engine/Renderer.hxx"
 #include "Engine/Sound.hxx"
+#include "Engine/Spectator.hxx"
+#include "Engine/Telemetry.hxx"
 #include "Game/Splash.hxx"
 
 namespace Biq {
 namespace Game {
 
-void InGame::Activate(const GameInformation& game) {
-    World::Clear();
+// String Table
+
+namespace Txt {
+static const charconst ScoreText    = "SCORE: %d";
+static const charconst GameOverText = "GAME OVER | YOU SCORED %d | PRESS <ENTER> TO RESTART";
+}    // namespace Txt
+
+// Effects
+
+static const SDL_Color EffectColors[ColoredObject::MaxColors] = {
+    { 235, 70, 60, 255 },
+    { 90, 220, 100, 255 },
+    { 80, 140, 245, 255 },
+    { 110, 110, 120, 255 },
+};
+
+// Colors
+
+// The tints the masks of the sprites are drawn with, one per color.
+static const u32 SpriteTints[ColoredObject::MaxColors] = { 0xFF0F0D, 0x24970D, 0x100FFE, 0x222322 };
 
+// The player's cannons are each of a different color (the left one is the previous color, the right one the next), so
+// its variants are baked from these regions of the mask.
+static const SDL_Rect CannonRects[3] = { { 0, 0, 30, 72 }, { 30, 0, 11, 72 }, { 41, 0, 31, 72 } };
+
+void InGame::Prepare(const GameInformation& game) {
     currentGame = game;
 
     LoadImages();
     LoadSounds();
+}
+
+void InGame::Release() {
+    UnloadImages();
+    UnloadSounds();
+}
+
+void InGame::Activate(const GameInformation& game) {
+    World::Clear();
+
+    currentGame = game;
+
+    enemiesMetric     = Telemetry::RegisterGauge("InGame.Enemies");
+    projectilesMetric = Telemetry::RegisterGauge("InGame.Projectiles");
+    scoreValue        = Spectator::RegisterValue("Score");
+    healthValue       = Spectator::RegisterValue("Health");
+    cloudsPhase       = PerfCounters::RegisterPhase("Clouds");
+    projectilesPhase  = PerfCounters::RegisterPhase("Projectiles");
+    enemiesPhase      = PerfCounters::RegisterPhase("Enemies");
+    playerPhase       = PerfCounters::RegisterPhase("Player");
+    worldPhase        = PerfCounters::RegisterPhase("World");
+
     InitializeObjects();
     UpdateScore();
+
+    Sound::PlayMusic(backgroundMusic);
 }
 
 void InGame::Deactivate() {
     World::Clear();
+    Sound::StopMusic();
 
+    Timers::Cancel(spawnTimer);
     DeleteObjects();
-    UnloadImages();
-    UnloadSounds();
 }
 
 void InGame::InitializeObjects() {
@@ -95,6 +148,9 @@ void InGame::InitializeObjects() {
     currentEnemySpawnInterval = InGame::EnemySpawnInterval;
     enemySpawnCounter         = 0;
     isGameOver                = false;
+    isInvulnerable            = false;
+
+    Timers::Schedule(spawnTimer, Engine::GetSimulationTicks() + currentEnemySpawnInterval, OnSpawnTimer, this);
 }
 
 void InGame::DeleteObjects() {
@@ -121,29 +177,32 @@ void InGame::LoadImages() {
     score.image   = NULL;
     lifebar.image = Renderer::LoadImage("assets/images/lifebar.png");
 
-    backgroundImage                        = Renderer::LoadImage("assets/images/background.jpg");
-    overlayImage                           = Renderer::LoadImage("assets/images/overlay.png");
-    cloudImages[0]                         = Renderer::LoadImage("assets/images/cloud1.png");
-    cloudImages[1]                         = Renderer::LoadImage("assets/images/cloud2.png");
-    cloudImages[2]                         = Renderer::LoadImage("assets/images/cloud3.png");
-    cloudImages[3]                         = Renderer::LoadImage("assets/images/cloud4.png");
-    playerImages[ColoredObject::Red]       = Renderer::LoadImage("assets/images/player_red.png");
-    playerImages[ColoredObject::Green]     = Renderer::LoadImage("assets/images/player_green.png");
-    playerImages[ColoredObject::Blue]      = Renderer::LoadImage("assets/images/player_blue.png");
-    playerImages[ColoredObject::Black]     = Renderer::LoadImage("assets/images/player_black.png");
-    enemyImages[ColoredObject::Red]        = Renderer::LoadImage("assets/images/enemy_red.png");
-    enemyImages[ColoredObject::Green]      = Renderer::LoadImage("assets/images/enemy_green.png");
-    enemyImages[ColoredObject::Blue]       = Renderer::LoadImage("assets/images/enemy_blue.png");
-    enemyImages[ColoredObject::Black]      = Renderer::LoadImage("assets/images/enemy_black.png");
-    projectileImages[ColoredObject::Red]   = Renderer::LoadImage("assets/images/projectile_red.png");
-    projectileImages[ColoredObject::Green] = Renderer::LoadImage("assets/images/projectile_green.png");
-    projectileImages[ColoredObject::Blue]  = Renderer::LoadImage("assets/images/projectile_blue.png");
-    projectileImages[ColoredObject::Black] = Renderer::LoadImage("assets/images/projectile_black.png");
+    backgroundImage = Renderer::LoadImage("assets/images/background.jpg");
+    overlayImage    = Renderer::LoadImage("assets/images/overlay.png");
+    cloudImages[0]  = Renderer::LoadImage("assets/images/cloud1.png");
+    cloudImages[1]  = Renderer::LoadImage("assets/images/cloud2.png");
+    cloudImages[2]  = Renderer::LoadImage("assets/images/cloud3.png");
+    cloudImages[3]  = Renderer::LoadImage("assets/images/cloud4.png");
+    enemyImage      = Renderer::LoadImage("assets/images/enemy_base.png");
+    enemyMask       = Renderer::LoadImage("assets/images/enemy_mask.png");
+    projectileImage = Renderer::LoadImage("assets/images/projectile_base.png");
+    projectileMask  = Renderer::LoadImage("assets/images/projectile_mask.png");
+
+    Renderer::TintRegion cannonRegions[ColoredObject::MaxColors * 3];
+
+    for (uint color = 0; color < ColoredObject::MaxColors; color++) {
+        for (uint cannon = 0; cannon < 3; cannon++) {
+            cannonRegions[(color * 3) + cannon] = { CannonRects[cannon], SpriteTints[(color + ColoredObject::MaxColors + cannon - 1) % ColoredObject::MaxColors] };
+        }
+    }
+
+    Renderer::RecolorImages("assets/images/player_base.png", "assets/images/player_mask.png", cannonRegions, 3, playerImages, ColoredObject::MaxColors);
 }
 
 void InGame::UnloadImages() {
     if (score.image != NULL) {
         Renderer::UnloadImage(score.image);
+        score.image = NULL;
     }
 
     Renderer::UnloadImage(backgroundImage);
@@ -156,14 +215,17 @@ void InGame::UnloadImages() {
     Renderer::UnloadImage(cloudImages[1]);
     Renderer::UnloadImage(cloudImages[2]);
     Renderer::UnloadImage(cloudImages[3]);
-    Renderer::UnloadImage(enemyImages[ColoredObject::Red]);
-    Renderer::UnloadImage(enemyImages[ColoredObject::Green]);
-    Renderer::UnloadImage(enemyImages[ColoredObject::Blue]);
-    Renderer::UnloadImage(enemyImages[ColoredObject::Black]);
-    Renderer::UnloadImage(projectileImages[ColoredObject::Red]);
-    Renderer::UnloadImage(projectileImages[ColoredObject::Green]);
-    Renderer::UnloadImage(projectileImages[ColoredObject::Blue]);
-    Renderer::UnloadImage(projectileImages[ColoredObject::Black]);
+    Renderer::UnloadImage(enemyImage);
+    Renderer::UnloadImage(enemyMask);
+    Renderer::UnloadImage(projectileImage);
+    Renderer::UnloadImage(projectileMask);
+}
+
+// Enemies and projectiles of every color share their images, only the tint of the mask changes.
+void InGame::SetColorImages(ColoredObject& object, Image* image, Image* mask) {
+    object.image = image;
+    object.mask  = mask;
+    object.tint  = SpriteTints[object.color % ColoredObject::MaxColors];
 }
 
 void InGame::LoadSounds() {
@@ -171,13 +233,9 @@ void InGame::LoadSounds() {
     hitSound        = Sound::LoadSample("assets/sounds/hit.flac");
     clickSound      = Sound::LoadSample("assets/sounds/click.flac");
     backgroundMusic = Sound::LoadMusic("assets/sounds/background.flac");
-
-    Sound::PlayMusic(backgroundMusic);
 }
 
 void InGame::UnloadSounds() {
-    Sound::StopMusic();
-
     Sound::UnloadSample(shotSound);
     Sound::UnloadSample(hitSound);
     Sound::UnloadSample(clickSound);
@@ -194,22 +252,51 @@ void InGame::StepClouds() {
 }
 
 void InGame::StepProjectiles() {
-    static bool projectileHit = false;
+    static bool  projectileHit = false;
+    static float contactTime   = 0.0f;
+
+    // Nothing moves until the end of the step, so the swept bounds are packed once: the enemies by color (the ones
+    // each player projectile can hit) and every projectile, which are all tested against the player at once. Only the
+    // boxes that overlap go through the exact sweep. These lists only live for this step.
+    FrameVector<World::Object*> collisionTargets[ColoredObject::MaxColors];
+    Overlap::Boxes              targetBounds[ColoredObject::MaxColors];
+    Overlap::Boxes              projectileBounds;
+    FrameVector<u32>            playerHits(Overlap::MaskWords(projectiles.size()));
+
+    for (auto enemy : enemies) {
+        collisionTargets[enemy->color].push_back(enemy);
+        targetBounds[enemy->color].Add(World::SweptBounds(enemy, currentSpeedMultiplier));
+    }
+
+    projectileBounds.Reserve(projectiles.size());
+
+    for (auto projectile : projectiles) {
+        projectileBounds.Add(World::SweptBounds(projectile, currentSpeedMultiplier));
+    }
+
+    Overlap::Test(World::SweptBounds(&player, currentSpeedMultiplier), projectileBounds, playerHits.data());
 
+    // Collisions are swept over the coming step, so fast projectiles (or long steps) can not tunnel through ships.
+    uint projectileIndex    = 0;
     auto projectileIterator = projectiles.begin();
     while (projectileIterator != projectiles.end()) {
-        auto projectile = *projectileIterator;
+        auto projectile   = *projectileIterator;
+        auto isNearPlayer = Overlap::IsHit(playerHits.data(), projectileIndex++);
 
         projectileHit = false;
 
         // Check player hit.
         if (projectile->type == World::Object::Enemy) {
-            if ((projectileHit = World::CheckCollision(&player, projectile))) {
+            if ((projectileHit = isNearPlayer && World::SweepCollision(&player, projectile, currentSpeedMultiplier, contactTime)) && !isInvulnerable) {
                 player.health -= (projectile->color + 1) * 5;
 
+                Explode(*projectile, projectile->color, InGame::HitParticles, 0.5f);
+
                 lifebar.size.x = (player.health * currentGame.targetWidth) / 100.0f;
 
                 if (player.health <= 0) {
+                    Explode(player, player.color, InGame::DeathParticles, 2.0f);
+
                     isGameOver = true;
                     Sound::PlaySample(hitSound);
                     UpdateScore();
@@ -218,22 +305,24 @@ void InGame::StepProjectiles() {
                 }
             }
         } else {    // Check enemy hit.
-            for (auto enemyIterator = enemies.begin(); enemyIterator != enemies.end(); enemyIterator++) {
-                auto enemy = *enemyIterator;
+            auto& colorTargets = collisionTargets[projectile->color];
+            auto& colorBounds  = targetBounds[projectile->color];
+            auto  targetIndex  = World::FirstCollision(projectile, colorTargets.data(), colorBounds, currentSpeedMultiplier, contactTime);
 
-                if (enemy->color != projectile->color) {
-                    continue;
-                }
+            if ((projectileHit = (targetIndex >= 0))) {
+                auto enemy = static_cast<EnemyObject*>(colorTargets[targetIndex]);
 
-                if ((projectileHit = World::CheckCollision(enemy, projectile))) {
-                    World::RemoveObject(enemy);
-                    enemies.erase(enemyIterator);
-                    delete enemy;
+                // The enemy is gone, its box must not match the next projectiles.
+                colorBounds.Remove(targetIndex);
 
-                    player.score += (projectile->color + 1) * 5;
-                    UpdateScore();
-                    break;
-                }
+                Explode(*enemy, enemy->color, InGame::ExplosionParticles, 1.0f);
+
+                World::RemoveObject(enemy);
+                enemies.erase(std::find(enemies.begin(), enemies.end(), enemy));
+                delete enemy;
+
+                player.score += (projectile->color + 1) * 5;
+                UpdateScore();
             }
         }
 
@@ -253,13 +342,6 @@ void InGame::StepProjectiles() {
 }
 
 void InGame::StepEnemies() {
-    static int nextEnemySpawn = currentTick + currentEnemySpawnInterval;
-
-    if (currentTick >= nextEnemySpawn) {
-        nextEnemySpawn = currentTick + currentEnemySpawnInterval;
-        SpawnEnemy();
-    }
-
     auto enemyIterator = enemies.begin();
     while (enemyIterator != enemies.end()) {
         auto enemy = *enemyIterator;
@@ -278,29 +360,67 @@ void InGame::StepEnemies() {
             enemy->speed.x = InGame::EnemySpeed;
         }
 
-        if (currentTick > enemy->nextShot) {
-            enemy->nextShot = currentTick + enemy->shotInterval;
-            Shoot(enemy, 1);
-        }
-
         enemyIterator++;
     }
 }
 
+void InGame::Explode(const World::Object& object, const uint color, const uint numberOfParticles, const f32 strength) {
+    Particles::Style style = { 1.0f * strength, 8.0f * strength, 10.0f, 20.0f + (20.0f * strength), 4.0f + (2.0f * strength), EffectColors[color % ColoredObject::MaxColors] };
+    Vector2D         center = { object.position.x + (object.size.x / 2.0f), object.position.y + (object.size.y / 2.0f) };
+
+    Particles::Burst(Game::ShipLayer, center, numberOfParticles, style);
+}
+
 void InGame::Step(const float speedMultiplier) {
+    // Effects keep playing on the game over screen.
+    Particles::Update(speedMultiplier);
+
     if (isGameOver) {
         return;
     }
 
     currentSpeedMultiplier = speedMultiplier;
-    currentTick            = Engine::GetTicks();
 
+    // Each part is a phase of its own when hardware counters are on, counted per object it went through.
+    if (PerfCounters::IsEnabled()) {
+        uint worldObjects = 0;
+
+        for (auto layer : World::GetLayers()) {
+            worldObjects += layer->objects.size();
+        }
+
+        PerfCounters::AddObjects(cloudsPhase, clouds.size());
+        PerfCounters::AddObjects(projectilesPhase, projectiles.size());
+        PerfCounters::AddObjects(enemiesPhase, enemies.size());
+        PerfCounters::AddObjects(playerPhase, 1);
+        PerfCounters::AddObjects(worldPhase, worldObjects);
+    }
+
+    PerfCounters::BeginPhase(cloudsPhase);
     StepClouds();
+    PerfCounters::EndPhase(cloudsPhase);
+
+    PerfCounters::BeginPhase(projectilesPhase);
     StepProjectiles();
+    PerfCounters::EndPhase(projectilesPhase);
+
+    PerfCounters::BeginPhase(enemiesPhase);
     StepEnemies();
+    PerfCounters::EndPhase(enemiesPhase);
+
+    PerfCounters::BeginPhase(playerPhase);
     StepPlayer();
+    PerfCounters::EndPhase(playerPhase);
 
+    PerfCounters::BeginPhase(worldPhase);
     World::Update(speedMultiplier);
+    PerfCounters::EndPhase(worldPhase);
+
+    Telemetry::Set(enemiesMetric, enemies.size());
+    Telemetry::Set(projectilesMetric, projectiles.size());
+
+    Spectator::SetValue(scoreValue, player.score);
+    Spectator::SetValue(healthValue, player.health);
 }
 
 void InGame::StepPlayer() {
@@ -336,7 +456,8 @@ void InGame::Shoot(const ColoredObject* source, const int direction) {
     projectile->size.y     = InGame::ProjectileHeight;
     projectile->speed.x    = 0.0f;
     projectile->speed.y    = InGame::ProjectileSpeed * direction;
-    projectile->image      = projectileImages[projectile->color];
+
+    SetColorImages(*projectile, projectileImage, projectileMask);
 
     projectiles.push_back(projectile);
     World::AddObject(Game::ProjectileLayer, projectile);
@@ -356,19 +477,48 @@ void InGame::SpawnEnemy() {
     enemy->position.y      = -InGame::ShipHeight;
     enemy->speedMultiplier = 1.0f + (F32(Engine::RandomNumber(0, 100)) / 100.f);
     enemy->shotInterval    = Engine::RandomNumber(InGame::EnemyShootInterval * 0.9f, InGame::EnemyShootInterval * 1.5f);
-    enemy->nextShot        = currentTick + enemy->shotInterval;
     enemy->yStop           = InGame::VerticalPadding * (Engine::RandomNumber(10, 20) / 10.0f);
-    enemy->image           = enemyImages[enemy->color];
-
-    enemySpawnCounter++;
 
-    if (enemySpawnCounter > InGame::EnemySpawnThreshold) {
-        enemySpawnCounter = 0;
-        currentEnemySpawnInterval *= 0.9;
-    }
+    SetColorImages(*enemy, enemyImage, enemyMask);
 
     enemies.push_back(enemy);
     World::AddObject(ShipLayer, enemy);
+
+    Timers::Schedule(enemy->shotTimer, Timers::GetCurrentTick() + enemy->shotInterval, OnShotTimer, this, enemy);
+}
+
+// Timers
+
+// Both timers stop on game over, restarting the game schedules them again.
+
+void InGame::OnSpawnTimer(void* context, void* argument) {
+    auto inGame = static_cast<InGame*>(context);
+
+    if (inGame->isGameOver) {
+        return;
+    }
+
+    Timers::Schedule(inGame->spawnTimer, inGame->spawnTimer.GetDeadline() + inGame->currentEnemySpawnInterval, OnSpawnTimer, inGame);
+    inGame->SpawnEnemy();
+
+    inGame->enemySpawnCounter++;
+
+    if (inGame->enemySpawnCounter > InGame::EnemySpawnThreshold) {
+        inGame->enemySpawnCounter = 0;
+        inGame->currentEnemySpawnInterval *= 0.9;
+    }
+}
+
+void InGame::OnShotTimer(void* context, void* argument) {
+    auto inGame = static_cast<InGame*>(context);
+    auto enemy  = static_cast<EnemyObject*>(argument);
+
+    if (inGame->isGameOver) {
+        return;
+    }
+
+    Timers::Schedule(enemy->shotTimer, enemy->shotTimer.GetDeadline() + enemy->shotInterval, OnShotTimer, inGame, enemy);
+    inGame->Shoot(enemy, 1);
 }
 
 void InGame::OnPress(const uint key) {
@@ -426,7 +576,7 @@ void InGame::OnPress(const uint key) {
 void InGame::OnRelease(const uint key) {
     switch (key) {
         case Input::KeyEscape: {
-            Engine::ChangeState(Splash::Name);
+            Engine::ChangeState(Splash::Id);
             break;
         }
 
@@ -462,16 +612,265 @@ void InGame::OnRelease(const uint key) {
     }
 }
 
+// Scripting
+
+void InGame::SpawnEnemies(const uint count) {
+    for (uint enemyIndex = 0; enemyIndex < count; enemyIndex++) {
+        SpawnEnemy();
+    }
+}
+
+void InGame::FireEnemyProjectiles(const uint count) {
+    if (enemies.empty()) {
+        return;
+    }
+
+    for (uint projectileIndex = 0; projectileIndex < count; projectileIndex++) {
+        Shoot(enemies[Engine::RandomNumber(0, enemies.size() - 1)], 1);
+    }
+}
+
+void InGame::FirePlayerProjectiles(const uint count) {
+    for (uint projectileIndex = 0; projectileIndex < count; projectileIndex++) {
+        Shoot(&player, -1);
+    }
+}
+
+void InGame::SetInvulnerable(const bool invulnerable) {
+    isInvulnerable = invulnerable;
+}
+
+uint InGame::NumberOfEnemies() const {
+    return enemies.size();
+}
+
+uint InGame::NumberOfProjectiles() const {
+    return projectiles.size();
+}
+
+bool InGame::IsGameOver() const {
+    return isGameOver;
+}
+
+const PlayerObject& InGame::GetPlayer() const {
+    return player;
+}
+
+const std::vector<EnemyObject*>& InGame::GetEnemies() const {
+    return enemies;
+}
+
+const std::vector<ColoredObject*>& InGame::GetProjectiles() const {
+    return projectiles;
+}
+
+// Snapshots
+
+static void SaveObject(Snapshot& snapshot, const World::Object& object) {
+    snapshot.Write(object.position);
+    snapshot.Write(object.size);
+    snapshot.Write(object.speed);
+    snapshot.Write(object.speedMultiplier);
+}
+
+static bool RestoreObject(const Snapshot& snapshot, World::Object& object) {
+    return snapshot.Read(object.position) && snapshot.Read(object.size) && snapshot.Read(object.speed) && snapshot.Read(object.speedMultiplier);
+}
+
+// Objects are reused between restores, only the difference in count is allocated or deleted.
+template <typename T, typename... Arguments> static void ResizeObjects(std::vector<T*>& objects, const uint count, Arguments... arguments) {
+    while (objects.size() > count) {
+        delete objects.back();
+        objects.pop_back();
+    }
+
+    while (objects.size() < count) {
+        objects.push_back(new T(arguments...));
+    }
+}
+
+void InGame::SaveSnapshot(Snapshot& snapshot) const {
+    auto simulationTick = I32(Engine::GetSimulationTicks());
+
+    snapshot.Begin(InGame::SnapshotVersion);
+
+    // General
+
+    snapshot.Write(Engine::GetRandomState());
+    snapshot.Write(U8(isGameOver ? 1 : 0));
+    snapshot.Write(I32(currentEnemySpawnInterval));
+    snapshot.Write(I32(spawnTimer.GetDeadline() - simulationTick));
+    snapshot.Write(I32(enemySpawnCounter));
+
+    // Player
+
+    SaveObject(snapshot, player);
+    snapshot.Write(U32(player.color));
+    snapshot.Write(I32(player.health));
+    snapshot.Write(I32(player.score));
+
+    // Clouds
+
+    snapshot.Write(U32(clouds.size()));
+
+    for (auto cloud : clouds) {
+        SaveObject(snapshot, *cloud);
+        snapshot.Write(cloud->distance);
+        snapshot.Write(U32(std::find(cloudImages, cloudImages + 4, cloud->image) - cloudImages));
+    }
+
+    // Enemies
+
+    snapshot.Write(U32(enemies.size()));
+
+    for (auto enemy : enemies) {
+        SaveObject(snapshot, *enemy);
+        snapshot.Write(U32(enemy->color));
+        snapshot.Write(I32(enemy->shotInterval));
+        snapshot.Write(I32(enemy->shotTimer.GetDeadline() - simulationTick));
+        snapshot.Write(I32(enemy->yStop));
+    }
+
+    // Projectiles
+
+    snapshot.Write(U32(projectiles.size()));
+
+    for (auto projectile : projectiles) {
+        SaveObject(snapshot, *projectile);
+        snapshot.Write(U32(projectile->type));
+        snapshot.Write(U32(projectile->color));
+    }
+
+    snapshot.End();
+}
+
+bool InGame::RestoreSnapshot(const Snapshot& snapshot) {
+    if (!snapshot.Open(InGame::SnapshotVersion)) {
+        return false;
+    }
+
+    auto simulationTick = I32(Engine::GetSimulationTicks());
+    auto previousScore  = player.score;
+    bool wasGameOver    = isGameOver;
+
+    u64 randomState;
+    u8  gameOver;
+    i32 spawnInterval, spawnDelay, spawnCounter;
+    u32 color, type, imageIndex, numberOfObjects;
+
+    // General
+
+    if (!snapshot.Read(randomState) || !snapshot.Read(gameOver) || !snapshot.Read(spawnInterval) || !snapshot.Read(spawnDelay) || !snapshot.Read(spawnCounter)) {
+        return false;
+    }
+
+    Engine::SetRandomState(randomState);
+
+    isGameOver                = gameOver != 0;
+    currentEnemySpawnInterval = spawnInterval;
+    enemySpawnCounter         = spawnCounter;
+
+    Timers::Schedule(spawnTimer, simulationTick + spawnDelay, OnSpawnTimer, this);
+
+    World::Clear();
+    World::SetLayerBackground(Game::BackgroundLayer, backgroundImage);
+    World::SetLayerBackground(Game::OverlayLayer, overlayImage);
+
+    // Player
+
+    if (!RestoreObject(snapshot, player) || !snapshot.Read(color) || !snapshot.Read(player.health) || !snapshot.Read(player.score)) {
+        return false;
+    }
+
+    player.color = color % ColoredObject::MaxColors;
+    player.image = playerImages[player.color];
+
+    World::AddObject(Game::ShipLayer, &player);
+
+    if (lifebar.image != NULL) {
+        lifebar.size.x = (player.health * currentGame.targetWidth) / 100.0f;
+        World::AddObject(Game::HUDLayer, &lifebar);
+    }
+
+    World::AddObject(Game::HUDLayer, &score);
+
+    // Clouds
+
+    if (!snapshot.Read(numberOfObjects)) {
+        return false;
+    }
+
+    ResizeObjects(clouds, numberOfObjects);
+
+    for (auto cloud : clouds) {
+        if (!RestoreObject(snapshot, *cloud) || !snapshot.Read(cloud->distance) || !snapshot.Read(imageIndex)) {
+            return false;
+        }
+
+        cloud->image = cloudImages[imageIndex % 4];
+        World::AddObject(cloud->distance > 1.0f ? Game::LowCloudsLayer : Game::HighCloudsLayer, cloud);
+    }
+
+    // Enemies
+
+    if (!snapshot.Read(numberOfObjects)) {
+        return false;
+    }
+
+    ResizeObjects(enemies, numberOfObjects);
+
+    for (auto enemy : enemies) {
+        i32 shotDelay;
+
+        if (!RestoreObject(snapshot, *enemy) || !snapshot.Read(color) || !snapshot.Read(enemy->shotInterval) || !snapshot.Read(shotDelay) || !snapshot.Read(enemy->yStop)) {
+            return false;
+        }
+
+        enemy->color = color % ColoredObject::MaxColors;
+        SetColorImages(*enemy, enemyImage, enemyMask);
+
+        Timers::Schedule(enemy->shotTimer, simulationTick + shotDelay, OnShotTimer, this, enemy);
+        World::AddObject(Game::ShipLayer, enemy);
+    }
+
+    // Projectiles
+
+    if (!snapshot.Read(numberOfObjects)) {
+        return false;
+    }
+
+    ResizeObjects(projectiles, numberOfObjects, World::Object::Enemy);
+
+    for (auto projectile : projectiles) {
+        if (!RestoreObject(snapshot, *projectile) || !snapshot.Read(type) || !snapshot.Read(color)) {
+            return false;
+        }
+
+        projectile->type  = type == World::Object::Player ? World::Object::Player : World::Object::Enemy;
+        projectile->color = color % ColoredObject::MaxColors;
+        SetColorImages(*projectile, projectileImage, projectileMask);
+
+        World::AddObject(Game::ProjectileLayer, projectile);
+    }
+
+    // The score text is the only thing that needs rendering, skip it when it did not change.
+    if ((player.score != previousScore) || (isGameOver != wasGameOver)) {
+        UpdateScore();
+    }
+
+    return true;
+}
+
 void InGame::UpdateScore() {
     if (score.image != NULL) {
         Renderer::UnloadImage(score.image);
     }
 
     if (isGameOver) {
-        score.image      = Renderer::TextImage("GAME OVER | YOU SCORED " + std::to_string(player.score) + " | PRESS <ENTER> TO RESTART");
+        score.image      = Renderer::TextImage(FrameArena::Format(Txt::GameOverText, player.score));
         score.position.y = (currentGame.targetHeight - score.image->height) / 2.0f;
     } else {
-        score.image      = Renderer::TextImage("SCORE: " + std::to_string(player.score));
+        score.image      = Renderer::TextImage(FrameArena::Format(Txt::ScoreText, player.score));
         score.position.y = InGame::ScorePadding;
     }
 
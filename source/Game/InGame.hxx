@@ -9,6 +9,8 @@
 #define BIQ_GAME_INGAME_HXX
 
 #include "Engine/Engine.hxx"
+#include "Engine/Snapshot.hxx"
+#include "Engine/Timers.hxx"
 #include "Engine/World.hxx"
 
 namespace Biq {
@@ -47,9 +49,9 @@ class EnemyObject : public ColoredObject {
             ColoredObject(World::Object::Enemy) {
         }
 
-        int shotInterval;
-        int nextShot;
-        int yStop;
+        int           shotInterval;
+        int           yStop;
+        Timers::Timer shotTimer;
 };
 
 class CloudObject : public World::Object {
@@ -79,10 +81,24 @@ enum {
     MaxLayers
 };
 
+// The background, HUD and overlay never move, clouds and projectiles come and go in any order, ships keep theirs.
+typedef World::Layout<
+    World::StaticLayer,     // BackgroundLayer
+    World::DynamicLayer,    // LowCloudsLayer
+    World::DynamicLayer,    // ProjectileLayer
+    World::SortedLayer,     // ShipLayer
+    World::DynamicLayer,    // HighCloudsLayer
+    World::StaticLayer,     // HUDLayer
+    World::StaticLayer      // OverlayLayer
+> Layers;
+
+static_assert(Layers::NumberOfLayers == MaxLayers, "Every layer needs a policy");
+
 class InGame : public State {
     public:
         static constexpr charconst Tag  = "InGame";
         static constexpr charconst Name = "INGAME";
+        static constexpr uint      Id   = 1;
 
         static constexpr int ShipWidth  = 72;
         static constexpr int ShipHeight = 72;
@@ -109,25 +125,60 @@ class InGame : public State {
         static constexpr int LifebarHeight = 32;
         static constexpr int ScorePadding  = 8;
 
+        static constexpr uint HitParticles       = 16;
+        static constexpr uint ExplosionParticles = 64;
+        static constexpr uint DeathParticles     = 384;
+
+        static constexpr u32 SnapshotVersion = 1;
+
+        void Prepare(const GameInformation& game);
+        void Release();
         void Activate(const GameInformation& game);
         void Deactivate();
         void Step(const float speedMultiplier);
         void OnPress(const uint key);
         void OnRelease(const uint key);
 
+        // Scripting
+
+        void SpawnEnemies(const uint count);
+        void FireEnemyProjectiles(const uint count);
+        void FirePlayerProjectiles(const uint count);
+        void SetInvulnerable(const bool invulnerable);
+
+        uint NumberOfEnemies() const;
+        uint NumberOfProjectiles() const;
+
+        bool                               IsGameOver() const;
+        const PlayerObject&                GetPlayer() const;
+        const std::vector<EnemyObject*>&   GetEnemies() const;
+        const std::vector<ColoredObject*>& GetProjectiles() const;
+
+        // Snapshots
+
+        // Everything the simulation depends on is saved (objects, timers and the random generator state), timers are
+        // stored relative to the simulation clock. Restoring only fails on snapshots from another build or corrupted
+        // ones, in which case the game is left in an undefined state until a valid snapshot is restored.
+        void SaveSnapshot(Snapshot& snapshot) const;
+        bool RestoreSnapshot(const Snapshot& snapshot);
+
     private:
         std::atomic<bool> isGameOver;
+        bool              isInvulnerable;
         GameInformation   currentGame;
 
         Image* backgroundImage;
         Image* overlayImage;
         Image* cloudImages[4];
         Image* playerImages[ColoredObject::MaxColors];
-        Image* enemyImages[ColoredObject::MaxColors];
-        Image* projectileImages[ColoredObject::MaxColors];
+        Image* enemyImage;
+        Image* enemyMask;
+        Image* projectileImage;
+        Image* projectileMask;
 
         void LoadImages();
         void UnloadImages();
+        void SetColorImages(ColoredObject& object, Image* image, Image* mask);
 
         void* shotSound;
         void* hitSound;
@@ -138,8 +189,8 @@ class InGame : public State {
         void UnloadSounds();
 
         float            currentSpeedMultiplier;
-        int              currentTick;
         int              currentEnemySpawnInterval;
+        Timers::Timer    spawnTimer;
         std::atomic<int> enemySpawnCounter;
 
         WorldObject lifebar;
@@ -150,6 +201,18 @@ class InGame : public State {
         std::vector<ColoredObject*> projectiles;
         std::vector<CloudObject*>   clouds;
 
+        uint enemiesMetric;
+        uint projectilesMetric;
+        uint scoreValue;
+        uint healthValue;
+        uint cloudsPhase;
+        uint projectilesPhase;
+        uint enemiesPhase;
+        uint playerPhase;
+        uint worldPhase;
+
+        void Explode(const World::Object& object, const uint color, const uint numberOfParticles, const f32 strength);
+
         void InitializeObjects();
         void DeleteObjects();
 
@@ -161,6 +224,9 @@ class InGame : public State {
         void Shoot(const ColoredObject* source, const int direction);
         void SpawnEnemy();
         void UpdateScore();
+
+        static void OnSpawnTimer(void* context, void* argument);
+        static void OnShotTimer(void* context, void* argument);
 };
 
 }    // namespace Game
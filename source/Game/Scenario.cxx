@@ -0,0 +1,285 @@
+/*
+ * Source/Game/Scenario.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Game/Scenario.hxx"
+
+#include <cstring>
+#include <ctime>
+
+namespace Biq {
+namespace Game {
+
+// String Table
+
+namespace Txt {
+static const charconst CouldNotOpenScenario = "Could not open the scenario file \"%s\"";
+static const charconst InvalidCommand       = "Invalid command at %s:%d: %s";
+static const charconst ScenarioLoaded       = "Scenario \"%s\" loaded with %d commands";
+static const charconst PhaseStarted         = "Phase \"%s\" started (%d enemies, %d projectiles)";
+static const charconst PhaseReport          = "Phase \"%s\": %d frames, p50 %.2f ms, p99 %.2f ms, max %.2f ms";
+static const charconst BudgetExceeded       = "Phase \"%s\" exceeded the %s budget: %.2f ms > %.2f ms";
+static const charconst ScenarioPassed       = "Scenario passed";
+static const charconst ScenarioFailed       = "Scenario failed";
+static const charconst DefaultPhase         = "default";
+}    // namespace Txt
+
+static const charconst BudgetNames[Scenario::MaxBudgets] = { "p50", "p99", "max" };
+
+// General
+
+Scenario::Scenario(InGame& inGame) :
+    inGame(inGame), randomSeed(UINT(time(NULL))), hasFailed(false) {
+    for (auto& budget : budgets) {
+        budget = 0.0;
+    }
+}
+
+bool Scenario::Load(const string& filePath) {
+    auto scenarioFile = fopen(filePath.c_str(), "r");
+
+    if (scenarioFile == NULL) {
+        ERROR(Txt::CouldNotOpenScenario, filePath.c_str());
+        return false;
+    }
+
+    char line[256];
+    char name[128];
+    char argument[128];
+    f64  value;
+    int  lineNumber = 0;
+
+    commands.clear();
+    scenarioPath = filePath;
+
+    while (fgets(line, sizeof(line), scenarioFile) != NULL) {
+        lineNumber++;
+
+        if (auto comment = strchr(line, '#')) {
+            *comment = 0;
+        }
+
+        auto numberOfFields = sscanf(line, "%127s %127s %lf", name, argument, &value);
+
+        if (numberOfFields <= 0) {
+            continue;
+        }
+
+        string command = name;
+        bool   isValid = true;
+
+        if ((command == "seed") && (numberOfFields >= 2)) {
+            randomSeed = strtoul(argument, NULL, 10);
+        } else if ((command == "budget") && (numberOfFields == 3)) {
+            isValid = false;
+
+            for (uint budget = 0; budget < Scenario::MaxBudgets; budget++) {
+                if (strcmp(argument, BudgetNames[budget]) == 0) {
+                    // Budgets given on the command line win over the scenario ones.
+                    if (budgets[budget] <= 0.0) {
+                        budgets[budget] = value;
+                    }
+
+                    isValid = true;
+                }
+            }
+        } else if ((command == "phase") && (numberOfFields >= 2)) {
+            commands.push_back({ PhaseCommand, argument, 0.0 });
+        } else if ((command == "invulnerable") && (numberOfFields >= 2)) {
+            commands.push_back({ InvulnerableCommand, argument, strcmp(argument, "off") == 0 ? 0.0 : 1.0 });
+        } else if ((command == "spawn") && (numberOfFields >= 2)) {
+            commands.push_back({ SpawnCommand, string(), atof(argument) });
+        } else if ((command == "fire") && (numberOfFields >= 2)) {
+            commands.push_back({ FireCommand, string(), atof(argument) });
+        } else if ((command == "shoot") && (numberOfFields >= 2)) {
+            commands.push_back({ ShootCommand, string(), atof(argument) });
+        } else if ((command == "hold") && (numberOfFields >= 2)) {
+            commands.push_back({ HoldCommand, string(), atof(argument) });
+        } else {
+            isValid = false;
+        }
+
+        if (!isValid) {
+            ERROR(Txt::InvalidCommand, filePath.c_str(), lineNumber, line);
+            fclose(scenarioFile);
+            return false;
+        }
+    }
+
+    fclose(scenarioFile);
+
+    INFO(Txt::ScenarioLoaded, filePath.c_str(), commands.size());
+    return true;
+}
+
+void Scenario::SetBudget(const uint budget, const f64 milliseconds) {
+    if (budget < Scenario::MaxBudgets) {
+        budgets[budget] = milliseconds;
+    }
+}
+
+bool Scenario::HasFailed() const {
+    return hasFailed;
+}
+
+// State
+
+void Scenario::Prepare(const GameInformation& game) {
+    inGame.Prepare(game);
+}
+
+void Scenario::Release() {
+    inGame.Release();
+}
+
+void Scenario::Activate(const GameInformation& game) {
+    Engine::SetRandomSeed(randomSeed);
+
+    inGame.Activate(game);
+    inGame.SetInvulnerable(true);
+
+    phases.clear();
+    phases.push_back({ Txt::DefaultPhase, std::vector<f32>() });
+
+    nextCommand              = 0;
+    holdUntil                = 0.0;
+    isFirstFrame             = true;
+    lastSimulationTime       = F64(Engine::GetSimulationTicks());
+    enemyFireRate            = 0.0;
+    playerFireRate           = 0.0;
+    pendingEnemyProjectiles  = 0.0;
+    pendingPlayerProjectiles = 0.0;
+    hasFailed                = false;
+}
+
+void Scenario::Deactivate() {
+    inGame.Deactivate();
+}
+
+void Scenario::Step(const float speedMultiplier) {
+    auto simulationTime = F64(Engine::GetSimulationTicks());
+    auto stepTime       = simulationTime - lastSimulationTime;
+
+    lastSimulationTime = simulationTime;
+
+    // Commands follow the simulation clock, so lockstep runs play the same scenario frame by frame.
+    if (!RunCommands(simulationTime)) {
+        Finish();
+        return;
+    }
+
+    pendingEnemyProjectiles += enemyFireRate * (stepTime / 1000.0);
+    pendingPlayerProjectiles += playerFireRate * (stepTime / 1000.0);
+
+    if (pendingEnemyProjectiles >= 1.0) {
+        inGame.FireEnemyProjectiles(UINT(pendingEnemyProjectiles));
+        pendingEnemyProjectiles -= UINT(pendingEnemyProjectiles);
+    }
+
+    if (pendingPlayerProjectiles >= 1.0) {
+        inGame.FirePlayerProjectiles(UINT(pendingPlayerProjectiles));
+        pendingPlayerProjectiles -= UINT(pendingPlayerProjectiles);
+    }
+
+    inGame.Step(speedMultiplier);
+}
+
+void Scenario::OnPress(const uint key) {
+    // Empty
+}
+
+void Scenario::OnRelease(const uint key) {
+    if (key == Input::KeyEscape) {
+        hasFailed = true;
+        Engine::Stop();
+    }
+}
+
+// Frames are measured by the engine, once each whatever the number of steps they ran (fixed rates catch up or wait).
+// The frame the scenario was activated in is left out, it switched states.
+void Scenario::OnFrame(const f64 frameTime) {
+    if (isFirstFrame) {
+        isFirstFrame = false;
+        return;
+    }
+
+    if (nextCommand > 0) {
+        phases.back().frameTimes.push_back(frameTime);
+    }
+}
+
+// Commands
+
+bool Scenario::RunCommands(const f64 simulationTime) {
+    if (simulationTime < holdUntil) {
+        return true;
+    }
+
+    while (nextCommand < commands.size()) {
+        auto& command = commands[nextCommand++];
+
+        switch (command.type) {
+            case PhaseCommand: {
+                // Frames measured before the first explicit phase belong to the default one, drop it if it is empty.
+                if ((phases.size() == 1) && phases.back().frameTimes.empty()) {
+                    phases.clear();
+                }
+
+                phases.push_back({ command.argument, std::vector<f32>() });
+                INFO(Txt::PhaseStarted, command.argument.c_str(), inGame.NumberOfEnemies(), inGame.NumberOfProjectiles());
+                break;
+            }
+
+            case SpawnCommand: inGame.SpawnEnemies(UINT(command.value)); break;
+            case FireCommand: enemyFireRate = command.value; break;
+            case ShootCommand: playerFireRate = command.value; break;
+            case InvulnerableCommand: inGame.SetInvulnerable(command.value != 0.0); break;
+
+            case HoldCommand: {
+                holdUntil = simulationTime + (command.value * 1000.0);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void Scenario::Finish() {
+    for (auto& phase : phases) {
+        if (phase.frameTimes.empty()) {
+            continue;
+        }
+
+        std::sort(phase.frameTimes.begin(), phase.frameTimes.end());
+
+        f64 results[Scenario::MaxBudgets] = {
+            phase.frameTimes[phase.frameTimes.size() / 2],
+            phase.frameTimes[(phase.frameTimes.size() * 99) / 100],
+            phase.frameTimes.back(),
+        };
+
+        INFO(Txt::PhaseReport, phase.name.c_str(), phase.frameTimes.size(), results[BudgetP50], results[BudgetP99], results[BudgetMax]);
+
+        for (uint budget = 0; budget < Scenario::MaxBudgets; budget++) {
+            if ((budgets[budget] > 0.0) && (results[budget] > budgets[budget])) {
+                ERROR(Txt::BudgetExceeded, phase.name.c_str(), BudgetNames[budget], results[budget], budgets[budget]);
+                hasFailed = true;
+            }
+        }
+    }
+
+    if (hasFailed) {
+        ERROR(Txt::ScenarioFailed);
+    } else {
+        INFO(Txt::ScenarioPassed);
+    }
+
+    Engine::Stop();
+}
+
+}    // namespace Game
+}    // namespace Biq
@@ -0,0 +1,102 @@
+/*
+ * Source/Game/Scenario.hxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef BIQ_GAME_SCENARIO_HXX
+#define BIQ_GAME_SCENARIO_HXX
+
+#include "Engine/Engine.hxx"
+#include "Game/InGame.hxx"
+
+namespace Biq {
+namespace Game {
+
+// Scenario files drive InGame through scripted load phases and gate the resulting frame times. One command per line,
+// "#" starts a comment:
+//
+//   seed <number>                  random seed, applied before the game is set up
+//   budget <p50|p99|max> <ms>      frame time budget checked for every phase
+//   invulnerable <on|off>          keeps the player alive (on by default)
+//   phase <name>                   starts a new measured phase
+//   spawn <count>                  spawns enemies right away
+//   fire <per second>              enemy projectiles fired per second, on top of the regular enemy fire
+//   shoot <per second>             player projectiles fired per second
+//   hold <seconds>                 keeps running the current phase
+
+class Scenario : public State {
+    public:
+        static constexpr charconst Tag  = "Scenario";
+        static constexpr charconst Name = "SCENARIO";
+        static constexpr uint      Id   = 2;
+
+        enum {
+            BudgetP50 = 0,
+            BudgetP99,
+            BudgetMax,
+            MaxBudgets
+        };
+
+        Scenario(InGame& inGame);
+
+        bool Load(const string& filePath);
+        void SetBudget(const uint budget, const f64 milliseconds);
+        bool HasFailed() const;
+
+        void Prepare(const GameInformation& game);
+        void Release();
+        void Activate(const GameInformation& game);
+        void Deactivate();
+        void Step(const float speedMultiplier);
+        void OnPress(const uint key);
+        void OnRelease(const uint key);
+        void OnFrame(const f64 frameTime);
+
+    private:
+        enum CommandType {
+            PhaseCommand = 0,
+            SpawnCommand,
+            FireCommand,
+            ShootCommand,
+            HoldCommand,
+            InvulnerableCommand
+        };
+
+        struct Command {
+            CommandType type;
+            string      argument;
+            f64         value;
+        };
+
+        struct Phase {
+            string           name;
+            std::vector<f32> frameTimes;
+        };
+
+        InGame&              inGame;
+        string               scenarioPath;
+        std::vector<Command> commands;
+        std::vector<Phase>   phases;
+        uint                 randomSeed;
+        f64                  budgets[MaxBudgets];
+        bool                 hasFailed;
+
+        uint nextCommand;
+        f64  holdUntil;
+        bool isFirstFrame;
+        f64  lastSimulationTime;
+        f64  enemyFireRate;
+        f64  playerFireRate;
+        f64  pendingEnemyProjectiles;
+        f64  pendingPlayerProjectiles;
+
+        bool RunCommands(const f64 simulationTime);
+        void Finish();
+};
+
+}    // namespace Game
+}    // namespace Biq
+
+#endif    // BIQ_GAME_SCENARIO_HXX
@@ -14,18 +14,28 @@
 namespace Biq {
 namespace Game {
 
-void Splash::Activate(const GameInformation&) {
+void Splash::Prepare(const GameInformation&) {
     splashImage = Renderer::LoadImage("assets/images/splash.jpg");
+}
+
+void Splash::Release() {
+    Renderer::UnloadImage(splashImage);
+}
+
+void Splash::Activate(const GameInformation&) {
     World::Clear();
+    World::SetLayerBackground(0, splashImage);
+
+    // Get the game ready while the player looks at the splash screen.
+    Engine::PrepareState(InGame::Id);
 }
 
 void Splash::Deactivate() {
     World::Clear();
-    Renderer::UnloadImage(splashImage);
 }
 
 void Splash::Step(const float speedMultiplier) {
-    World::SetLayerBackground(0, splashImage);
+    // Empty
 }
 
 void Splash::OnPress(const uint key) {
@@ -40,7 +50,7 @@ void Splash::OnRelease(const uint key) {
         }
 
         case Input::KeyEnter: {
-            Engine::ChangeState(InGame::Name);
+            Engine::ChangeState(InGame::Id);
             break;
         }
     }
@@ -19,7 +19,10 @@ class Splash : public State {
 
         static constexpr charconst Tag  = "Splash";
         static constexpr charconst Name = "SPLASH";
+        static constexpr uint      Id   = 0;
 
+        void Prepare(const GameInformation& game);
+        void Release();
         void Activate(const GameInformation& game);
         void Deactivate();
         void Step(const float speedMultiplier);
@@ -1,21 +1,240 @@
+#include "Engine/Allocations.hxx"
+#include "Engine/Capture.hxx"
+#include "Engine/DrawRecorder.hxx"
 #include "Engine/Engine.hxx"
+#include "Engine/Overdraw.hxx"
+#include "Engine/PerfCounters.hxx"
+#include "Engine/Renderer.hxx"
+#include "Engine/Spectator.hxx"
+#include "Engine/Telemetry.hxx"
+#include "Game/Autopilot.hxx"
 #include "Game/InGame.hxx"
+#include "Game/Scenario.hxx"
 #include "Game/Splash.hxx"
 
 int main(int numberOfArguments, char** argumentsValues) {
     static constexpr char const* gameName = "Biq Invaders";
 
-    if (!Biq::Engine::Initialize({ const_cast<char*>(gameName), 1280, 720, 30, Biq::Game::MaxLayers })) {
+    Biq::string telemetryPath;
+    Biq::string scenarioPath;
+    Biq::string spectatorPath;
+    Biq::string capturePath;
+    Biq::string goldenPath;
+    Biq::string recordPath;
+    Biq::string replayPath;
+    Biq::string drawRecordPath;
+    Biq::string overdrawPath;
+    bool        isHeadless = false;
+    double      budgets[Biq::Game::Scenario::MaxBudgets] = { 0.0, 0.0, 0.0 };
+    double      minimumScale     = 1.0;
+    double      maximumScale     = 1.0;
+    double      frameBudget      = 0.0;
+    int         imageLevels      = Biq::Renderer::DefaultImageLevels;
+    double      levelBias        = 0.0;
+    int         stepRate         = 0;
+    bool        isLockstep       = false;
+    int         captureInterval  = 1;
+    bool        isRawCapture     = false;
+    int         goldenTolerance  = Biq::Capture::DefaultTolerance;
+    double      goldenMismatch   = Biq::Capture::DefaultMaxMismatch * 100.0;
+    bool        isTrackingMemory = false;
+    int         warmupFrames     = 0;
+    bool        isAutopilot      = false;
+    int         autopilotSeed    = -1;
+    bool        isAutoRestart    = false;
+    double      autopilotTime    = 0.0;
+    bool        isPartialRedraw  = false;
+    int         perfFrames       = 0;
+
+    for (int argumentIndex = 1; argumentIndex < numberOfArguments; argumentIndex++) {
+        Biq::string argument = argumentsValues[argumentIndex];
+        bool        hasValue = argumentIndex + 1 < numberOfArguments;
+
+        if (argument == "--headless") {
+            isHeadless = true;
+        } else if ((argument == "--telemetry") && hasValue) {
+            telemetryPath = argumentsValues[++argumentIndex];
+        } else if ((argument == "--spectator") && hasValue) {
+            spectatorPath = argumentsValues[++argumentIndex];
+        } else if ((argument == "--scenario") && hasValue) {
+            scenarioPath = argumentsValues[++argumentIndex];
+        } else if ((argument == "--scale-min") && hasValue) {
+            minimumScale = atof(argumentsValues[++argumentIndex]);
+        } else if ((argument == "--scale-max") && hasValue) {
+            maximumScale = atof(argumentsValues[++argumentIndex]);
+        } else if ((argument == "--frame-budget") && hasValue) {
+            frameBudget = atof(argumentsValues[++argumentIndex]);
+        } else if (argument == "--partial-redraw") {
+            isPartialRedraw = true;
+        } else if ((argument == "--sim-rate") && hasValue) {
+            stepRate = atoi(argumentsValues[++argumentIndex]);
+        } else if (argument == "--lockstep") {
+            isLockstep = true;
+        } else if ((argument == "--record") && hasValue) {
+            recordPath = argumentsValues[++argumentIndex];
+        } else if ((argument == "--replay") && hasValue) {
+            replayPath = argumentsValues[++argumentIndex];
+        } else if ((argument == "--record-draws") && hasValue) {
+            drawRecordPath = argumentsValues[++argumentIndex];
+        } else if ((argument == "--overdraw") && hasValue) {
+            overdrawPath = argumentsValues[++argumentIndex];
+        } else if ((argument == "--capture") && hasValue) {
+            capturePath = argumentsValues[++argumentIndex];
+        } else if ((argument == "--capture-interval") && hasValue) {
+            captureInterval = atoi(argumentsValues[++argumentIndex]);
+        } else if (argument == "--capture-raw") {
+            isRawCapture = true;
+        } else if ((argument == "--golden") && hasValue) {
+            goldenPath = argumentsValues[++argumentIndex];
+        } else if ((argument == "--golden-tolerance") && hasValue) {
+            goldenTolerance = atoi(argumentsValues[++argumentIndex]);
+        } else if ((argument == "--golden-max-mismatch") && hasValue) {
+            goldenMismatch = atof(argumentsValues[++argumentIndex]);
+        } else if (argument == "--alloc-report") {
+            isTrackingMemory = true;
+        } else if ((argument == "--alloc-steady") && hasValue) {
+            isTrackingMemory = true;
+            warmupFrames     = atoi(argumentsValues[++argumentIndex]);
+        } else if ((argument == "--perf-counters") && hasValue) {
+            perfFrames = atoi(argumentsValues[++argumentIndex]);
+        } else if (argument == "--autopilot") {
+            isAutopilot = true;
+        } else if ((argument == "--autopilot-seed") && hasValue) {
+            isAutopilot   = true;
+            autopilotSeed = atoi(argumentsValues[++argumentIndex]);
+        } else if (argument == "--autopilot-restart") {
+            isAutopilot   = true;
+            isAutoRestart = true;
+        } else if ((argument == "--autopilot-time") && hasValue) {
+            isAutopilot   = true;
+            autopilotTime = atof(argumentsValues[++argumentIndex]);
+        } else if ((argument == "--image-levels") && hasValue) {
+            imageLevels = atoi(argumentsValues[++argumentIndex]);
+        } else if ((argument == "--image-level-bias") && hasValue) {
+            levelBias = atof(argumentsValues[++argumentIndex]);
+        } else if ((argument == "--budget-p50") && hasValue) {
+            budgets[Biq::Game::Scenario::BudgetP50] = atof(argumentsValues[++argumentIndex]);
+        } else if ((argument == "--budget-p99") && hasValue) {
+            budgets[Biq::Game::Scenario::BudgetP99] = atof(argumentsValues[++argumentIndex]);
+        } else if ((argument == "--budget-max") && hasValue) {
+            budgets[Biq::Game::Scenario::BudgetMax] = atof(argumentsValues[++argumentIndex]);
+        }
+    }
+
+    Biq::GameInformation gameInformation = { const_cast<char*>(gameName), 1280, 720, 30, Biq::Game::MaxLayers, isHeadless };
+
+    Biq::Game::Splash    splashState;
+    Biq::Game::InGame    inGameState;
+    Biq::Game::Scenario  scenarioState(inGameState);
+    Biq::Game::Autopilot autopilotState(inGameState);
+
+    Biq::Engine::RegisterState(Biq::Game::Splash::Id, Biq::Game::Splash::Name, splashState);
+    Biq::Engine::RegisterState(Biq::Game::InGame::Id, Biq::Game::InGame::Name, inGameState);
+    Biq::Engine::RegisterState(Biq::Game::Scenario::Id, Biq::Game::Scenario::Name, scenarioState);
+    Biq::Engine::RegisterState(Biq::Game::Autopilot::Id, Biq::Game::Autopilot::Name, autopilotState);
+
+    // The initial state is prepared while the engine comes up.
+    auto initialStateId = Biq::Game::Splash::Id;
+
+    if (isAutopilot) {
+        initialStateId = Biq::Game::Autopilot::Id;
+    } else if (!scenarioPath.empty()) {
+        initialStateId = Biq::Game::Scenario::Id;
+    }
+
+    // SDL only takes the tracking memory functions before it allocates anything.
+    if (isTrackingMemory) {
+        Biq::Allocations::Enable();
+        Biq::Allocations::SetSteadyStateCheck(warmupFrames);
+    }
+
+    // Images decoded while the engine comes up are already built with these levels.
+    Biq::Renderer::SetImageLevels(imageLevels, levelBias);
+    Biq::World::Configure(Biq::Game::Layers::GetConfiguration());
+
+    if (!Biq::Engine::Initialize(gameInformation, initialStateId)) {
         return 1;
     }
 
-    Biq::Game::Splash splashState;
-    Biq::Game::InGame inGameState;
+    Biq::Engine::SetSimulationRate(stepRate);
+
+    // The autopilot only plays the same games again under lockstep.
+    Biq::Engine::SetLockstep(isLockstep || isAutopilot);
+
+    if (!recordPath.empty()) {
+        Biq::Engine::RecordInput(recordPath);
+    }
+
+    if (!replayPath.empty() && !Biq::Engine::ReplayInput(replayPath)) {
+        Biq::Engine::Finalize();
+        return 1;
+    }
+
+    if (!drawRecordPath.empty()) {
+        Biq::DrawRecorder::Start(drawRecordPath, gameInformation);
+    }
+
+    if (!overdrawPath.empty()) {
+        Biq::Overdraw::Start(overdrawPath);
+    }
+
+    if (!capturePath.empty()) {
+        Biq::Capture::Start(capturePath, captureInterval, isRawCapture ? Biq::Capture::Raw : Biq::Capture::PNG);
+
+        if (!goldenPath.empty()) {
+            Biq::Capture::SetGoldens(goldenPath, goldenTolerance, goldenMismatch / 100.0);
+        }
+    }
+
+    if (minimumScale < 1.0) {
+        Biq::Renderer::SetResolutionScaling(minimumScale, maximumScale, frameBudget > 0.0 ? frameBudget : 1000.0 / gameInformation.targetFPS);
+    } else if (isPartialRedraw) {
+        Biq::Renderer::SetRetainedFrame(true);
+    }
+
+    // Counters follow the thread that opens them, the main thread runs the frames.
+    if (perfFrames > 0) {
+        Biq::PerfCounters::Enable(perfFrames);
+    }
+
+    if (!telemetryPath.empty()) {
+        Biq::Telemetry::Open(telemetryPath);
+    }
+
+    if (!spectatorPath.empty()) {
+        Biq::Spectator::Open(spectatorPath);
+    }
+
+    if (isAutopilot) {
+        if (autopilotSeed >= 0) {
+            autopilotState.SetSeed(autopilotSeed);
+        }
+
+        autopilotState.SetRestart(isAutoRestart);
+        autopilotState.SetDuration(autopilotTime);
 
-    Biq::Engine::RegisterState(Biq::Game::Splash::Name, splashState);
-    Biq::Engine::RegisterState(Biq::Game::InGame::Name, inGameState);
+        Biq::Engine::Run(Biq::Game::Autopilot::Id);
+        Biq::Engine::Finalize();
+        return ((Biq::Capture::GetReport().mismatched > 0) || (Biq::Allocations::GetViolations() > 0)) ? 2 : 0;
+    }
+
+    if (scenarioPath.empty()) {
+        Biq::Engine::Run(Biq::Game::Splash::Id);
+        Biq::Engine::Finalize();
+        return ((Biq::Capture::GetReport().mismatched > 0) || (Biq::Allocations::GetViolations() > 0)) ? 2 : 0;
+    }
+
+    for (Biq::uint budget = 0; budget < Biq::Game::Scenario::MaxBudgets; budget++) {
+        scenarioState.SetBudget(budget, budgets[budget]);
+    }
+
+    // A scenario that can not be loaded must not pass the gate.
+    if (!scenarioState.Load(scenarioPath)) {
+        Biq::Engine::Finalize();
+        return 1;
+    }
 
-    Biq::Engine::Run(Biq::Game::Splash::Name);
+    Biq::Engine::Run(Biq::Game::Scenario::Id);
     Biq::Engine::Finalize();
-    return 0;
+    return (scenarioState.HasFailed() || (Biq::Capture::GetReport().mismatched > 0) || (Biq::Allocations::GetViolations() > 0)) ? 2 : 0;
 }
\ No newline at end of file
@@ -0,0 +1,1335 @@
+/*
+ * Source/Tools/Benchmark.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/Capture.hxx"
+#include "Engine/Engine.hxx"
+#include "Engine/FrameArena.hxx"
+#include "Engine/Overdraw.hxx"
+#include "Engine/Overlap.hxx"
+#include "Engine/Particles.hxx"
+#include "Engine/Renderer.hxx"
+#include "Engine/Snapshot.hxx"
+#include "Game/InGame.hxx"
+
+#include <cstring>
+#include <numeric>
+
+namespace Biq {
+namespace Tools {
+
+static constexpr charconst Tag = "Benchmark";
+
+static GameInformation benchmarkGame = { const_cast<char*>("Biq Benchmark"), 1280, 720, 30, Game::MaxLayers, true };
+
+// String Table
+
+namespace Txt {
+static const charconst Usage             = "Usage: %s [benchmark...] (run it from the binaries directory)";
+static const charconst Available         = " - %s: %s";
+static const charconst UnknownBenchmark  = "Unknown benchmark \"%s\"";
+static const charconst RunningBenchmark  = "Running \"%s\"";
+static const charconst BenchmarkFailed   = "Benchmark \"%s\" failed";
+static const charconst BenchmarkTime     = "Benchmark \"%s\" took %.1f ms";
+static const charconst ImageLevelsResult = "%-12s %8.3f ms/frame %8llu KB of textures";
+static const charconst ImageLevelsGain   = "Levels change the fill cost by %+.1f%% for %+.1f%% texture memory";
+static const charconst SnapshotHeader    = "%8s %10s %10s %10s %10s %10s %10s";
+static const charconst SnapshotResult    = "%8d %10d %10.2f %10.2f %10d %10.2f %10.2f";
+static const charconst SnapshotMismatch  = "%s does not match the original snapshot (%d objects)";
+static const charconst ArenaResult       = "%-12s %8.2f us/frame";
+static const charconst ArenaPeak         = "Arena peak %d bytes in a frame, %d frames overflowed";
+static const charconst ArenaMismatch     = "%s does not hold what was written to it";
+static const charconst ParticlesResult   = "%d particles: %.3f ms/frame to update, %.3f ms/frame to render";
+static const charconst ParticlesMismatch = "%d particles alive, %d expected";
+static const charconst OverlapResult     = "%-12s %8.1f M boxes/s %7.2fx";
+static const charconst OverlapMismatch   = "The %s overlap tests do not match the %s ones (%d boxes)";
+static const charconst OverlapSkipped    = "%s is not supported by this processor, skipped";
+static const charconst SweepMismatch     = "Batched swept collisions do not match the pairwise ones (%d targets)";
+static const charconst LayersResult      = "%-12s %8.2f us/frame to update %8.2f us/frame to add and remove";
+static const charconst LayersMismatch    = "The %s layout does not hold the objects added to layer %d";
+static const charconst LayersMoved       = "The %s layout does not move the objects like the sorted one";
+static const charconst DamageResult      = "%-12s %8.3f ms/frame %5d frames presented";
+static const charconst DamageMismatch    = "Partial redraws differ from a full redraw on %.3f%% of the pixels";
+static const charconst DamageUnchanged   = "%d frames were presented with nothing changed";
+static const charconst DamageSkipped     = "The renderer can not keep frames, partial redraws skipped";
+static const charconst TintingResult     = "%-12s %8.3f ms/frame %8llu KB of textures";
+static const charconst TintingBaked      = "%d variants baked in %.3f ms";
+static const charconst TintingMismatch   = "Tinted masks differ from the baked variants on %.3f%% of the pixels";
+static const charconst RegionsHeader     = "%-24s %8s %8s %8s %6s";
+static const charconst RegionsImage      = "%-24s %7.1f%% %7.1f%% %7.1f%% %6d";
+static const charconst RegionsResult     = "%-12s %8.3f ms/frame";
+static const charconst RegionsMismatch   = "Images drawn %s differ from whole ones on %.3f%% of the pixels";
+static const charconst OverdrawResult    = "%-12s %8.3f ms/frame";
+static const charconst OverdrawMismatch  = "%s counted %llu writes (at most %d on one pixel), %llu expected";
+static const charconst PagingResult      = "%-8s %4dx%-4d chunks %7d objects %6d active %8.3f ms/frame";
+static const charconst PagingMismatch    = "The %s world of %dx%d chunks lost objects or left some on screen dormant";
+}    // namespace Txt
+
+// Image Levels
+
+static constexpr uint CloudFrames    = 300;
+static constexpr uint NumberOfClouds = 32;
+
+static constexpr charconst CloudPaths[] = { "assets/images/cloud1.png", "assets/images/cloud2.png", "assets/images/cloud3.png", "assets/images/cloud4.png" };
+
+static f64 DrawClouds(Image* const* cloudImages) {
+    Engine::SetRandomSeed(1);
+
+    auto startTime = Engine::GetPreciseTicks();
+
+    for (uint frame = 0; frame < CloudFrames; frame++) {
+        for (uint cloudIndex = 0; cloudIndex < NumberOfClouds; cloudIndex++) {
+            auto     distance = Engine::RandomNumber(5, 20) / 10.0f;
+            Vector2D size     = { 256.0f / distance, 256.0f / distance };
+            Vector2D position = { F32(Engine::RandomNumber(0, 1024)), F32(Engine::RandomNumber(0, 464)) };
+
+            Renderer::Draw(cloudImages[cloudIndex % 4], position, size);
+        }
+
+        Renderer::Update();
+    }
+
+    return (Engine::GetPreciseTicks() - startTime) / CloudFrames;
+}
+
+static bool ImageLevelsBenchmark() {
+    f64 frameTimes[2];
+    u64 textureMemory[2];
+
+    for (uint configuration = 0; configuration < 2; configuration++) {
+        Image* cloudImages[4];
+
+        Renderer::SetImageLevels(configuration == 0 ? 0 : Renderer::DefaultImageLevels, 0.0f);
+
+        auto initialMemory = Renderer::GetTextureMemory();
+
+        for (uint imageIndex = 0; imageIndex < 4; imageIndex++) {
+            if ((cloudImages[imageIndex] = Renderer::LoadImage(CloudPaths[imageIndex])) == NULL) {
+                return false;
+            }
+        }
+
+        textureMemory[configuration] = Renderer::GetTextureMemory() - initialMemory;
+        frameTimes[configuration]    = DrawClouds(cloudImages);
+
+        INFO(Txt::ImageLevelsResult, configuration == 0 ? "full size" : "with levels", frameTimes[configuration], (unsigned long long) textureMemory[configuration] / 1024);
+
+        for (auto cloudImage : cloudImages) {
+            Renderer::UnloadImage(cloudImage);
+        }
+    }
+
+    INFO(Txt::ImageLevelsGain, ((frameTimes[1] / frameTimes[0]) - 1.0) * 100.0, ((F64(textureMemory[1]) / textureMemory[0]) - 1.0) * 100.0);
+    Renderer::SetImageLevels(Renderer::DefaultImageLevels, 0.0f);
+    return true;
+}
+
+// Snapshots
+
+static constexpr uint SnapshotIterations = 200;
+
+static bool SnapshotsBenchmark() {
+    static constexpr uint objectCounts[] = { 0, 100, 1000, 5000 };
+
+    Game::InGame    inGame;
+    Snapshot        snapshots[3];
+    std::vector<u8> delta;
+
+    inGame.Prepare(benchmarkGame);
+
+    INFO(Txt::SnapshotHeader, "objects", "bytes", "save us", "restore us", "delta", "encode us", "decode us");
+
+    auto isValid = true;
+
+    for (auto numberOfObjects : objectCounts) {
+        Engine::SetRandomSeed(1);
+
+        inGame.Activate(benchmarkGame);
+        inGame.SetInvulnerable(true);
+        inGame.SpawnEnemies(numberOfObjects / 2);
+        inGame.FireEnemyProjectiles(numberOfObjects / 4);
+        inGame.FirePlayerProjectiles(numberOfObjects / 4);
+        inGame.Step(1.0f);
+
+        // Full snapshots.
+        auto startTime = Engine::GetPreciseTicks();
+
+        for (uint iteration = 0; iteration < SnapshotIterations; iteration++) {
+            inGame.SaveSnapshot(snapshots[0]);
+        }
+
+        auto saveTime = (Engine::GetPreciseTicks() - startTime) * 1000.0 / SnapshotIterations;
+
+        startTime = Engine::GetPreciseTicks();
+
+        for (uint iteration = 0; iteration < SnapshotIterations; iteration++) {
+            inGame.RestoreSnapshot(snapshots[0]);
+        }
+
+        auto restoreTime = (Engine::GetPreciseTicks() - startTime) * 1000.0 / SnapshotIterations;
+
+        inGame.SaveSnapshot(snapshots[1]);
+
+        if (!snapshots[1].IsEqual(snapshots[0])) {
+            ERROR(Txt::SnapshotMismatch, "The restored game", numberOfObjects);
+            isValid = false;
+        }
+
+        // Deltas against the next frame.
+        inGame.Step(1.0f);
+        inGame.SaveSnapshot(snapshots[1]);
+
+        startTime = Engine::GetPreciseTicks();
+
+        for (uint iteration = 0; iteration < SnapshotIterations; iteration++) {
+            Snapshot::EncodeDelta(snapshots[0], snapshots[1], delta);
+        }
+
+        auto encodeTime = (Engine::GetPreciseTicks() - startTime) * 1000.0 / SnapshotIterations;
+
+        startTime = Engine::GetPreciseTicks();
+
+        for (uint iteration = 0; iteration < SnapshotIterations; iteration++) {
+            Snapshot::DecodeDelta(snapshots[0], delta, snapshots[2]);
+        }
+
+        auto decodeTime = (Engine::GetPreciseTicks() - startTime) * 1000.0 / SnapshotIterations;
+
+        if (!snapshots[2].IsEqual(snapshots[1])) {
+            ERROR(Txt::SnapshotMismatch, "The decoded delta", numberOfObjects);
+            isValid = false;
+        }
+
+        INFO(Txt::SnapshotResult, numberOfObjects, snapshots[0].GetSize(), saveTime, restoreTime, delta.size(), encodeTime, decodeTime);
+
+        inGame.Deactivate();
+    }
+
+    inGame.Release();
+    return isValid;
+}
+
+// Frame Arena
+
+static constexpr uint ArenaFrames  = 2000;
+static constexpr uint ArenaObjects = 500;
+static constexpr uint ArenaTexts   = 8;
+
+// One frame worth of temporaries: a list of targets grown one by one and a few formatted texts.
+template <typename List, typename Text> static uint BuildTemporaries(const uint frame, List& targets, Text& text) {
+    char number[16];
+
+    for (uint objectIndex = 0; objectIndex < ArenaObjects; objectIndex++) {
+        targets.push_back(frame + objectIndex);
+    }
+
+    for (uint textIndex = 0; textIndex < ArenaTexts; textIndex++) {
+        snprintf(number, sizeof(number), "%u", frame + textIndex);
+        text  = "SCORE: ";
+        text += number;
+    }
+
+    return targets.back() + text.size();
+}
+
+static bool FrameArenaBenchmark() {
+    auto isValid  = true;
+    uint checksum = 0;
+
+    auto startTime = Engine::GetPreciseTicks();
+
+    for (uint frame = 0; frame < ArenaFrames; frame++) {
+        std::vector<uint> targets;
+        string            text;
+
+        checksum += BuildTemporaries(frame, targets, text);
+    }
+
+    auto heapTime = (Engine::GetPreciseTicks() - startTime) * 1000.0 / ArenaFrames;
+
+    startTime = Engine::GetPreciseTicks();
+
+    for (uint frame = 0; frame < ArenaFrames; frame++) {
+        FrameVector<uint> targets;
+        FrameString       text;
+
+        checksum -= BuildTemporaries(frame, targets, text);
+        FrameArena::NextFrame();
+    }
+
+    auto arenaTime = (Engine::GetPreciseTicks() - startTime) * 1000.0 / ArenaFrames;
+
+    if (checksum != 0) {
+        ERROR(Txt::ArenaMismatch, "The frame arena");
+        isValid = false;
+    }
+
+    // Whatever a frame wrote must still be there during the next one.
+    FrameVector<uint> previousTargets;
+    FrameString       previousText;
+
+    BuildTemporaries(1, previousTargets, previousText);
+    FrameArena::NextFrame();
+
+    FrameVector<uint> currentTargets;
+    FrameString       currentText;
+
+    BuildTemporaries(2, currentTargets, currentText);
+
+    if ((previousTargets.front() != 1) || (previousTargets.back() != ArenaObjects) || (previousText != "SCORE: 8")) {
+        ERROR(Txt::ArenaMismatch, "The previous frame");
+        isValid = false;
+    }
+
+    FrameArena::NextFrame();
+
+    INFO(Txt::ArenaResult, "heap", heapTime);
+    INFO(Txt::ArenaResult, "frame arena", arenaTime);
+    INFO(Txt::ArenaPeak, FrameArena::GetStatistics().peakFrameBytes, FrameArena::GetStatistics().overflowFrames);
+    return isValid;
+}
+
+// Particles
+
+static constexpr uint ParticleFrames   = 100;
+static constexpr uint ParticleCount    = 100000;
+static constexpr f32  ParticleLifetime = 1000.0f;
+
+static bool ParticlesBenchmark() {
+    static const Particles::Style style = { 0.5f, 4.0f, ParticleLifetime, ParticleLifetime, 2.0f, { 255, 200, 80, 255 } };
+
+    auto isValid = true;
+
+    Particles::Finalize();
+
+    if (!Particles::Initialize(ParticleCount)) {
+        return false;
+    }
+
+    Vector2D center = { benchmarkGame.targetWidth / 2.0f, benchmarkGame.targetHeight / 2.0f };
+
+    for (uint layerIndex = 0; Particles::GetCount() < ParticleCount; layerIndex = (layerIndex + 1) % Game::MaxLayers) {
+        Particles::Burst(layerIndex, center, 1000, style);
+    }
+
+    // A full pool drops whatever does not fit.
+    if (Particles::Burst(0, center, 1, style) != 0) {
+        ERROR(Txt::ParticlesMismatch, Particles::GetCount() + 1, ParticleCount);
+        isValid = false;
+    }
+
+    f64 updateTime = 0.0;
+    f64 renderTime = 0.0;
+
+    for (uint frame = 0; frame < ParticleFrames; frame++) {
+        auto startTime = Engine::GetPreciseTicks();
+
+        Particles::Update(1.0f);
+
+        auto updatedTime = Engine::GetPreciseTicks();
+
+        for (uint layerIndex = 0; layerIndex < Game::MaxLayers; layerIndex++) {
+            Particles::Render(layerIndex);
+        }
+
+        Renderer::Update();
+
+        updateTime += updatedTime - startTime;
+        renderTime += Engine::GetPreciseTicks() - updatedTime;
+    }
+
+    if (Particles::GetCount() != ParticleCount) {
+        ERROR(Txt::ParticlesMismatch, Particles::GetCount(), ParticleCount);
+        isValid = false;
+    }
+
+    // Every particle is gone once its lifetime has passed.
+    Particles::Update(ParticleLifetime);
+
+    if (Particles::GetCount() != 0) {
+        ERROR(Txt::ParticlesMismatch, Particles::GetCount(), 0);
+        isValid = false;
+    }
+
+    INFO(Txt::ParticlesResult, ParticleCount, updateTime / ParticleFrames, renderTime / ParticleFrames);
+
+    Particles::Finalize();
+    return Particles::Initialize(Particles::DefaultCapacity) && isValid;
+}
+
+// Overlap
+
+static constexpr uint OverlapBoxes   = 4096;
+static constexpr uint OverlapQueries = 2000;
+static constexpr uint SweepTrials    = 2000;
+
+static const uint OverlapCounts[] = { 0, 1, 3, 7, 8, 9, 31, 32, 33, 63, 100, 257, 1000 };
+
+// Integer coordinates on a small field, so plenty of boxes share an edge (which does not count as overlapping).
+static void RandomObject(World::Object& object, const int fieldSize) {
+    object.position = { F32(Engine::RandomNumber(0, fieldSize)), F32(Engine::RandomNumber(0, fieldSize)) };
+    object.size     = { F32(Engine::RandomNumber(0, 8)), F32(Engine::RandomNumber(0, 8)) };
+    object.speed    = { F32(Engine::RandomNumber(-6, 6)), F32(Engine::RandomNumber(-6, 6)) };
+}
+
+static Overlap::Box ObjectBox(const World::Object& object) {
+    return { object.position.x, object.position.y, object.position.x + object.size.x, object.position.y + object.size.y };
+}
+
+// Every implementation is checked against the scalar one, which is checked against World::CheckCollision. Removed boxes
+// must never overlap.
+static bool CheckOverlap(const uint numberOfBoxes) {
+    std::vector<World::Object> objects(numberOfBoxes + 1, World::Object(World::Object::World));
+    std::vector<u32>           expectedMask(Overlap::MaskWords(numberOfBoxes) + 1);
+    std::vector<u32>           hitMask(Overlap::MaskWords(numberOfBoxes) + 1);
+    Overlap::Boxes             boxes;
+
+    auto  initialImplementation = Overlap::GetImplementation();
+    auto  isValid               = true;
+    auto& query                 = objects[numberOfBoxes];
+
+    for (uint boxIndex = 0; boxIndex < numberOfBoxes; boxIndex++) {
+        RandomObject(objects[boxIndex], 24);
+        boxes.Add(ObjectBox(objects[boxIndex]));
+    }
+
+    for (uint boxIndex = 0; boxIndex < numberOfBoxes; boxIndex += 5) {
+        boxes.Remove(boxIndex);
+    }
+
+    for (uint queryIndex = 0; (queryIndex < 64) && isValid; queryIndex++) {
+        RandomObject(query, 24);
+
+        Overlap::SetImplementation(Overlap::Scalar);
+
+        // The sentinel word past the mask must be left alone.
+        expectedMask.back() = 0xA5A5A5A5;
+
+        auto expectedHits = Overlap::Test(ObjectBox(query), boxes, expectedMask.data());
+
+        for (uint boxIndex = 0; boxIndex < numberOfBoxes; boxIndex++) {
+            auto isExpected = (boxIndex % 5 != 0) && World::CheckCollision(&query, &objects[boxIndex]);
+
+            if (Overlap::IsHit(expectedMask.data(), boxIndex) != isExpected) {
+                ERROR(Txt::OverlapMismatch, Overlap::GetImplementationName(Overlap::Scalar), "pairwise", numberOfBoxes);
+                isValid = false;
+                break;
+            }
+        }
+
+        for (uint implementation = Overlap::SSE; implementation < Overlap::MaxImplementations; implementation++) {
+            if (!Overlap::SetImplementation(Overlap::Implementation(implementation))) {
+                continue;
+            }
+
+            hitMask.back() = 0xA5A5A5A5;
+
+            if ((Overlap::Test(ObjectBox(query), boxes, hitMask.data()) != expectedHits) || (hitMask != expectedMask)) {
+                ERROR(Txt::OverlapMismatch, Overlap::GetImplementationName(Overlap::Implementation(implementation)), Overlap::GetImplementationName(Overlap::Scalar), numberOfBoxes);
+                isValid = false;
+            }
+        }
+    }
+
+    Overlap::SetImplementation(initialImplementation);
+    return isValid;
+}
+
+// World::FirstCollision only sweeps what the batch test lets through, it must find the same target at the same time as
+// sweeping every target.
+static bool CheckFirstCollision(const uint numberOfTargets) {
+    std::vector<World::Object>  objects(numberOfTargets + 1, World::Object(World::Object::World));
+    std::vector<World::Object*> targets;
+    Overlap::Boxes              targetBounds;
+
+    auto& object = objects[numberOfTargets];
+
+    for (uint targetIndex = 0; targetIndex < numberOfTargets; targetIndex++) {
+        RandomObject(objects[targetIndex], 64);
+        targets.push_back(&objects[targetIndex]);
+        targetBounds.Add(World::SweptBounds(targets.back(), 1.5f));
+    }
+
+    RandomObject(object, 64);
+
+    int   expectedTarget = -1;
+    float expectedTime   = 2.0f;
+    float contactTime;
+
+    for (uint targetIndex = 0; targetIndex < numberOfTargets; targetIndex++) {
+        if (World::SweepCollision(&object, targets[targetIndex], 1.5f, contactTime) && (contactTime < expectedTime)) {
+            expectedTime   = contactTime;
+            expectedTarget = targetIndex;
+        }
+    }
+
+    auto firstTarget = World::FirstCollision(&object, targets.data(), targetBounds, 1.5f, contactTime);
+
+    if ((firstTarget != expectedTarget) || ((firstTarget >= 0) && (contactTime != expectedTime))) {
+        ERROR(Txt::SweepMismatch, numberOfTargets);
+        return false;
+    }
+
+    return true;
+}
+
+static bool OverlapBenchmark() {
+    auto isValid = true;
+
+    Engine::SetRandomSeed(1);
+
+    for (auto numberOfBoxes : OverlapCounts) {
+        isValid = CheckOverlap(numberOfBoxes) && isValid;
+        FrameArena::NextFrame();
+    }
+
+    for (uint trial = 0; trial < SweepTrials; trial++) {
+        isValid = CheckFirstCollision(trial % 64) && isValid;
+        FrameArena::NextFrame();
+    }
+
+    // Throughput, the pairwise loop is what the callers did before.
+    std::vector<World::Object> objects(OverlapBoxes + 1, World::Object(World::Object::World));
+    std::vector<u32>           hitMask(Overlap::MaskWords(OverlapBoxes));
+    Overlap::Boxes             boxes;
+
+    for (uint boxIndex = 0; boxIndex < OverlapBoxes; boxIndex++) {
+        RandomObject(objects[boxIndex], 1024);
+        boxes.Add(ObjectBox(objects[boxIndex]));
+    }
+
+    RandomObject(objects[OverlapBoxes], 1024);
+
+    auto& query     = objects[OverlapBoxes];
+    uint  hits      = 0;
+    auto  startTime = Engine::GetPreciseTicks();
+
+    for (uint queryIndex = 0; queryIndex < OverlapQueries; queryIndex++) {
+        query.position.x = F32(queryIndex % 1024);
+
+        for (uint boxIndex = 0; boxIndex < OverlapBoxes; boxIndex++) {
+            hits += World::CheckCollision(&query, &objects[boxIndex]) ? 1 : 0;
+        }
+    }
+
+    auto pairwiseTime = Engine::GetPreciseTicks() - startTime;
+    auto totalBoxes   = F64(OverlapBoxes) * OverlapQueries;
+
+    INFO(Txt::OverlapResult, "pairwise", totalBoxes / (pairwiseTime * 1000.0), 1.0);
+
+    auto initialImplementation = Overlap::GetImplementation();
+
+    for (uint implementation = Overlap::Scalar; implementation < Overlap::MaxImplementations; implementation++) {
+        auto name = Overlap::GetImplementationName(Overlap::Implementation(implementation));
+
+        if (!Overlap::SetImplementation(Overlap::Implementation(implementation))) {
+            INFO(Txt::OverlapSkipped, name);
+            continue;
+        }
+
+        uint batchHits = 0;
+
+        startTime = Engine::GetPreciseTicks();
+
+        for (uint queryIndex = 0; queryIndex < OverlapQueries; queryIndex++) {
+            query.position.x = F32(queryIndex % 1024);
+            batchHits += Overlap::Test(ObjectBox(query), boxes, hitMask.data());
+        }
+
+        auto batchTime = Engine::GetPreciseTicks() - startTime;
+
+        if (batchHits != hits) {
+            ERROR(Txt::OverlapMismatch, name, "pairwise", OverlapBoxes);
+            isValid = false;
+        }
+
+        INFO(Txt::OverlapResult, name, totalBoxes / (batchTime * 1000.0), pairwiseTime / batchTime);
+    }
+
+    Overlap::SetImplementation(initialImplementation);
+    FrameArena::NextFrame();
+    return isValid;
+}
+
+// World Layers
+
+static constexpr uint LayerFrames = 2000;
+static constexpr uint LayerChurn  = 100;
+
+// About what a busy game holds, the churn is projectiles fired and gone every frame.
+static const uint LayerObjects[Game::MaxLayers] = { 0, 16, 2000, 200, 16, 2, 0 };
+
+static bool RunWorldLayers(const charconst name, const World::Configuration* layout, std::vector<Vector2D>& positions) {
+    World::Finalize();
+    World::Configure(layout);
+
+    if (!World::Initialize(Game::MaxLayers)) {
+        return false;
+    }
+
+    Engine::SetRandomSeed(1);
+
+    std::vector<World::Object>  objects(std::accumulate(LayerObjects, LayerObjects + Game::MaxLayers, 0u), World::Object(World::Object::World));
+    std::vector<World::Object*> layerObjects[Game::MaxLayers];
+    uint                        objectIndex = 0;
+
+    for (uint layerIndex = 0; layerIndex < Game::MaxLayers; layerIndex++) {
+        for (uint layerObject = 0; layerObject < LayerObjects[layerIndex]; layerObject++) {
+            auto object = &objects[objectIndex++];
+
+            RandomObject(*object, 1024);
+
+            // The HUD does not move in the game either, both layouts must end up with the same positions.
+            if (layerIndex == Game::HUDLayer) {
+                object->speed = { 0.0f, 0.0f };
+            }
+
+            World::AddObject(layerIndex, object);
+            layerObjects[layerIndex].push_back(object);
+        }
+    }
+
+    auto& projectiles = layerObjects[Game::ProjectileLayer];
+    f64   updateTime  = 0.0;
+    f64   churnTime   = 0.0;
+
+    for (uint frame = 0; frame < LayerFrames; frame++) {
+        auto startTime = Engine::GetPreciseTicks();
+
+        World::Update(1.0f);
+
+        auto updatedTime = Engine::GetPreciseTicks();
+
+        // Random projectiles are gone and fired again, at the end of the layer.
+        for (uint churn = 0; churn < LayerChurn; churn++) {
+            auto projectile = projectiles[Engine::RandomNumber(0, projectiles.size() - 1)];
+
+            World::RemoveObject(projectile);
+            World::AddObject(Game::ProjectileLayer, projectile);
+        }
+
+        updateTime += updatedTime - startTime;
+        churnTime  += Engine::GetPreciseTicks() - updatedTime;
+    }
+
+    auto  isValid = true;
+    auto& layers  = World::GetLayers();
+
+    for (uint layerIndex = 0; layerIndex < Game::MaxLayers; layerIndex++) {
+        auto layerContent = layers[layerIndex]->objects;
+        auto expected     = layerObjects[layerIndex];
+
+        std::sort(layerContent.begin(), layerContent.end());
+        std::sort(expected.begin(), expected.end());
+
+        if (layerContent != expected) {
+            ERROR(Txt::LayersMismatch, name, layerIndex);
+            isValid = false;
+        }
+    }
+
+    INFO(Txt::LayersResult, name, (updateTime * 1000.0) / LayerFrames, (churnTime * 1000.0) / LayerFrames);
+
+    positions.clear();
+
+    for (auto& object : objects) {
+        positions.push_back(object.position);
+    }
+
+    World::Clear();
+    return isValid;
+}
+
+static bool WorldLayersBenchmark() {
+    std::vector<Vector2D> sortedPositions;
+    std::vector<Vector2D> gamePositions;
+
+    auto isValid = RunWorldLayers("sorted", NULL, sortedPositions);
+    isValid      = RunWorldLayers("game", Game::Layers::GetConfiguration(), gamePositions) && isValid;
+
+    for (uint objectIndex = 0; objectIndex < sortedPositions.size(); objectIndex++) {
+        if ((sortedPositions[objectIndex].x != gamePositions[objectIndex].x) || (sortedPositions[objectIndex].y != gamePositions[objectIndex].y)) {
+            ERROR(Txt::LayersMoved, "game");
+            isValid = false;
+            break;
+        }
+    }
+
+    // The game layout is back for the benchmarks that follow.
+    World::Finalize();
+    World::Configure(Game::Layers::GetConfiguration());
+    return World::Initialize(Game::MaxLayers) && isValid;
+}
+
+// Damage
+
+static constexpr uint DamageFrames  = 300;
+static constexpr uint DamageObjects = 500;
+
+static f64 RenderDamagedFrames(World::Object& mover, const bool isMoving, const bool isInvalid, uint& presentedFrames) {
+    auto startTime = Engine::GetPreciseTicks();
+
+    presentedFrames = 0;
+
+    for (uint frame = 0; frame < DamageFrames; frame++) {
+        if (isMoving) {
+            mover.position.x = F32((frame * 7) % 1200);
+        }
+
+        if (isInvalid) {
+            World::Invalidate();
+        }
+
+        if (World::Render()) {
+            Renderer::Update();
+            presentedFrames++;
+        } else {
+            Renderer::SkipFrame();
+        }
+    }
+
+    return (Engine::GetPreciseTicks() - startTime) / DamageFrames;
+}
+
+// A single object moves over a full screen of still ones, which is what partial redraws are for. The frame they
+// leave behind must look like one drawn in full.
+static bool CheckPartialFrame(World::Object& mover) {
+    std::vector<u8> partialPixels;
+    std::vector<u8> fullPixels;
+    uint            presentedFrames;
+
+    if (!Renderer::SetRetainedFrame(true)) {
+        INFO(Txt::DamageSkipped);
+        return true;
+    }
+
+    auto frameTime = RenderDamagedFrames(mover, true, false, presentedFrames);
+
+    INFO(Txt::DamageResult, "partial", frameTime, presentedFrames);
+
+    if (!Renderer::ReadPixels(partialPixels)) {
+        return false;
+    }
+
+    World::Invalidate();
+    World::Render();
+
+    if (!Renderer::ReadPixels(fullPixels)) {
+        return false;
+    }
+
+    Renderer::Update();
+    Renderer::SetRetainedFrame(false);
+
+    uint mismatchedPixels = 0;
+
+    for (uint pixelIndex = 0; pixelIndex < fullPixels.size(); pixelIndex += 4) {
+        for (uint channel = 0; channel < 4; channel++) {
+            if (std::abs(partialPixels[pixelIndex + channel] - fullPixels[pixelIndex + channel]) > I32(Capture::DefaultTolerance)) {
+                mismatchedPixels++;
+                break;
+            }
+        }
+    }
+
+    auto mismatch = F32(mismatchedPixels) / (fullPixels.size() / 4);
+
+    if (mismatch > Capture::DefaultMaxMismatch) {
+        ERROR(Txt::DamageMismatch, mismatch * 100.0f);
+        return false;
+    }
+
+    return true;
+}
+
+static bool DamageBenchmark() {
+    Image* cloudImages[4];
+    auto   backgroundImage = Renderer::LoadImage("assets/images/background.jpg");
+
+    for (uint imageIndex = 0; imageIndex < 4; imageIndex++) {
+        if ((cloudImages[imageIndex] = Renderer::LoadImage(CloudPaths[imageIndex])) == NULL) {
+            return false;
+        }
+    }
+
+    std::vector<World::Object> objects(DamageObjects + 1, World::Object(World::Object::World));
+
+    World::Clear();
+    World::SetLayerBackground(Game::BackgroundLayer, backgroundImage);
+    Engine::SetRandomSeed(1);
+
+    for (uint objectIndex = 0; objectIndex < DamageObjects; objectIndex++) {
+        auto& object = objects[objectIndex];
+
+        object.image    = cloudImages[objectIndex % 4];
+        object.size     = { F32(Engine::RandomNumber(64, 128)), F32(Engine::RandomNumber(64, 128)) };
+        object.position = { F32(Engine::RandomNumber(0, benchmarkGame.targetWidth)), F32(Engine::RandomNumber(0, benchmarkGame.targetHeight)) };
+
+        World::AddObject(Game::LowCloudsLayer, &object);
+    }
+
+    auto& mover = objects[DamageObjects];
+
+    mover.image    = cloudImages[0];
+    mover.size     = { 64.0f, 64.0f };
+    mover.position = { 0.0f, benchmarkGame.targetHeight / 2.0f };
+
+    World::AddObject(Game::ShipLayer, &mover);
+
+    uint presentedFrames;
+    auto isValid = true;
+
+    auto frameTime = RenderDamagedFrames(mover, true, true, presentedFrames);
+    INFO(Txt::DamageResult, "full", frameTime, presentedFrames);
+
+    // Without a kept frame, any damage is drawn in full.
+    frameTime = RenderDamagedFrames(mover, true, false, presentedFrames);
+    INFO(Txt::DamageResult, "damaged", frameTime, presentedFrames);
+
+    frameTime = RenderDamagedFrames(mover, false, false, presentedFrames);
+    INFO(Txt::DamageResult, "unchanged", frameTime, presentedFrames);
+
+    if (presentedFrames != 0) {
+        ERROR(Txt::DamageUnchanged, presentedFrames);
+        isValid = false;
+    }
+
+    isValid = CheckPartialFrame(mover) && isValid;
+
+    World::Clear();
+    Renderer::UnloadImage(backgroundImage);
+
+    for (auto cloudImage : cloudImages) {
+        Renderer::UnloadImage(cloudImage);
+    }
+
+    return isValid;
+}
+
+// Tinting
+
+static constexpr uint TintingFrames  = 300;
+static constexpr uint TintingObjects = 400;
+
+static const u32 TintingColors[] = { 0xFF0F0D, 0x24970D, 0x100FFE, 0x222322 };
+
+// Variants drawn in a random order, so the tinted draws keep changing the modulation of the shared mask.
+static f64 DrawVariants(Image* image, Image* mask, Image* const* variants) {
+    Engine::SetRandomSeed(1);
+
+    auto startTime = Engine::GetPreciseTicks();
+
+    for (uint frame = 0; frame < TintingFrames; frame++) {
+        for (uint objectIndex = 0; objectIndex < TintingObjects; objectIndex++) {
+            auto     color    = Engine::RandomNumber(0, 3);
+            Vector2D size     = { 72.0f, 72.0f };
+            Vector2D position = { F32(Engine::RandomNumber(0, benchmarkGame.targetWidth - 72)), F32(Engine::RandomNumber(0, benchmarkGame.targetHeight - 72)) };
+
+            if (variants != NULL) {
+                Renderer::Draw(variants[color], position, size);
+            } else {
+                Renderer::Draw(image, position, size);
+                Renderer::Draw(mask, position, size, TintingColors[color]);
+            }
+        }
+
+        Renderer::Update();
+    }
+
+    return (Engine::GetPreciseTicks() - startTime) / TintingFrames;
+}
+
+// One sprite of each color, drawn with its tinted mask and then baked, over the same background.
+static bool CheckTinting(Image* backgroundImage, Image* image, Image* mask, Image* const* variants) {
+    std::vector<u8> pixels[2];
+    Vector2D        screenSize = { F32(benchmarkGame.targetWidth), F32(benchmarkGame.targetHeight) };
+
+    for (uint configuration = 0; configuration < 2; configuration++) {
+        Renderer::Draw(backgroundImage, { 0.0f, 0.0f }, screenSize);
+
+        for (uint color = 0; color < 4; color++) {
+            Vector2D position = { 100.0f + (color * 100.0f), 100.0f };
+
+            if (configuration == 0) {
+                Renderer::Draw(image, position, { 72.0f, 72.0f });
+                Renderer::Draw(mask, position, { 72.0f, 72.0f }, TintingColors[color]);
+            } else {
+                Renderer::Draw(variants[color], position, { 72.0f, 72.0f });
+            }
+        }
+
+        if (!Renderer::ReadPixels(pixels[configuration])) {
+            return false;
+        }
+
+        Renderer::Update();
+    }
+
+    uint mismatchedPixels = 0;
+
+    for (uint pixelIndex = 0; pixelIndex < pixels[0].size(); pixelIndex += 4) {
+        for (uint channel = 0; channel < 4; channel++) {
+            if (std::abs(pixels[0][pixelIndex + channel] - pixels[1][pixelIndex + channel]) > I32(Capture::DefaultTolerance)) {
+                mismatchedPixels++;
+                break;
+            }
+        }
+    }
+
+    auto mismatch = F32(mismatchedPixels) / (pixels[0].size() / 4);
+
+    if (mismatch > Capture::DefaultMaxMismatch) {
+        ERROR(Txt::TintingMismatch, mismatch * 100.0f);
+        return false;
+    }
+
+    return true;
+}
+
+// The enemy sprite as the game draws it (a shared image and mask, tinted per draw) against one baked texture per color.
+static bool TintingBenchmark() {
+    auto initialMemory   = Renderer::GetTextureMemory();
+    auto image           = Renderer::LoadImage("assets/images/enemy_base.png");
+    auto mask            = Renderer::LoadImage("assets/images/enemy_mask.png");
+    auto tintedMemory    = Renderer::GetTextureMemory() - initialMemory;
+    auto backgroundImage = Renderer::LoadImage("assets/images/background.jpg");
+
+    if ((image == NULL) || (mask == NULL) || (backgroundImage == NULL)) {
+        return false;
+    }
+
+    Renderer::TintRegion regions[4];
+    Image*               variants[4];
+
+    for (uint color = 0; color < 4; color++) {
+        regions[color] = { { 0, 0, image->width, image->height }, TintingColors[color] };
+    }
+
+    initialMemory    = Renderer::GetTextureMemory();
+    auto startTime   = Engine::GetPreciseTicks();
+    auto isValid     = Renderer::RecolorImages("assets/images/enemy_base.png", "assets/images/enemy_mask.png", regions, 1, variants, 4);
+    auto bakeTime    = Engine::GetPreciseTicks() - startTime;
+    auto bakedMemory = Renderer::GetTextureMemory() - initialMemory;
+
+    if (isValid) {
+        INFO(Txt::TintingBaked, 4, bakeTime);
+        INFO(Txt::TintingResult, "tinted", DrawVariants(image, mask, NULL), (unsigned long long) tintedMemory / 1024);
+        INFO(Txt::TintingResult, "baked", DrawVariants(image, mask, variants), (unsigned long long) bakedMemory / 1024);
+
+        isValid = CheckTinting(backgroundImage, image, mask, variants);
+    }
+
+    for (auto variant : variants) {
+        Renderer::UnloadImage(variant);
+    }
+
+    Renderer::UnloadImage(image);
+    Renderer::UnloadImage(mask);
+    Renderer::UnloadImage(backgroundImage);
+    return isValid;
+}
+
+// Image Regions
+
+static constexpr uint RegionFrames  = 300;
+static constexpr uint RegionClouds  = 32;
+static constexpr uint RegionShips   = 48;
+static constexpr int  SplitShipSize = 64;
+
+static constexpr charconst RegionPaths[] = { "assets/images/overlay.png", "assets/images/cloud1.png", "assets/images/cloud2.png", "assets/images/cloud3.png", "assets/images/cloud4.png", "assets/images/lifebar.png", "assets/images/enemy_base.png", "assets/images/enemy_mask.png", "assets/images/player_base.png", "assets/images/player_mask.png", "assets/images/projectile_base.png", "assets/images/projectile_mask.png" };
+
+static constexpr uint NumberOfRegionPaths = sizeof(RegionPaths) / sizeof(RegionPaths[0]);
+
+// What one full size draw of the image covers, in percent of its area.
+static void ReportRegions(const charconst path, const Image* image) {
+    auto imageArea   = F64(image->width) * image->height;
+    auto boundsArea  = F64(image->bounds.width) * image->bounds.height;
+    auto blendedArea = image->isOpaque ? 0.0 : boundsArea;
+    auto opaqueArea  = image->isOpaque ? boundsArea : 0.0;
+
+    if (image->numberOfRegions > 0) {
+        blendedArea = 0.0;
+
+        for (uint regionIndex = 0; regionIndex < image->numberOfRegions; regionIndex++) {
+            auto regionArea = F64(image->regions[regionIndex].width) * image->regions[regionIndex].height;
+
+            if (regionIndex < image->numberOfOpaqueRegions) {
+                opaqueArea += regionArea;
+            } else {
+                blendedArea += regionArea;
+            }
+        }
+    }
+
+    INFO(Txt::RegionsImage, strrchr(path, '/') + 1, (boundsArea / imageArea) * 100.0, (blendedArea / imageArea) * 100.0, (opaqueArea / imageArea) * 100.0, std::max(image->numberOfRegions, 1u));
+}
+
+// The overlay and the lifebar over a field of clouds and ships, at full size so the regions are used. Draws are counted
+// in the game's layers when the overdraw is.
+static void DrawRegionScene(Image* const* images) {
+    Vector2D screenSize = { F32(benchmarkGame.targetWidth), F32(benchmarkGame.targetHeight) };
+
+    Overdraw::SetLayer(Game::LowCloudsLayer);
+
+    for (uint cloudIndex = 0; cloudIndex < RegionClouds; cloudIndex++) {
+        Vector2D position = { F32(Engine::RandomNumber(-128, benchmarkGame.targetWidth - 128)), F32(Engine::RandomNumber(-128, benchmarkGame.targetHeight - 128)) };
+
+        Renderer::Draw(images[1 + (cloudIndex % 4)], position, { 256.0f, 256.0f });
+    }
+
+    Overdraw::SetLayer(Game::ShipLayer);
+
+    for (uint shipIndex = 0; shipIndex < RegionShips; shipIndex++) {
+        Vector2D position = { F32(Engine::RandomNumber(0, benchmarkGame.targetWidth - 72)), F32(Engine::RandomNumber(0, benchmarkGame.targetHeight - 72)) };
+        auto     isPlayer = (shipIndex % 2) == 1;
+
+        Renderer::Draw(images[isPlayer ? 8 : 6], position, { 72.0f, 72.0f });
+        Renderer::Draw(images[isPlayer ? 9 : 7], position, { 72.0f, 72.0f }, 0x100FFE);
+    }
+
+    Overdraw::SetLayer(Game::HUDLayer);
+    Renderer::Draw(images[5], { 0.0f, screenSize.y - 32.0f }, { screenSize.x, 32.0f });
+
+    Overdraw::SetLayer(Game::OverlayLayer);
+    Renderer::Splash(images[0]);
+}
+
+static bool RunRegions(const charconst name, std::vector<u8>& pixels, const bool isEnabled, const int minimumSplitSize) {
+    Image* images[NumberOfRegionPaths];
+    auto   isLoaded = true;
+
+    Renderer::SetImageRegions(isEnabled, minimumSplitSize);
+
+    for (uint pathIndex = 0; pathIndex < NumberOfRegionPaths; pathIndex++) {
+        isLoaded = ((images[pathIndex] = Renderer::LoadImage(RegionPaths[pathIndex])) != NULL) && isLoaded;
+    }
+
+    if (isLoaded && isEnabled && (minimumSplitSize == Renderer::DefaultMinimumSplitSize)) {
+        INFO(Txt::RegionsHeader, "image", "bounds", "blended", "opaque", "draws");
+
+        for (uint pathIndex = 0; pathIndex < NumberOfRegionPaths; pathIndex++) {
+            ReportRegions(RegionPaths[pathIndex], images[pathIndex]);
+        }
+    }
+
+    if (isLoaded) {
+        Engine::SetRandomSeed(1);
+        DrawRegionScene(images);
+        isLoaded = Renderer::ReadPixels(pixels) && isLoaded;
+        Renderer::Update();
+
+        auto startTime = Engine::GetPreciseTicks();
+
+        for (uint frame = 0; frame < RegionFrames; frame++) {
+            DrawRegionScene(images);
+            Renderer::Update();
+        }
+
+        INFO(Txt::RegionsResult, name, (Engine::GetPreciseTicks() - startTime) / RegionFrames);
+    }
+
+    for (auto image : images) {
+        Renderer::UnloadImage(image);
+    }
+
+    return isLoaded;
+}
+
+static bool CompareRegions(const charconst name, const std::vector<u8>& pixels, const std::vector<u8>& wholePixels) {
+    uint mismatchedPixels = 0;
+
+    for (uint pixelIndex = 0; pixelIndex < wholePixels.size(); pixelIndex += 4) {
+        for (uint channel = 0; channel < 4; channel++) {
+            if (std::abs(pixels[pixelIndex + channel] - wholePixels[pixelIndex + channel]) > I32(Capture::DefaultTolerance)) {
+                mismatchedPixels++;
+                break;
+            }
+        }
+    }
+
+    auto mismatch = F32(mismatchedPixels) / (wholePixels.size() / 4);
+
+    if (mismatch > Capture::DefaultMaxMismatch) {
+        ERROR(Txt::RegionsMismatch, name, mismatch * 100.0f);
+        return false;
+    }
+
+    return true;
+}
+
+// The game's images drawn whole, trimmed and split as the game does, and with the ships split too (they are too small
+// for the default split size, this checks opaque regions). Frames must look the same.
+static bool ImageRegionsBenchmark() {
+    std::vector<u8> wholePixels;
+    std::vector<u8> trimmedPixels;
+    std::vector<u8> splitPixels;
+
+    auto isValid = RunRegions("whole", wholePixels, false, Renderer::DefaultMinimumSplitSize);
+    isValid      = RunRegions("regions", trimmedPixels, true, Renderer::DefaultMinimumSplitSize) && isValid;
+    isValid      = RunRegions("split ships", splitPixels, true, SplitShipSize) && isValid;
+
+    Renderer::SetImageRegions(true);
+
+    return isValid && CompareRegions("with regions", trimmedPixels, wholePixels) && CompareRegions("with split ships", splitPixels, wholePixels);
+}
+
+// Overdraw
+
+static constexpr uint OverdrawFrames = 300;
+static constexpr int  QuadSize       = 64;
+
+static bool CheckOverdrawCount(const charconst name, const uint layerIndex, const u64 expectedWrites) {
+    auto& statistics = Overdraw::GetStatistics();
+
+    if ((statistics.layerWrites[layerIndex] != expectedWrites) || (statistics.maxWrites != 1)) {
+        ERROR(Txt::OverdrawMismatch, name, (unsigned long long) statistics.layerWrites[layerIndex], statistics.maxWrites, (unsigned long long) expectedWrites);
+        return false;
+    }
+
+    return true;
+}
+
+static f64 DrawOverdrawFrames(Image* const* images) {
+    Engine::SetRandomSeed(1);
+
+    auto startTime = Engine::GetPreciseTicks();
+
+    for (uint frame = 0; frame < OverdrawFrames; frame++) {
+        DrawRegionScene(images);
+        Renderer::Update();
+    }
+
+    return (Engine::GetPreciseTicks() - startTime) / OverdrawFrames;
+}
+
+// A quad made of two triangles and a splash must write each of their pixels once, the diagonal the triangles share
+// included. Then the image regions scene is drawn with and without counting, the counts are logged by layer.
+static bool OverdrawBenchmark() {
+    Image* images[NumberOfRegionPaths];
+    auto   isValid = true;
+
+    for (uint pathIndex = 0; pathIndex < NumberOfRegionPaths; pathIndex++) {
+        isValid = ((images[pathIndex] = Renderer::LoadImage(RegionPaths[pathIndex])) != NULL) && isValid;
+    }
+
+    if (isValid && Overdraw::Start("", OverdrawFrames)) {
+        SDL_Vertex quad[4];
+        int        quadIndices[6] = { 0, 1, 2, 1, 3, 2 };
+
+        for (uint corner = 0; corner < 4; corner++) {
+            quad[corner].position  = { F32(100 + (corner % 2) * QuadSize), F32(100 + (corner / 2) * QuadSize) };
+            quad[corner].color     = { 255, 255, 255, 128 };
+            quad[corner].tex_coord = { 0.0f, 0.0f };
+        }
+
+        Overdraw::SetLayer(0);
+        Renderer::DrawGeometry(quad, 4, quadIndices, 6);
+        Renderer::Update();
+
+        isValid = CheckOverdrawCount("A quad", 0, U64(QuadSize) * QuadSize);
+
+        Overdraw::SetLayer(1);
+        Renderer::Splash(images[0]);
+        Renderer::Update();
+
+        isValid = CheckOverdrawCount("A splash", 1, U64(benchmarkGame.targetWidth) * benchmarkGame.targetHeight) && isValid;
+
+        Overdraw::Stop();
+    }
+
+    if (isValid) {
+        INFO(Txt::OverdrawResult, "drawn", DrawOverdrawFrames(images));
+
+        Overdraw::Start("", OverdrawFrames);
+        INFO(Txt::OverdrawResult, "counted", DrawOverdrawFrames(images));
+        Overdraw::Stop();
+    }
+
+    for (auto image : images) {
+        Renderer::UnloadImage(image);
+    }
+
+    return isValid;
+}
+
+// World Paging
+
+static constexpr uint PagingFrames    = 300;
+static constexpr uint ObjectsPerChunk = 8;
+static constexpr f32  PagingSpeed     = 8.0f;
+static constexpr f32  PagingSize      = 64.0f;
+
+static const uint PagingWorldChunks[] = { 8, 32, 128 };
+
+typedef World::Layout<World::DynamicLayer> UnpagedLayout;
+typedef World::Layout<World::PagedLayer>   PagedLayout;
+
+// Drifting objects spread evenly over a square world, the camera pans across it.
+static bool RunPaging(const charconst name, const World::Configuration* layout, const uint worldChunks, Image* image) {
+    World::Finalize();
+    World::Configure(layout);
+
+    if (!World::Initialize(1)) {
+        return false;
+    }
+
+    Engine::SetRandomSeed(1);
+
+    auto                       worldSize = I32(worldChunks * World::ChunkSize);
+    std::vector<World::Object> objects(worldChunks * worldChunks * ObjectsPerChunk, World::Object(World::Object::World));
+
+    for (auto& object : objects) {
+        object.image    = image;
+        object.position = { F32(Engine::RandomNumber(0, worldSize - I32(PagingSize))), F32(Engine::RandomNumber(0, worldSize - I32(PagingSize))) };
+        object.size     = { PagingSize, PagingSize };
+        object.speed    = { F32(Engine::RandomNumber(-4, 4)) / 4.0f, F32(Engine::RandomNumber(-4, 4)) / 4.0f };
+
+        World::AddObject(0, &object);
+    }
+
+    // Loading pages the far objects out once, it is not timed.
+    World::Update(0.0f);
+
+    auto startTime = Engine::GetPreciseTicks();
+
+    for (uint frame = 0; frame < PagingFrames; frame++) {
+        World::SetCamera({ frame * PagingSpeed, frame * PagingSpeed * 0.5f });
+        World::Update(1.0f);
+
+        if (World::Render()) {
+            Renderer::Update();
+        }
+    }
+
+    auto  frameTime     = (Engine::GetPreciseTicks() - startTime) / PagingFrames;
+    auto& frameRect     = Renderer::GetFrameRect();
+    auto& camera        = World::GetCamera();
+    auto  activeObjects = UINT(World::GetLayers()[0]->objects.size());
+    auto  isValid       = activeObjects + World::GetDormantCount() == objects.size();
+
+    for (auto& object : objects) {
+        auto isOnScreen = (object.position.x + object.size.x > camera.x + frameRect.x) && (object.position.x < camera.x + frameRect.x + frameRect.w) &&
+                          (object.position.y + object.size.y > camera.y + frameRect.y) && (object.position.y < camera.y + frameRect.y + frameRect.h);
+
+        isValid = isValid && !(object.isDormant && isOnScreen);
+    }
+
+    if (!isValid) {
+        ERROR(Txt::PagingMismatch, name, worldChunks, worldChunks);
+    }
+
+    INFO(Txt::PagingResult, name, worldChunks, worldChunks, objects.size(), activeObjects, frameTime);
+
+    World::Clear();
+    return isValid;
+}
+
+// Worlds 16 times bigger each time, as dense: paged frames should cost about the same whatever the size.
+static bool WorldPagingBenchmark() {
+    auto image   = Renderer::LoadImage(CloudPaths[0]);
+    auto isValid = image != NULL;
+
+    for (uint sizeIndex = 0; isValid && (sizeIndex < sizeof(PagingWorldChunks) / sizeof(PagingWorldChunks[0])); sizeIndex++) {
+        isValid = RunPaging("dynamic", UnpagedLayout::GetConfiguration(), PagingWorldChunks[sizeIndex], image) && isValid;
+        isValid = RunPaging("paged", PagedLayout::GetConfiguration(), PagingWorldChunks[sizeIndex], image) && isValid;
+    }
+
+    Renderer::UnloadImage(image);
+
+    // The game layout is back for the benchmarks that follow.
+    World::Finalize();
+    World::Configure(Game::Layers::GetConfiguration());
+    return World::Initialize(Game::MaxLayers) && isValid;
+}
+
+// Benchmarks
+
+struct Benchmark {
+    charconst name;
+    charconst description;
+    bool (*run)();
+};
+
+static const Benchmark Benchmarks[] = {
+    { "image-levels", "cloud fill cost with and without downscaled image levels", ImageLevelsBenchmark },
+    { "snapshots", "world snapshot size, save, restore and delta times as the object count grows", SnapshotsBenchmark },
+    { "frame-arena", "per frame temporaries (lists and texts) on the heap and on the frame arena", FrameArenaBenchmark },
+    { "particles", "update and render times of a full particle pool", ParticlesBenchmark },
+    { "overlap", "batched box overlap tests (scalar, SSE and AVX2) against the pairwise checks, and their results", OverlapBenchmark },
+    { "world-layers", "world update and object churn with the game's layer policies and with sorted layers only", WorldLayersBenchmark },
+    { "damage", "frames drawn in full, partially (checked against a full redraw) and skipped when nothing changed", DamageBenchmark },
+    { "tinting", "shared sprites tinted per draw against baked color variants, memory, time and looks", TintingBenchmark },
+    { "image-regions", "per image fill saved by trimming and opaque regions, frame time and looks against whole images", ImageRegionsBenchmark },
+    { "overdraw", "writes per pixel and per layer of the image regions scene, exact counts and the cost of counting", OverdrawBenchmark },
+    { "world-paging", "frame time of a camera panning over growing worlds, with every object active and with paged chunks", WorldPagingBenchmark },
+};
+
+// Main
+
+static int RunBenchmarks(int numberOfArguments, char** argumentsValues) {
+    std::vector<const Benchmark*> selectedBenchmarks;
+
+    for (int argumentIndex = 1; argumentIndex < numberOfArguments; argumentIndex++) {
+        const Benchmark* selectedBenchmark = NULL;
+
+        for (auto& benchmark : Benchmarks) {
+            if (strcmp(argumentsValues[argumentIndex], benchmark.name) == 0) {
+                selectedBenchmark = &benchmark;
+            }
+        }
+
+        if (selectedBenchmark == NULL) {
+            ERROR(Txt::UnknownBenchmark, argumentsValues[argumentIndex]);
+            INFO(Txt::Usage, argumentsValues[0]);
+
+            for (auto& benchmark : Benchmarks) {
+                INFO(Txt::Available, benchmark.name, benchmark.description);
+            }
+
+            return 1;
+        }
+
+        selectedBenchmarks.push_back(selectedBenchmark);
+    }
+
+    if (selectedBenchmarks.empty()) {
+        for (auto& benchmark : Benchmarks) {
+            selectedBenchmarks.push_back(&benchmark);
+        }
+    }
+
+    World::Configure(Game::Layers::GetConfiguration());
+
+    if (!Engine::Initialize(benchmarkGame)) {
+        return 1;
+    }
+
+    auto hasFailed = false;
+
+    for (auto benchmark : selectedBenchmarks) {
+        INFO(Txt::RunningBenchmark, benchmark->name);
+
+        // The whole run is timed as well, builds are compared on it (make pgo).
+        auto startTime = Engine::GetPreciseTicks();
+
+        if (!benchmark->run()) {
+            ERROR(Txt::BenchmarkFailed, benchmark->name);
+            hasFailed = true;
+        }
+
+        INFO(Txt::BenchmarkTime, benchmark->name, Engine::GetPreciseTicks() - startTime);
+    }
+
+    Engine::Finalize();
+    return hasFailed ? 1 : 0;
+}
+
+}    // namespace Tools
+}    // namespace Biq
+
+int main(int numberOfArguments, char** argumentsValues) {
+    return Biq::Tools::RunBenchmarks(numberOfArguments, argumentsValues);
+}
@@ -0,0 +1,376 @@
+/*
+ * Source/Tools/DrawReplay.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/DrawRecorder.hxx"
+#include "Engine/Engine.hxx"
+#include "Engine/Overdraw.hxx"
+#include "Engine/Renderer.hxx"
+
+#include <cstring>
+
+namespace Biq {
+namespace Tools {
+
+static constexpr charconst Tag = "DrawReplay";
+
+// String Table
+
+namespace Txt {
+static const charconst Usage            = "Usage: %s <draw recording> [--loops <count>] [--driver <name>] [--headless] [--image-levels <0..6>] [--overdraw <heatmap.png>] (run it from the binaries directory)";
+static const charconst CouldNotRead     = "Could not read the draw recording \"%s\"";
+static const charconst InvalidRecording = "\"%s\" is not a valid draw recording";
+static const charconst EmptyRecording   = "\"%s\" has no frames";
+static const charconst MissingImages    = "%d of %d images could not be loaded, their draws are skipped";
+static const charconst Replaying        = "Replaying %d frames (%d draw commands) %d times on the \"%s\" renderer at %dx%d";
+static const charconst Throughput       = "%d frames in %.1f ms: %.1f frames per second";
+static const charconst SubmissionHeader = "%-10s %10s %10s %10s %10s";
+static const charconst SubmissionResult = "%-10s %10.3f %10.3f %10.3f %10.3f";
+static const charconst CommandsPerFrame = "%.1f draw commands per frame, %.2f us each to submit";
+}    // namespace Txt
+
+// Recording
+
+struct Recording {
+    DrawRecorder::FileHeader header;
+    std::vector<u8>          commands;
+    std::vector<uint>        frameEnds;
+    std::vector<string>      imagePaths;
+    uint                     numberOfDraws;
+};
+
+static bool ReadRecording(const charconst filePath, std::vector<u8>& content) {
+    auto recordingFile = fopen(filePath, "rb");
+
+    if (recordingFile == NULL) {
+        return false;
+    }
+
+    u8   buffer[64 * 1024];
+    uint readBytes;
+
+    while ((readBytes = fread(buffer, 1, sizeof(buffer), recordingFile)) > 0) {
+        content.insert(content.end(), buffer, buffer + readBytes);
+    }
+
+    auto hasFailed = ferror(recordingFile) != 0;
+
+    fclose(recordingFile);
+    return !hasFailed;
+}
+
+// Everything is checked once here, so the replay loop does not have to.
+static bool ParseRecording(const std::vector<u8>& content, Recording& recording) {
+    if (content.size() < sizeof(DrawRecorder::FileHeader)) {
+        return false;
+    }
+
+    memcpy(&recording.header, content.data(), sizeof(recording.header));
+
+    if ((recording.header.magic != DrawRecorder::Magic) || (recording.header.version != DrawRecorder::Version)) {
+        return false;
+    }
+
+    recording.commands.assign(content.begin() + sizeof(recording.header), content.end());
+    recording.numberOfDraws = 0;
+
+    auto& commands = recording.commands;
+    uint  offset   = 0;
+
+    while (commands.size() - offset >= sizeof(DrawRecorder::Record)) {
+        DrawRecorder::Record record;
+        memcpy(&record, commands.data() + offset, sizeof(record));
+
+        switch (record.command) {
+            case DrawRecorder::FrameCommand: {
+                offset += sizeof(record);
+                recording.frameEnds.push_back(offset);
+                continue;
+            }
+
+            case DrawRecorder::ImageCommand: {
+                auto pathSize    = UINT(U16(record.width));
+                auto commandSize = (sizeof(record) + pathSize + 3) & ~3u;
+
+                if ((record.image != recording.imagePaths.size()) || (commands.size() - offset < commandSize)) {
+                    return false;
+                }
+
+                recording.imagePaths.push_back(string(reinterpret_cast<const char*>(commands.data() + offset + sizeof(record)), pathSize));
+                offset += commandSize;
+                continue;
+            }
+
+            case DrawRecorder::SplashCommand:
+            case DrawRecorder::DrawCommand: {
+                if (record.image >= recording.imagePaths.size()) {
+                    return false;
+                }
+
+                offset += sizeof(record);
+                recording.numberOfDraws++;
+                continue;
+            }
+
+            case DrawRecorder::GeometryCommand: {
+                DrawRecorder::GeometryRecord geometry;
+
+                if (commands.size() - offset < sizeof(geometry)) {
+                    return false;
+                }
+
+                memcpy(&geometry, commands.data() + offset, sizeof(geometry));
+
+                auto geometrySize = sizeof(geometry) + (U64(geometry.numberOfVertices) * sizeof(SDL_Vertex)) + (U64(geometry.numberOfIndices) * sizeof(int));
+
+                if (commands.size() - offset < geometrySize) {
+                    return false;
+                }
+
+                // Indices past the vertices would read out of bounds in the renderer.
+                auto indices = reinterpret_cast<const int*>(commands.data() + offset + sizeof(geometry) + (geometry.numberOfVertices * sizeof(SDL_Vertex)));
+
+                for (uint indexIndex = 0; indexIndex < geometry.numberOfIndices; indexIndex++) {
+                    if ((indices[indexIndex] < 0) || (UINT(indices[indexIndex]) >= geometry.numberOfVertices)) {
+                        return false;
+                    }
+                }
+
+                offset += geometrySize;
+                recording.numberOfDraws++;
+                continue;
+            }
+
+            default: {
+                return false;
+            }
+        }
+    }
+
+    // A frame cut short (the game was killed while recording) is left out.
+    return true;
+}
+
+// Replay
+
+static void SubmitFrame(const u8* commands, const uint size, const std::vector<Image*>& images) {
+    uint offset = 0;
+
+    while (offset < size) {
+        DrawRecorder::Record record;
+        memcpy(&record, commands + offset, sizeof(record));
+
+        switch (record.command) {
+            case DrawRecorder::ImageCommand: {
+                offset += (sizeof(record) + U16(record.width) + 3) & ~3u;
+                break;
+            }
+
+            case DrawRecorder::SplashCommand: {
+                Overdraw::SetLayer(record.layer);
+                Renderer::Splash(images[record.image]);
+                offset += sizeof(record);
+                break;
+            }
+
+            case DrawRecorder::DrawCommand: {
+                Vector2D position = { F32(record.x), F32(record.y) };
+                Vector2D size     = { F32(record.width), F32(record.height) };
+
+                Overdraw::SetLayer(record.layer);
+                Renderer::Draw(images[record.image], position, size, record.tint);
+                offset += sizeof(record);
+                break;
+            }
+
+            case DrawRecorder::GeometryCommand: {
+                DrawRecorder::GeometryRecord geometry;
+                memcpy(&geometry, commands + offset, sizeof(geometry));
+
+                auto vertices = reinterpret_cast<const SDL_Vertex*>(commands + offset + sizeof(geometry));
+                auto indices  = reinterpret_cast<const int*>(vertices + geometry.numberOfVertices);
+
+                Overdraw::SetLayer(geometry.layer);
+                Renderer::DrawGeometry(vertices, geometry.numberOfVertices, indices, geometry.numberOfIndices);
+                offset += sizeof(geometry) + (geometry.numberOfVertices * sizeof(SDL_Vertex)) + (geometry.numberOfIndices * sizeof(int));
+                break;
+            }
+
+            default: {
+                offset += sizeof(record);
+                break;
+            }
+        }
+    }
+}
+
+static f64 Percentile(std::vector<f64>& values, const f64 fraction) {
+    auto position = values.begin() + UINT(fraction * (values.size() - 1));
+
+    std::nth_element(values.begin(), position, values.end());
+    return *position;
+}
+
+static void ReportTimes(const charconst name, std::vector<f64>& times) {
+    f64 totalTime = 0.0;
+
+    for (auto time : times) {
+        totalTime += time;
+    }
+
+    INFO(Txt::SubmissionResult, name, totalTime / times.size(), Percentile(times, 0.5), Percentile(times, 0.99), *std::max_element(times.begin(), times.end()));
+}
+
+// Main
+
+static int RunReplay(int numberOfArguments, char** argumentsValues) {
+    if (numberOfArguments < 2) {
+        INFO(Txt::Usage, argumentsValues[0]);
+        return 1;
+    }
+
+    charconst recordingPath = argumentsValues[1];
+    charconst driverName    = NULL;
+    uint      numberOfLoops = 1;
+    bool      isHeadless    = false;
+    int       imageLevels   = Renderer::DefaultImageLevels;
+    charconst overdrawPath  = NULL;
+
+    for (int argumentIndex = 2; argumentIndex < numberOfArguments; argumentIndex++) {
+        string argument = argumentsValues[argumentIndex];
+        bool   hasValue = argumentIndex + 1 < numberOfArguments;
+
+        if ((argument == "--loops") && hasValue) {
+            numberOfLoops = std::max(atoi(argumentsValues[++argumentIndex]), 1);
+        } else if ((argument == "--driver") && hasValue) {
+            driverName = argumentsValues[++argumentIndex];
+        } else if (argument == "--headless") {
+            isHeadless = true;
+        } else if ((argument == "--image-levels") && hasValue) {
+            imageLevels = atoi(argumentsValues[++argumentIndex]);
+        } else if ((argument == "--overdraw") && hasValue) {
+            overdrawPath = argumentsValues[++argumentIndex];
+        } else {
+            INFO(Txt::Usage, argumentsValues[0]);
+            return 1;
+        }
+    }
+
+    std::vector<u8> content;
+    Recording       recording;
+
+    if (!ReadRecording(recordingPath, content)) {
+        ERROR(Txt::CouldNotRead, recordingPath);
+        return 1;
+    }
+
+    if (!ParseRecording(content, recording)) {
+        ERROR(Txt::InvalidRecording, recordingPath);
+        return 1;
+    }
+
+    if (recording.frameEnds.empty()) {
+        ERROR(Txt::EmptyRecording, recordingPath);
+        return 1;
+    }
+
+    // Backends are picked by name (SDL_HINT_RENDER_DRIVER: opengl, opengles2, direct3d11, metal, software...).
+    if (driverName != NULL) {
+        SDL_SetHint(SDL_HINT_RENDER_DRIVER, driverName);
+    }
+
+    GameInformation replayGame = { const_cast<char*>("Biq Draw Replay"), recording.header.width, recording.header.height, 60, 1, isHeadless };
+
+    Renderer::SetImageLevels(imageLevels, 0.0f);
+
+    if (!Engine::Initialize(replayGame)) {
+        return 1;
+    }
+
+    // Images are loaded on the render thread, they are uploaded right away.
+    std::vector<Image*> images;
+    uint                missingImages = 0;
+
+    for (auto& imagePath : recording.imagePaths) {
+        images.push_back(Renderer::LoadImage(imagePath));
+        missingImages += images.back() == NULL ? 1 : 0;
+    }
+
+    if (missingImages > 0) {
+        WARNING(Txt::MissingImages, missingImages, images.size());
+    }
+
+    // Counting every pixel slows the replay down, its times are only good to compare with other counted replays.
+    if (overdrawPath != NULL) {
+        Overdraw::Start(overdrawPath);
+    }
+
+    auto numberOfFrames = UINT(recording.frameEnds.size());
+    auto totalFrames    = numberOfFrames * numberOfLoops;
+
+    INFO(Txt::Replaying, numberOfFrames, recording.numberOfDraws, numberOfLoops, Renderer::GetBackendName(), replayGame.targetWidth, replayGame.targetHeight);
+
+    std::vector<f64> submissionTimes;
+    std::vector<f64> presentTimes;
+
+    submissionTimes.reserve(totalFrames);
+    presentTimes.reserve(totalFrames);
+
+    auto startTime = Engine::GetPreciseTicks();
+
+    for (uint loop = 0; loop < numberOfLoops; loop++) {
+        uint frameStart = 0;
+
+        for (auto frameEnd : recording.frameEnds) {
+            auto submitTime = Engine::GetPreciseTicks();
+
+            SubmitFrame(recording.commands.data() + frameStart, frameEnd - frameStart, images);
+
+            auto updateTime = Engine::GetPreciseTicks();
+
+            Renderer::Update();
+
+            auto frameTime = Engine::GetPreciseTicks();
+
+            submissionTimes.push_back(updateTime - submitTime);
+            presentTimes.push_back(frameTime - updateTime);
+
+            frameStart = frameEnd;
+        }
+    }
+
+    auto totalTime = Engine::GetPreciseTicks() - startTime;
+
+    INFO(Txt::Throughput, totalFrames, totalTime, totalTime > 0.0 ? (totalFrames * 1000.0) / totalTime : 0.0);
+    INFO(Txt::SubmissionHeader, "ms/frame", "average", "p50", "p99", "max");
+
+    f64 submissionTime = 0.0;
+
+    for (auto time : submissionTimes) {
+        submissionTime += time;
+    }
+
+    ReportTimes("submit", submissionTimes);
+    ReportTimes("present", presentTimes);
+
+    auto commandsPerFrame = F64(recording.numberOfDraws) / numberOfFrames;
+
+    INFO(Txt::CommandsPerFrame, commandsPerFrame, recording.numberOfDraws > 0 ? (submissionTime * 1000.0) / (F64(recording.numberOfDraws) * numberOfLoops) : 0.0);
+
+    for (auto image : images) {
+        Renderer::UnloadImage(image);
+    }
+
+    Engine::Finalize();
+    return 0;
+}
+
+}    // namespace Tools
+}    // namespace Biq
+
+int main(int numberOfArguments, char** argumentsValues) {
+    return Biq::Tools::RunReplay(numberOfArguments, argumentsValues);
+}
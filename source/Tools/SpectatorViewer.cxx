@@ -0,0 +1,430 @@
+/*
+ * Source/Tools/SpectatorViewer.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/Engine.hxx"
+#include "Engine/Renderer.hxx"
+#include "Engine/Spectator.hxx"
+#include "Engine/World.hxx"
+
+#ifdef LinuxOS
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+namespace Biq {
+namespace Tools {
+
+static constexpr charconst Tag = "SpectatorViewer";
+
+// String Table
+
+namespace Txt {
+static const charconst Usage             = "Usage: %s <spectator socket> [width height] (run it from the binaries directory)";
+static const charconst CouldNotConnect   = "Could not connect to \"%s\"";
+static const charconst NotSupported      = "The spectator viewer is not supported on this platform";
+static const charconst InvalidFrame      = "Invalid frame received, disconnecting";
+static const charconst StreamEnded       = "The game closed the stream";
+static const charconst ValueFormat       = "%s: %d   ";
+}    // namespace Txt
+
+// Viewer
+
+// Rebuilds the streamed scene in the local World after every received frame, so the regular World::Render draws it.
+
+class ViewerState : public State {
+    public:
+        static constexpr uint Id          = 0;
+        static constexpr uint MaxLayers   = 8;
+        static constexpr uint ReceiveSize = 64 * 1024;
+
+        ViewerState(const int socket) :
+            socket(socket), currentState(0), hasState(false), lastFrame(0), valuesImage(NULL), valuesObject(World::Object::World) {
+        }
+
+        void Prepare(const GameInformation& game) {
+            // Empty
+        }
+
+        void Release() {
+            for (auto& image : images) {
+                Renderer::UnloadImage(image.second);
+            }
+
+            images.clear();
+
+            if (valuesImage != NULL) {
+                Renderer::UnloadImage(valuesImage);
+                valuesImage = NULL;
+            }
+
+            for (auto object : objects) {
+                delete object;
+            }
+
+            objects.clear();
+        }
+
+        void Activate(const GameInformation& game) {
+            World::Clear();
+        }
+
+        void Deactivate() {
+            World::Clear();
+        }
+
+        void Step(const float speedMultiplier) {
+            auto currentFrame = lastFrame;
+
+            if (!Receive()) {
+                Engine::Stop();
+                return;
+            }
+
+            if (hasState && (lastFrame != currentFrame) && !BuildScene(states[currentState])) {
+                ERROR(Txt::InvalidFrame);
+                Engine::Stop();
+            }
+        }
+
+        void OnPress(const uint key) {
+            // Empty
+        }
+
+        void OnRelease(const uint key) {
+            if (key == Input::KeyEscape) {
+                Engine::Stop();
+            }
+        }
+
+    private:
+        struct ObjectRecord {
+            uint     layerIndex;
+            i32      imageIndex;
+            i32      maskIndex;
+            u32      tint;
+            Vector2D position;
+            Vector2D size;
+        };
+
+        int                         socket;
+        std::vector<u8>             incoming;
+        std::vector<u8>             delta;
+        Snapshot                    states[2];
+        uint                        currentState;
+        bool                        hasState;
+        u32                         lastFrame;
+        std::map<string, Image*>    images;
+        std::vector<Image*>         frameImages;
+        std::vector<i32>            layerBackgrounds;
+        std::vector<ObjectRecord>   records;
+        std::vector<World::Object*> objects;
+        std::vector<i32>            values;
+        std::vector<i32>            shownValues;
+        Image*                      valuesImage;
+        World::Object               valuesObject;
+
+        bool Receive() {
+#ifdef LinuxOS
+            u8 buffer[ViewerState::ReceiveSize];
+
+            while (true) {
+                auto receivedBytes = recv(socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+                if (receivedBytes == 0) {
+                    INFO(Txt::StreamEnded);
+                    return false;
+                }
+
+                if (receivedBytes < 0) {
+                    if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
+                        break;
+                    }
+
+                    return false;
+                }
+
+                incoming.insert(incoming.end(), buffer, buffer + receivedBytes);
+            }
+
+            uint offset = 0;
+
+            while (incoming.size() - offset >= sizeof(Spectator::FrameHeader)) {
+                Spectator::FrameHeader header;
+                memcpy(&header, incoming.data() + offset, sizeof(header));
+
+                if (header.magic != Spectator::Magic) {
+                    ERROR(Txt::InvalidFrame);
+                    return false;
+                }
+
+                if (incoming.size() - offset - sizeof(header) < header.size) {
+                    break;
+                }
+
+                ApplyFrame(header, incoming.data() + offset + sizeof(header));
+                offset += sizeof(header) + header.size;
+            }
+
+            incoming.erase(incoming.begin(), incoming.begin() + offset);
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        void ApplyFrame(const Spectator::FrameHeader& header, const u8* payload) {
+            auto nextState = currentState ^ 1;
+
+            if (header.type == Spectator::Keyframe) {
+                states[nextState].SetData(payload, header.size);
+            } else {
+                // Deltas only apply on the frame right before them, anything else waits for the next keyframe.
+                if (!hasState || (header.frame != lastFrame + 1)) {
+                    return;
+                }
+
+                delta.assign(payload, payload + header.size);
+
+                if (!Snapshot::DecodeDelta(states[currentState], delta, states[nextState])) {
+                    hasState = false;
+                    return;
+                }
+            }
+
+            currentState = nextState;
+            lastFrame    = header.frame;
+            hasState     = true;
+        }
+
+        bool BuildScene(const Snapshot& state) {
+            u32 frame, numberOfValues, numberOfLayers, numberOfObjects, numberOfImages, numberOfNames;
+
+            if (!state.Open(Spectator::Version) || !state.Read(frame) || !state.Read(numberOfValues) || (numberOfValues > Spectator::MaxValues)) {
+                return false;
+            }
+
+            values.resize(numberOfValues);
+
+            if (!state.ReadBytes(values.data(), numberOfValues * sizeof(i32)) || !state.Read(numberOfLayers)) {
+                return false;
+            }
+
+            layerBackgrounds.clear();
+            records.clear();
+
+            for (uint layerIndex = 0; layerIndex < numberOfLayers; layerIndex++) {
+                i32 backgroundIndex;
+
+                if (!state.Read(backgroundIndex) || !state.Read(numberOfObjects)) {
+                    return false;
+                }
+
+                layerBackgrounds.push_back(backgroundIndex);
+
+                for (uint objectIndex = 0; objectIndex < numberOfObjects; objectIndex++) {
+                    ObjectRecord record = { layerIndex, -1, -1, Image::NoTint, { 0.0f, 0.0f }, { 0.0f, 0.0f } };
+
+                    if (!state.Read(record.imageIndex) || !state.Read(record.maskIndex) || !state.Read(record.tint) || !state.Read(record.position) || !state.Read(record.size)) {
+                        return false;
+                    }
+
+                    records.push_back(record);
+                }
+            }
+
+            // Paths come after the objects that use them.
+            if (!state.Read(numberOfImages)) {
+                return false;
+            }
+
+            frameImages.clear();
+
+            for (uint imageIndex = 0; imageIndex < numberOfImages; imageIndex++) {
+                string path;
+
+                if (!ReadString(state, path)) {
+                    return false;
+                }
+
+                frameImages.push_back(GetImage(path));
+            }
+
+            // Scene
+
+            World::Clear();
+
+            for (uint layerIndex = 0; layerIndex < layerBackgrounds.size(); layerIndex++) {
+                World::SetLayerBackground(layerIndex, FrameImage(layerBackgrounds[layerIndex]));
+            }
+
+            while (objects.size() < records.size()) {
+                objects.push_back(new World::Object(World::Object::World));
+            }
+
+            for (uint recordIndex = 0; recordIndex < records.size(); recordIndex++) {
+                auto  object = objects[recordIndex];
+                auto& record = records[recordIndex];
+
+                object->image    = FrameImage(record.imageIndex);
+                object->mask     = FrameImage(record.maskIndex);
+                object->tint     = record.tint;
+                object->position = record.position;
+                object->size     = record.size;
+                object->speed    = { 0.0f, 0.0f };
+
+                if (object->image != NULL) {
+                    World::AddObject(record.layerIndex, object);
+                }
+            }
+
+            if (!state.Read(numberOfNames) || (numberOfNames != numberOfValues)) {
+                return false;
+            }
+
+            return ShowValues(state, numberOfNames);
+        }
+
+        bool ShowValues(const Snapshot& state, const uint numberOfNames) {
+            string valuesText;
+            char   valueText[128];
+
+            for (uint nameIndex = 0; nameIndex < numberOfNames; nameIndex++) {
+                string name;
+
+                if (!ReadString(state, name)) {
+                    return false;
+                }
+
+                snprintf(valueText, sizeof(valueText), Txt::ValueFormat, name.c_str(), values[nameIndex]);
+                valuesText += valueText;
+            }
+
+            // Text is only rendered again when a value changes.
+            if ((values != shownValues) && !valuesText.empty()) {
+                if (valuesImage != NULL) {
+                    Renderer::UnloadImage(valuesImage);
+                }
+
+                valuesImage = Renderer::TextImage(valuesText);
+                shownValues = values;
+            }
+
+            if (valuesImage != NULL) {
+                valuesObject.image    = valuesImage;
+                valuesObject.position = { 8.0f, 8.0f };
+                valuesObject.size     = { F32(valuesImage->width), F32(valuesImage->height) };
+
+                World::AddObject(ViewerState::MaxLayers - 1, &valuesObject);
+            }
+
+            return true;
+        }
+
+        static bool ReadString(const Snapshot& state, string& text) {
+            u16 length;
+
+            if (!state.Read(length)) {
+                return false;
+            }
+
+            text.resize(length);
+            return state.ReadBytes(&text[0], length);
+        }
+
+        Image* FrameImage(const i32 imageIndex) const {
+            return (imageIndex >= 0) && (UINT(imageIndex) < frameImages.size()) ? frameImages[imageIndex] : NULL;
+        }
+
+        Image* GetImage(const string& path) {
+            auto image = images.find(path);
+
+            if (image != images.end()) {
+                return image->second;
+            }
+
+            // Images that fail to load are remembered as well, so they are not tried again every frame.
+            return images[path] = Renderer::LoadImage(path);
+        }
+};
+
+// Main
+
+static void Disconnect(const int viewerSocket) {
+#ifdef LinuxOS
+    close(viewerSocket);
+#endif
+}
+
+static int Connect(const charconst socketPath) {
+#ifdef LinuxOS
+    sockaddr_un address = {};
+    address.sun_family  = AF_UNIX;
+    strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+
+    auto viewerSocket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if ((viewerSocket < 0) || (connect(viewerSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)) {
+        ERROR(Txt::CouldNotConnect, socketPath);
+
+        if (viewerSocket >= 0) {
+            Disconnect(viewerSocket);
+        }
+
+        return -1;
+    }
+
+    fcntl(viewerSocket, F_SETFL, fcntl(viewerSocket, F_GETFL) | O_NONBLOCK);
+    return viewerSocket;
+#else
+    ERROR(Txt::NotSupported);
+    return -1;
+#endif
+}
+
+static int RunViewer(int numberOfArguments, char** argumentsValues) {
+    if (numberOfArguments < 2) {
+        INFO(Txt::Usage, argumentsValues[0]);
+        return 1;
+    }
+
+    GameInformation viewerGame = { const_cast<char*>("Biq Spectator"), 1280, 720, 30, ViewerState::MaxLayers, false };
+
+    if (numberOfArguments > 3) {
+        viewerGame.targetWidth  = atoi(argumentsValues[2]);
+        viewerGame.targetHeight = atoi(argumentsValues[3]);
+    }
+
+    auto viewerSocket = Connect(argumentsValues[1]);
+
+    if (viewerSocket < 0) {
+        return 1;
+    }
+
+    if (!Engine::Initialize(viewerGame)) {
+        Disconnect(viewerSocket);
+        return 1;
+    }
+
+    ViewerState viewerState(viewerSocket);
+
+    Engine::RegisterState(ViewerState::Id, "VIEWER", viewerState);
+    Engine::Run(ViewerState::Id);
+    Engine::Finalize();
+
+    Disconnect(viewerSocket);
+    return 0;
+}
+
+}    // namespace Tools
+}    // namespace Biq
+
+int main(int numberOfArguments, char** argumentsValues) {
+    return Biq::Tools::RunViewer(numberOfArguments, argumentsValues);
+}
@@ -0,0 +1,182 @@
+/*
+ * Source/Tools/TelemetryReader.cxx
+ *
+ * This file is part of the Biq Invaders game source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Engine/Telemetry.hxx"
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace Biq;
+
+// String Table
+
+namespace Txt {
+static const charconst Usage              = "Usage: %s <telemetry file> [interval in ms]\n";
+static const charconst CouldNotOpenFile   = "Could not open \"%s\"\n";
+static const charconst InvalidFile        = "\"%s\" is not a Biq telemetry file (or it is from another version)\n";
+static const charconst ClearScreen        = "\033[H\033[2J";
+static const charconst Header             = "Biq Telemetry - frame %llu\n";
+static const charconst SubsystemHeader    = "\n[%s]\n";
+static const charconst CounterLine        = "  %-32s %12lld  (%.1f/s)\n";
+static const charconst GaugeLine          = "  %-32s %12lld\n";
+static const charconst HistogramLine      = "  %-32s n=%-8llu p50=%-8.2f p90=%-8.2f p99=%-8.2f max=%-8.2f (ms)\n";
+static const charconst EmptyHistogramLine = "  %-32s n=0\n";
+}    // namespace Txt
+
+// Reading
+
+static bool ReadPage(const Telemetry::SharedHeader* header, const Telemetry::Page* sharedPage, Telemetry::Page& page) {
+    for (auto attempt = 0; attempt < 1000; attempt++) {
+        auto sequenceBefore = header->sequence.load(std::memory_order_acquire);
+
+        if (sequenceBefore & 1) {
+            continue;
+        }
+
+        memcpy(&page, sharedPage, sizeof(Telemetry::Page));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (header->sequence.load(std::memory_order_relaxed) == sequenceBefore) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Percentiles are computed over what was recorded since the previous poll, so they always show live values.
+
+static f64 Percentile(const Telemetry::HistogramData& current, const Telemetry::HistogramData& previous, const u64 count, const f64 percentile) {
+    auto target     = U64(count * percentile);
+    u64  cumulative = 0;
+
+    for (uint bucketIndex = 0; bucketIndex < Telemetry::HistogramBuckets; bucketIndex++) {
+        cumulative += current.buckets[bucketIndex] - previous.buckets[bucketIndex];
+
+        if (cumulative > target) {
+            return F64(Telemetry::BucketValue(bucketIndex));
+        }
+    }
+
+    return F64(current.maxValue);
+}
+
+static f64 MaxValue(const Telemetry::HistogramData& current, const Telemetry::HistogramData& previous) {
+    for (int bucketIndex = Telemetry::HistogramBuckets - 1; bucketIndex >= 0; bucketIndex--) {
+        if (current.buckets[bucketIndex] != previous.buckets[bucketIndex]) {
+            return F64(Telemetry::BucketValue(bucketIndex + 1));
+        }
+    }
+
+    return 0.0;
+}
+
+static void PrintPage(const Telemetry::Page& page, const Telemetry::Page& previousPage, const f64 elapsedSeconds) {
+    printf("%s", Txt::ClearScreen);
+    printf(Txt::Header, (unsigned long long) page.frame);
+
+    char currentSubsystem[Telemetry::MaxNameLength] = {0};
+
+    for (uint metricIndex = 0; metricIndex < page.numberOfMetrics; metricIndex++) {
+        auto& metric     = page.metrics[metricIndex];
+        auto  nameLength = strcspn(metric.name, ".");
+
+        if ((strncmp(currentSubsystem, metric.name, nameLength) != 0) || (currentSubsystem[nameLength] != 0)) {
+            strncpy(currentSubsystem, metric.name, nameLength);
+            currentSubsystem[nameLength] = 0;
+            printf(Txt::SubsystemHeader, currentSubsystem);
+        }
+
+        auto shortName = metric.name[nameLength] == '.' ? metric.name + nameLength + 1 : metric.name;
+
+        switch (metric.kind) {
+            case Telemetry::Counter: {
+                auto previousValue = metricIndex < previousPage.numberOfMetrics ? previousPage.metrics[metricIndex].value : 0;
+                printf(Txt::CounterLine, shortName, (long long) metric.value, elapsedSeconds > 0.0 ? (metric.value - previousValue) / elapsedSeconds : 0.0);
+                break;
+            }
+
+            case Telemetry::Gauge: {
+                printf(Txt::GaugeLine, shortName, (long long) metric.value);
+                break;
+            }
+
+            case Telemetry::Histogram: {
+                auto& current  = page.histograms[metric.histogramIndex];
+                auto& previous = previousPage.histograms[metric.histogramIndex];
+                auto  count    = current.count - previous.count;
+
+                if (count == 0) {
+                    printf(Txt::EmptyHistogramLine, shortName);
+                    break;
+                }
+
+                // Histograms are recorded in microseconds.
+                printf(Txt::HistogramLine, shortName, (unsigned long long) count, Percentile(current, previous, count, 0.50) / 1000.0, Percentile(current, previous, count, 0.90) / 1000.0, Percentile(current, previous, count, 0.99) / 1000.0, MaxValue(current, previous) / 1000.0);
+                break;
+            }
+        }
+    }
+
+    fflush(stdout);
+}
+
+// Main
+
+int main(int numberOfArguments, char** argumentsValues) {
+    if (numberOfArguments < 2) {
+        fprintf(stderr, Txt::Usage, argumentsValues[0]);
+        return 1;
+    }
+
+    auto pollInterval = numberOfArguments > 2 ? atoi(argumentsValues[2]) : 1000;
+    auto mappingSize  = sizeof(Telemetry::SharedHeader) + sizeof(Telemetry::Page);
+    auto sharedFile   = open(argumentsValues[1], O_RDONLY);
+
+    if (sharedFile < 0) {
+        fprintf(stderr, Txt::CouldNotOpenFile, argumentsValues[1]);
+        return 1;
+    }
+
+    auto mapping = mmap(NULL, mappingSize, PROT_READ, MAP_SHARED, sharedFile, 0);
+
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, Txt::CouldNotOpenFile, argumentsValues[1]);
+        close(sharedFile);
+        return 1;
+    }
+
+    auto header     = reinterpret_cast<const Telemetry::SharedHeader*>(mapping);
+    auto sharedPage = reinterpret_cast<const Telemetry::Page*>(DATA(mapping) + sizeof(Telemetry::SharedHeader));
+
+    if ((header->magic != Telemetry::Magic) || (header->version != Telemetry::Version) || (header->pageSize != sizeof(Telemetry::Page))) {
+        fprintf(stderr, Txt::InvalidFile, argumentsValues[1]);
+        munmap(mapping, mappingSize);
+        close(sharedFile);
+        return 1;
+    }
+
+    // Both pages are big, keep them off the stack.
+    static Telemetry::Page currentPage;
+    static Telemetry::Page previousPage;
+
+    while (true) {
+        if (ReadPage(header, sharedPage, currentPage)) {
+            auto elapsedSeconds = (currentPage.publishTime - previousPage.publishTime) / 1000.0;
+
+            PrintPage(currentPage, previousPage, elapsedSeconds);
+            memcpy(&previousPage, &currentPage, sizeof(Telemetry::Page));
+        }
+
+        usleep(pollInterval * 1000);
+    }
+
+    return 0;
+}